@@ -3,33 +3,85 @@ macro(add_eve_ececutable)
   set(oneValueArgs NAME)
   set(multiValueArgs SRC SCREENSIZES)
   cmake_parse_arguments(eve_executable "${options}" "${oneValueArgs}" "${multiValueArgs}" ${ARGN} )
-  if ("EVE3" IN_LIST EVE_EXAMPLES_PLATFORMS)
-    set(BUILD_EVE3 On)
-  endif()
-  if ("EVE4" IN_LIST EVE_EXAMPLES_PLATFORMS)
-    set(BUILD_EVE3 On)
-  endif()
-  foreach(platform ${EVE_EXAMPLES_PLATFORMS})
-    foreach(display ${${platform}_EXAMPLES_DISPLAY_SIZES})
-        foreach(touch ${EVE_EXAMPLES_TOUCH})
-          set(must_generate On)
-          if(eve_executable_EVE3 AND BUILD_EVE3 AND NOT (${platform} STREQUAL "EVE3" OR ${platform} STREQUAL "EVE4"))
-                set(must_generate Off)
-          endif()
-          if(must_generate)
-            set(final_name "${eve_executable_NAME}_${display}_${platform}_${touch}")
-            add_executable(${final_name} ${eve_executable_SRC})
-            target_compile_definitions(${final_name} PUBLIC DEMO_DISPLAY=DISPLAY_${display} DEMO_BOARD=BOARD_${platform} DEMO_TOUCH=TOUCH_${touch})
-            target_link_libraries(${final_name} eve)
-            if(WIN32)
-              target_link_libraries(${final_name} kernel32)
+  if(EVE_EXAMPLES_RUNTIME_DISPLAY)
+    add_executable(${eve_executable_NAME} ${eve_executable_SRC})
+    target_compile_definitions(${eve_executable_NAME} PUBLIC DEMO_DISPLAY=DISPLAY_AUTO DEMO_BOARD=BOARD_AUTO DEMO_TOUCH=TOUCH_AUTO)
+    target_link_libraries(${eve_executable_NAME} eve)
+    if(WIN32)
+      target_link_libraries(${eve_executable_NAME} kernel32)
+    endif()
+    set_target_properties(${eve_executable_NAME} PROPERTIES FOLDER demos)
+    install(TARGETS ${eve_executable_NAME} DESTINATION ./demos)
+  else()
+    if ("EVE3" IN_LIST EVE_EXAMPLES_PLATFORMS)
+      set(BUILD_EVE3 On)
+    endif()
+    if ("EVE4" IN_LIST EVE_EXAMPLES_PLATFORMS)
+      set(BUILD_EVE3 On)
+    endif()
+    foreach(platform ${EVE_EXAMPLES_PLATFORMS})
+      foreach(display ${${platform}_EXAMPLES_DISPLAY_SIZES})
+          foreach(touch ${EVE_EXAMPLES_TOUCH})
+            set(must_generate On)
+            if(eve_executable_EVE3 AND BUILD_EVE3 AND NOT (${platform} STREQUAL "EVE3" OR ${platform} STREQUAL "EVE4"))
+                  set(must_generate Off)
             endif()
-            set_target_properties(${final_name} PROPERTIES FOLDER ${platform}/${display}/${touch})
-            install(TARGETS ${final_name} DESTINATION ./${platform}/${display}/${touch})
-          endif()
-        endforeach()
+            if(must_generate)
+              set(final_name "${eve_executable_NAME}_${display}_${platform}_${touch}")
+              add_executable(${final_name} ${eve_executable_SRC})
+              target_compile_definitions(${final_name} PUBLIC DEMO_DISPLAY=DISPLAY_${display} DEMO_BOARD=BOARD_${platform} DEMO_TOUCH=TOUCH_${touch})
+              target_link_libraries(${final_name} eve)
+              if(WIN32)
+                target_link_libraries(${final_name} kernel32)
+              endif()
+              set_target_properties(${final_name} PROPERTIES FOLDER ${platform}/${display}/${touch})
+              install(TARGETS ${final_name} DESTINATION ./${platform}/${display}/${touch})
+            endif()
+          endforeach()
+      endforeach()
     endforeach()
-  endforeach()
+  endif()
 endmacro()
 
 
+
+# Build a flash image with flash_image_builder.  Makes <NAME>.bin and <NAME>.h in the current
+# binary directory, rebuilt whenever the spec or one of the files it lists changes.
+#   add_eve_flash_image(NAME <target> SPEC <spec.txt> [BLOB <blob.bin>])
+macro(add_eve_flash_image)
+  set(oneValueArgs NAME SPEC BLOB)
+  cmake_parse_arguments(eve_flash_image "" "${oneValueArgs}" "" ${ARGN} )
+  get_filename_component(spec ${eve_flash_image_SPEC} ABSOLUTE)
+  get_filename_component(spec_dir ${spec} DIRECTORY)
+  set(depends ${spec})
+  file(STRINGS ${spec} spec_lines)
+  foreach(line ${spec_lines})
+    string(REGEX REPLACE "[ \t]+" ";" tokens "${line}")
+    list(LENGTH tokens count)
+    if(count GREATER 2)
+      list(GET tokens 0 name)
+      if(NOT name MATCHES "^#")
+        list(REMOVE_AT tokens 0 1)
+        foreach(token ${tokens})
+          if(NOT token MATCHES "=" AND NOT token STREQUAL "deflate")
+            list(APPEND depends ${spec_dir}/${token})
+          endif()
+        endforeach()
+      endif()
+    endif()
+  endforeach()
+  set(image ${CMAKE_CURRENT_BINARY_DIR}/${eve_flash_image_NAME}.bin)
+  set(header ${CMAKE_CURRENT_BINARY_DIR}/${eve_flash_image_NAME}.h)
+  set(blob_args)
+  if(eve_flash_image_BLOB)
+    get_filename_component(blob ${eve_flash_image_BLOB} ABSOLUTE)
+    set(blob_args -b ${blob})
+    list(APPEND depends ${blob})
+  endif()
+  set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS ${spec})
+  add_custom_command(OUTPUT ${image} ${header}
+                     COMMAND flash_image_builder ${blob_args} -o ${image} -H ${header} ${spec}
+                     DEPENDS flash_image_builder ${depends}
+                     COMMENT "Building flash image ${eve_flash_image_NAME}")
+  add_custom_target(${eve_flash_image_NAME} ALL DEPENDS ${image} ${header})
+endmacro()
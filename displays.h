@@ -1,6 +1,8 @@
 #ifndef __DISPLAYS_H
 #define __DISPLAYS_H
 
+// Pick the display / board / touch at runtime, see EVE_Init
+#define DISPLAY_AUTO -1
 #define DISPLAY_70_800x480 1
 #define DISPLAY_50_800x480 2
 #define DISPLAY_43_480x272 3
@@ -15,10 +17,12 @@
 #define DISPLAY_70_1024x600_WG 12
 #define DISPLAY_43_800480 13
 
+#define BOARD_AUTO -1
 #define BOARD_EVE2 1
 #define BOARD_EVE3 2
 #define BOARD_EVE4 3
 
+#define TOUCH_AUTO -1
 #define TOUCH_TPN 0
 #define TOUCH_TPR 1
 #define TOUCH_TPC 2
@@ -50,12 +50,28 @@
 #include <stdbool.h> // For true/false
 #include <stdint.h>  // Find integer types like "uint8_t"
 #include <stdio.h>
+#include <string.h>
 
 #define WorkBuffSz 512
+#define BurstSz 0x2000 // Longest SPI transaction of wrN and rdN, see wrN
 #define Log printf
 
+#define BOOT_TIMEOUT_US 300000   // BT81x boot after HCMD_ACTIVE, worst case
+#define ENGINE_TIMEOUT_US 100000 // Coprocessor, touch and audio engines out of reset
+#define GOODIX_RESET_US 100      // Goodix reset pulse, more than 100us
+#define GOODIX_BOOT_US 56000     // Goodix boot after reset, more than 55ms
+#define CALIBRATE_POLL_MS 10     // Touch panel read rate while calibrating
+
+// The context of each thread lives in thread local storage where there are threads
+#if defined(_MSC_VER)
+#define EVE_THREAD_LOCAL __declspec(thread)
+#elif defined(_WIN32) || defined(__unix__) || defined(__APPLE__)
+#define EVE_THREAD_LOCAL __thread
+#else
+#define EVE_THREAD_LOCAL
+#endif
+
 // Global Variables
-uint16_t FifoWriteLocation = 0;
 char LogBuf[WorkBuffSz]; // The singular universal data array used for all things including logging
 
 const uint8_t Touch70I_WG[] = {
@@ -111,34 +127,159 @@ const uint8_t Touch70I_WG[] = {
     108, 47,  235, 103, 117, 112, 118, 98,  86,  49,  246, 206, 235, 63,  1,   55,  97,  247, 70,
     0,   0,   26,  255, 255, 255, 32,  32,  48,  0,   4,   0,   0,   0,   0,   0,   0,   0};
 
-static uint32_t Width;
-static uint32_t Height;
-static uint32_t HOffset;
-static uint32_t VOffset;
-static uint8_t Touch;
+static void HalEnable(void *device)
+{
+  (void)device;
+  HAL_SPI_Enable();
+}
+
+static void HalDisable(void *device)
+{
+  (void)device;
+  HAL_SPI_Disable();
+}
+
+static uint8_t HalWrite(void *device, uint8_t data)
+{
+  (void)device;
+  return HAL_SPI_Write(data);
+}
+
+static void HalWriteBuffer(void *device, uint8_t *buffer, uint32_t length)
+{
+  (void)device;
+  HAL_SPI_WriteBuffer(buffer, length);
+}
+
+static void HalReadBuffer(void *device, uint8_t *buffer, uint32_t length)
+{
+  (void)device;
+  HAL_SPI_ReadBuffer(buffer, length);
+}
+
+static int HalOpen(void *device)
+{
+  (void)device;
+  return HAL_Eve_Open();
+}
+
+static int HalReset(void *device)
+{
+  (void)device;
+  return HAL_Eve_Reset_HW();
+}
+
+static void HalClose(void *device)
+{
+  (void)device;
+  HAL_Close();
+}
+
+static int HalLost(void *device)
+{
+  (void)device;
+  return HAL_Eve_Lost();
+}
+
+// Stand-ins for the parts of hw_api.h which platform HALs written before them do not have.  Weak
+// symbols need GCC or Clang, with other compilers the HAL has to bring all of hw_api.h.
+#if defined(__GNUC__)
+#define SOFT_TIME_STEP_US 10 // How far the stand-in clock moves per reading
+
+static uint32_t SoftTimeUs;
+
+__attribute__((weak)) void HAL_DelayUs(uint32_t microSeconds)
+{
+  SoftTimeUs += microSeconds;
+  HAL_Delay((microSeconds + 999) / 1000);
+}
+
+// Without a clock of the platform, time moves on as it is read.  Timeouts then end after a number
+// of polls rather than after the time, which is close enough for a bus poll of a few us.
+__attribute__((weak)) uint32_t HAL_TimeUs(void)
+{
+  SoftTimeUs += SOFT_TIME_STEP_US;
+  return SoftTimeUs;
+}
+
+// EVE on a SPI bus of the host itself: nothing to open, and never lost
+__attribute__((weak)) int HAL_Eve_Open(void)
+{
+  return 1;
+}
+
+__attribute__((weak)) int HAL_Eve_Lost(void)
+{
+  return 0;
+}
+#endif
+
+// The functions of hw_api.h, for contexts without a HAL of their own
+#define DEFAULT_HAL                                                                               \
+  {                                                                                               \
+    NULL, HalEnable, HalDisable, HalWrite, HalWriteBuffer, HalReadBuffer, HalOpen, HalReset,      \
+        HalClose, HalLost                                                                         \
+  }
+static const EVE_Hal DefaultHal = DEFAULT_HAL;
+
+static EVE_Context DefaultContext = {.Hal = DEFAULT_HAL};
+static EVE_THREAD_LOCAL EVE_Context *Current;
+
+void EVE_ContextInit(EVE_Context *context, const EVE_Hal *hal)
+{
+  memset(context, 0, sizeof(*context));
+  context->Hal = hal ? *hal : DefaultHal;
+}
+
+void EVE_SetContext(EVE_Context *context)
+{
+  Current = context;
+}
+
+EVE_Context *EVE_GetContext(void)
+{
+  return Current ? Current : &DefaultContext;
+}
+
+void EVE_GetStats(EVE_Stats *stats)
+{
+  *stats = EVE_GetContext()->Stats;
+}
+
+void EVE_Close(void)
+{
+  EVE_Context *Context = EVE_GetContext();
+
+  Context->Hal.Close(Context->Hal.Device);
+}
 
 uint32_t Display_Width()
 {
-  return Width;
+  return EVE_GetContext()->Width;
 }
 
 uint32_t Display_Height()
 {
-  return Height;
+  return EVE_GetContext()->Height;
 }
 
 uint8_t Display_Touch()
 {
-  return Touch;
+  return EVE_GetContext()->Touch;
+}
+
+bool EVE_IsBT81x(void)
+{
+  return EVE_GetContext()->Board >= BOARD_EVE3;
 }
 
 uint32_t Display_HOffset()
 {
-  return HOffset;
+  return EVE_GetContext()->HOffset;
 }
 uint32_t Display_VOffset()
 {
-  return VOffset;
+  return EVE_GetContext()->VOffset;
 }
 
 #define COMMAND 0
@@ -223,13 +364,16 @@ void MO_ST7789V_init(void)
   wr16(REG_GPIOX_DIR + RAM_REG, (0x00FF));
   wr16(REG_GPIOX + RAM_REG, 0x00F7);
 
-  HAL_Delay(100); // 1000
+  // ST7789V takes commands 5ms after a reset in sleep mode, but 120ms after one in Sleep Out -
+  // where it still is when it was set up before
+  HAL_Delay(EVE_GetContext()->PanelAwake ? 120 : 5);
 
   // the following is from AFY240320A0-2.8INTH data sheet, page 25
   MO_SPIBB_CS(CS_ENABLE);
   MO_SPIBB_Send(COMMAND, 0x11);
   MO_SPIBB_CS(CS_DISABLE);
-  HAL_Delay(120); // Delay 120ms
+  HAL_Delay(5); // Next command 5ms after SLPOUT, the 120ms only apply before another SLPIN
+  EVE_GetContext()->PanelAwake = true;
 
   MO_SPIBB_CS(CS_ENABLE);
   MO_SPIBB_Send(COMMAND, 0x36); // MADCTRL
@@ -345,326 +489,272 @@ void MO_ST7789V_init(void)
   MO_SPIBB_CS(CS_DISABLE);
 }
 
+// Panel timings, one entry per display in displays.h.  Second line: HCycle, HOffset, HSync0,
+// HSync1, VCycle, VOffset, VSync0, VSync1, PClk, Swizzle, PClkPol, CSpread, Dither, HSize, VSize
+static const Display_Timing Displays[] = {
+    // clang-format off
+    {DISPLAY_70_800x480, "70_800x480", 800, 480, 0, 0,
+     928, 88, 0, 48, 525, 32, 0, 3, 2, 0, 1, 0, 1, 800, 480},
+    {DISPLAY_50_800x480, "50_800x480", 800, 480, 0, 0,
+     928, 88, 0, 48, 525, 32, 0, 3, 2, 0, 1, 0, 1, 800, 480},
+    {DISPLAY_43_480x272, "43_480x272", 480, 272, 0, 0,
+     548, 43, 0, 41, 292, 12, 0, 10, 5, 0, 1, 1, 1, 480, 272},
+    {DISPLAY_43_800480, "43_800480", 800, 480, 0, 0,
+     977, 176, 40, 88, 529, 48, 13, 16, 2, 0, 1, 0, 1, 800, 480},
+    {DISPLAY_39_480x128, "39_480x128", 480, 128, 0, 126,
+     552, 71, 28, 44, 308, 35, 8, 11, 6, 0, 1, 0, 1, 480, 272},
+    {DISPLAY_38_480x116, "38_480x116", 480, 116, 0, 156,
+     527, 46, 1, 3, 291, 18, 4, 6, 5, 0, 1, 1, 1, 480, 272},
+    {DISPLAY_35_320x240, "35_320x240", 320, 240, 0, 0,
+     408, 68, 0, 10, 262, 18, 0, 2, 8, 0, 0, 1, 1, 320, 240},
+    {DISPLAY_29_320x102, "29_320x102", 320, 102, 0, 0,
+     408, 70, 0, 10, 262, 156, 0, 2, 8, 0, 0, 1, 1, 320, 102},
+    {DISPLAY_40_720x720, "40_720x720", 720, 720, 0, 0,
+     812, 91, 46, 48, 756, 35, 16, 18, 2, 0, 1, 0, 0, 720, 720},
+    {DISPLAY_101_1280x800, "101_1280x800", 1280, 800, 0, 0,
+     1440, 158, 78, 80, 823, 22, 11, 12, 1, 0, 0, 0, 1, 1280, 800},
+    {DISPLAY_70_1024x600, "70_1024x600", 1024, 600, 0, 0,
+     1344, 319, 12, 230, 635, 34, 12, 22, 1, 0, 1, 0, 1, 1024, 600},
+    {DISPLAY_70_1024x600_WG, "70_1024x600_WG", 1024, 600, 0, 0,
+     1344, 319, 12, 230, 635, 34, 12, 22, 1, 0, 1, 0, 1, 1024, 600},
+    {DISPLAY_24_320x240, "24_320x240", 240, 320, 0, 0,
+     298, 57, 38, 48, 336, 15, 8, 8, 6, 0, 0, 1, 1, 240, 320},
+    // clang-format on
+};
+
+const Display_Timing *Display_Find(int display)
+{
+  uint32_t Index;
+
+  for (Index = 0; Index < sizeof(Displays) / sizeof(Displays[0]); Index++)
+  {
+    if (Displays[Index].Display == display)
+      return &Displays[Index];
+  }
+  return NULL;
+}
+
+// Display, board or touch id from a name as used for the build directories ("43_480x272",
+// "EVE3", "TPC") or a number from displays.h.  Returns -1 for names it does not know.
+int Display_Parse(const char *name)
+{
+  static const char *Boards[] = {"EVE2", "EVE3", "EVE4"};
+  static const char *Touches[] = {"TPN", "TPR", "TPC"};
+  uint32_t Index;
+  char *End;
+  long Value;
+
+  Value = strtol(name, &End, 10);
+  if ((End != name) && !*End)
+    return (int)Value;
+  for (Index = 0; Index < sizeof(Displays) / sizeof(Displays[0]); Index++)
+  {
+    if (!strcmp(Displays[Index].Name, name))
+      return Displays[Index].Display;
+  }
+  for (Index = 0; Index < 3; Index++)
+  {
+    if (!strcmp(Boards[Index], name))
+      return BOARD_EVE2 + (int)Index;
+    if (!strcmp(Touches[Index], name))
+      return TOUCH_TPN + (int)Index;
+  }
+  return -1;
+}
+
+#if defined(_WIN32) || defined(__unix__) || defined(__APPLE__)
+// Fill in display, board and touch passed as *_AUTO from the environment (EVE_DISPLAY, EVE_BOARD,
+// EVE_TOUCH) or from a config file with lines like "display = 43_480x272" - named by EVE_CONFIG,
+// eve.cfg in the working directory otherwise.  The environment wins over the file.  Only hosted
+// platforms have either.
+static void LoadConfig(int *display, int *board, int *touch)
+{
+  const char *Keys[] = {"display", "board", "touch"};
+  const char *Variables[] = {"EVE_DISPLAY", "EVE_BOARD", "EVE_TOUCH"};
+  int *Values[] = {display, board, touch};
+  char Line[128], Key[32], Value[64];
+  const char *Name;
+  uint32_t Index;
+  FILE *File;
+
+  // All the *_AUTO values are -1
+  for (Index = 0; Index < 3; Index++)
+  {
+    Name = getenv(Variables[Index]);
+    if (Name && (*Values[Index] == -1))
+      *Values[Index] = Display_Parse(Name);
+  }
+
+  Name = getenv("EVE_CONFIG");
+  File = fopen(Name ? Name : "eve.cfg", "r");
+  if (!File)
+    return;
+  while (fgets(Line, sizeof(Line), File))
+  {
+    if ((Line[0] == '#') || (sscanf(Line, " %31[a-z] = %63s", Key, Value) != 2))
+      continue;
+    for (Index = 0; Index < 3; Index++)
+    {
+      if ((*Values[Index] == -1) && !strcmp(Key, Keys[Index]))
+        *Values[Index] = Display_Parse(Value);
+    }
+  }
+  fclose(File);
+}
+#endif
+
+// Poll a register until (value & mask) == expected, or timeoutUs passed.  Startup waits for what
+// it needs instead of sleeping for the worst case.
+static bool PollReg(uint32_t address, uint32_t mask, uint32_t expected, uint32_t timeoutUs)
+{
+  uint32_t Start = HAL_TimeUs();
+
+  do
+  {
+    if ((rd32(address) & mask) == expected)
+      return true;
+  } while (HAL_TimeUs() - Start < timeoutUs);
+  return (rd32(address) & mask) == expected;
+}
+
+// Hold the coprocessor in reset, empty the FIFO and let it go.  REG_CMD_READ, REG_CMD_WRITE and
+// REG_CMD_DL sit next to each other and are cleared in one transaction.  The reset loses the patch
+// pointer of the BT81x and detaches the flash, so both are put back afterwards.  Returns false if
+// the coprocessor does not come back.
+static bool ResetCoPro(void)
+{
+  static const uint8_t Zero[REG_CMD_DL + 4 - REG_CMD_READ] = {0};
+  bool BT81x = EVE_IsBT81x(); // FT81x has neither a patch pointer nor flash
+  uint32_t Patch_Add = BT81x ? rd32(REG_COPRO_PATCH_PTR + RAM_REG) : 0;
+  uint8_t FlashStatus = BT81x ? rd8(REG_FLASH_STATUS + RAM_REG) : FLASH_STATUS_INIT;
+
+  wr8(REG_CPU_RESET + RAM_REG, 1);
+  wrN(REG_CMD_READ + RAM_REG, Zero, sizeof(Zero));
+  wr8(REG_CPU_RESET + RAM_REG, 0);
+  if (BT81x)
+    wr32(REG_COPRO_PATCH_PTR + RAM_REG, Patch_Add);
+  FifoWriteLocation = 0;
+  if (!PollReg(REG_CMD_READ + RAM_REG, 0xFFF, 0, ENGINE_TIMEOUT_US))
+    return false;
+
+  if ((FlashStatus != FLASH_STATUS_BASIC) && (FlashStatus != FLASH_STATUS_FULL))
+    return true;
+  if (rd8(REG_FLASH_STATUS + RAM_REG) == FlashStatus)
+    return true;
+  // Straight into the FIFO rather than through Send_CMD, these are not commands of the application
+  // and the command hook is not to see them
+  wr32(RAM_CMD + FifoWriteLocation, CMD_FLASHATTACH);
+  FifoWriteLocation += FT_CMD_SIZE;
+  if (FlashStatus == FLASH_STATUS_FULL)
+  {
+    wr32(RAM_CMD + FifoWriteLocation, CMD_FLASHFAST);
+    wr32(RAM_CMD + FifoWriteLocation + FT_CMD_SIZE, 0); // Result
+    FifoWriteLocation += 2 * FT_CMD_SIZE;
+  }
+  UpdateFIFO();
+  return PollReg(REG_CMD_READ + RAM_REG, 0xFFF, FifoWriteLocation, ENGINE_TIMEOUT_US);
+}
+
+// Fill in the display, board and touch left to runtime and take on the display size
+static const Display_Timing *Configure(int *display, int *board, int *touch)
+{
+  EVE_Context *Context = EVE_GetContext();
+  const Display_Timing *Timing;
+
+#if defined(_WIN32) || defined(__unix__) || defined(__APPLE__)
+  LoadConfig(display, board, touch);
+#endif
+  if (*touch == TOUCH_AUTO)
+    *touch = TOUCH_TPN;
+  Timing = Display_Find(*display);
+  if (!Timing)
+  {
+    printf("Unknown display type\n");
+    return NULL;
+  }
+  Context->Width = Timing->Width;
+  Context->Height = Timing->Height;
+  Context->HOffset = Timing->PixHOffset;
+  Context->VOffset = Timing->PixVOffset;
+  Context->Touch = *touch;
+  Context->Display = *display;
+  Context->Board = *board;
+  return Timing;
+}
+
+// REG_TOUCH_CONFIG for a touch panel, 0 if there is none
+static uint16_t TouchConfig(int display, int touch)
+{
+  if (touch == TOUCH_TPR)
+    return 0x8381;
+  if (touch != TOUCH_TPC)
+    return 0;
+  if (display == DISPLAY_40_720x720)
+    return 0x480; // FT6336U touch controller
+  return 0x5d0;
+}
+
+// The chip ID only sits in RAM_G right after boot, wake EVE on its internal clock to read it
+static int DetectBoard(void)
+{
+  uint32_t ChipID = 0;
+
+  HostCommand(HCMD_ACTIVE);
+  if (!PollReg(REG_ID + RAM_REG, 0xFF, 0x7C, BOOT_TIMEOUT_US))
+    return BOARD_AUTO;
+  ChipID = (rd32(REG_CHIP_ID) >> 8) & 0xFF; // 0x13 for FT813, 0x15 for BT815, ...
+  Log("Detected a %s%02X\n", (ChipID >= 0x15) ? "BT8" : "FT8", (unsigned)ChipID);
+  if (ChipID >= 0x17)
+    return BOARD_EVE4;
+  if (ChipID >= 0x15)
+    return BOARD_EVE3;
+  if (ChipID >= 0x10)
+    return BOARD_EVE2;
+  return BOARD_AUTO;
+}
+
 // Call this function once at powerup to reset and initialize the EVE chip
-// The Display, board and touch defines can be found in displays.h.
+// The Display, board and touch defines can be found in displays.h.  DISPLAY_AUTO, BOARD_AUTO and
+// TOUCH_AUTO pick them at runtime - see LoadConfig - and the board from the chip ID otherwise.
 int EVE_Init(int display, int board, int touch)
 {
   uint32_t Ready = false;
-  int DWIDTH;
-  int DHEIGHT;
-  int PIXVOFFSET;
-  int PIXHOFFSET;
-  int HCYCLE;
-  int HOFFSET;
-  int HSYNC0;
-  int HSYNC1;
-  int VCYCLE;
-  int VOFFSET;
-  int VSYNC0;
-  int VSYNC1;
-  int PCLK;
-  int SWIZZLE;
-  int PCLK_POL;
-  int HSIZE;
-  int VSIZE;
-  int CSPREAD;
-  int DITHER;
-
-  switch (display)
-  {
-  case DISPLAY_70_800x480:
-    DWIDTH = 800;
-    DHEIGHT = 480;
-    PIXVOFFSET = 0;
-    PIXHOFFSET = 0;
-    HCYCLE = 928;
-    HOFFSET = 88;
-    HSYNC0 = 0;
-    HSYNC1 = 48;
-    VCYCLE = 525;
-    VOFFSET = 32;
-    VSYNC0 = 0;
-    VSYNC1 = 3;
-    PCLK = 2;
-    SWIZZLE = 0;
-    PCLK_POL = 1;
-    HSIZE = 800;
-    VSIZE = 480;
-    CSPREAD = 0;
-    DITHER = 1;
-    break;
-  case DISPLAY_50_800x480:
-    DWIDTH = 800;
-    DHEIGHT = 480;
-    PIXVOFFSET = 0;
-    PIXHOFFSET = 0;
-    HCYCLE = 928;
-    HOFFSET = 88;
-    HSYNC0 = 0;
-    HSYNC1 = 48;
-    VCYCLE = 525;
-    VOFFSET = 32;
-    VSYNC0 = 0;
-    VSYNC1 = 3;
-    PCLK = 2;
-    SWIZZLE = 0;
-    PCLK_POL = 1;
-    HSIZE = 800;
-    VSIZE = 480;
-    CSPREAD = 0;
-    DITHER = 1;
-    break;
-  case DISPLAY_43_480x272:
-    DWIDTH = 480;
-    DHEIGHT = 272;
-    PIXVOFFSET = 0;
-    PIXHOFFSET = 0;
-    HCYCLE = 548;
-    HOFFSET = 43;
-    HSYNC0 = 0;
-    HSYNC1 = 41;
-    VCYCLE = 292;
-    VOFFSET = 12;
-    VSYNC0 = 0;
-    VSYNC1 = 10;
-    PCLK = 5;
-    SWIZZLE = 0;
-    PCLK_POL = 1;
-    HSIZE = 480;
-    VSIZE = 272;
-    CSPREAD = 1;
-    DITHER = 1;
-    break;
-  case DISPLAY_43_800480:
-    DWIDTH = 800;
-    DHEIGHT = 480;
-    PIXVOFFSET = 0;
-    PIXHOFFSET = 0;
-    HCYCLE = 977;
-    HOFFSET = 176;
-    HSYNC0 = 40;
-    HSYNC1 = 88;
-    VCYCLE = 529;
-    VOFFSET = 48;
-    VSYNC0 = 13;
-    VSYNC1 = 16;
-    PCLK = 2;
-    SWIZZLE = 0;
-    PCLK_POL = 1;
-    HSIZE = 800;
-    VSIZE = 480;
-    CSPREAD = 0;
-    DITHER = 1;
-    break;
-  case DISPLAY_39_480x128:
-    DWIDTH = 480;
-    DHEIGHT = 128;
-    PIXVOFFSET = 126;
-    PIXHOFFSET = 0;
-    HCYCLE = 552;
-    HOFFSET = 71;
-    HSYNC0 = 28;
-    HSYNC1 = 44;
-    VCYCLE = 308;
-    VOFFSET = 35;
-    VSYNC0 = 8;
-    VSYNC1 = 11;
-    PCLK = 6; //
-    SWIZZLE = 0;
-    PCLK_POL = 1;
-    HSIZE = 480;
-    VSIZE = 272;
-    CSPREAD = 0;
-    DITHER = 1;
-    break;
-  case DISPLAY_38_480x116:
-    DWIDTH = 480;
-    DHEIGHT = 116;
-    PIXVOFFSET = 156;
-    PIXHOFFSET = 0;
-    HCYCLE = 527;
-    HOFFSET = 46;
-    HSYNC0 = 1;
-    HSYNC1 = 3;
-    VCYCLE = 291;
-    VOFFSET = 18;
-    VSYNC0 = 4;
-    VSYNC1 = 6;
-    PCLK = 5;
-    SWIZZLE = 0;
-    PCLK_POL = 1;
-    HSIZE = 480;
-    VSIZE = 272;
-    CSPREAD = 1;
-    DITHER = 1;
-    break;
-  case DISPLAY_35_320x240:
-    DWIDTH = 320;
-    DHEIGHT = 240;
-    PIXVOFFSET = 0;
-    PIXHOFFSET = 0;
-    HCYCLE = 408;
-    HOFFSET = 68;
-    HSYNC0 = 0;
-    HSYNC1 = 10;
-    VCYCLE = 262;
-    VOFFSET = 18;
-    VSYNC0 = 0;
-    VSYNC1 = 2;
-    PCLK = 8;
-    SWIZZLE = 0;
-    PCLK_POL = 0;
-    HSIZE = 320;
-    VSIZE = 240;
-    CSPREAD = 1;
-    DITHER = 1;
-    break;
-  case DISPLAY_29_320x102:
-    DWIDTH = 320;
-    DHEIGHT = 102;
-    PIXVOFFSET = 0;
-    PIXHOFFSET = 0;
-    HCYCLE = 408;
-    HOFFSET = 70;
-    HSYNC0 = 0;
-    HSYNC1 = 10;
-    VCYCLE = 262;
-    VOFFSET = 156;
-    VSYNC0 = 0;
-    VSYNC1 = 2;
-    PCLK = 8;
-    SWIZZLE = 0;
-    PCLK_POL = 0;
-    HSIZE = 320;
-    VSIZE = 102;
-    CSPREAD = 1;
-    DITHER = 1;
-    break;
-  case DISPLAY_40_720x720:
-    DWIDTH = 720;
-    DHEIGHT = 720;
-    PIXVOFFSET = 0;
-    PIXHOFFSET = 0;
-    HCYCLE = 812;
-    HOFFSET = 91;
-    HSYNC0 = 46;
-    HSYNC1 = 48;
-    VCYCLE = 756;
-    VOFFSET = 35;
-    VSYNC0 = 16;
-    VSYNC1 = 18;
-    PCLK = 2;
-    SWIZZLE = 0;
-    PCLK_POL = 1;
-    HSIZE = 720;
-    VSIZE = 720;
-    CSPREAD = 0;
-    DITHER = 0;
-    break;
-  case DISPLAY_101_1280x800:
-    DWIDTH = 1280;
-    DHEIGHT = 800;
-    PIXVOFFSET = 0;
-    PIXHOFFSET = 0;
-    HCYCLE = 1440;
-    HOFFSET = 158;
-    HSYNC0 = 78;
-    HSYNC1 = 80;
-    VCYCLE = 823;
-    VOFFSET = 22;
-    VSYNC0 = 11;
-    VSYNC1 = 12;
-    PCLK = 1;
-    SWIZZLE = 0;
-    PCLK_POL = 0;
-    HSIZE = 1280;
-    VSIZE = 800;
-    CSPREAD = 0;
-    DITHER = 1;
-    break;
-  case DISPLAY_70_1024x600_WG:
-  case DISPLAY_70_1024x600:
-    DWIDTH = 1024;
-    DHEIGHT = 600;
-    PIXVOFFSET = 0;
-    PIXHOFFSET = 0;
-    HCYCLE = 1344;
-    HOFFSET = 319;
-    HSYNC0 = 12;
-    HSYNC1 = 230;
-    VCYCLE = 635;
-    VOFFSET = 34;
-    VSYNC0 = 12;
-    VSYNC1 = 22;
-    PCLK = 1;
-    SWIZZLE = 0;
-    PCLK_POL = 1;
-    HSIZE = 1024;
-    VSIZE = 600;
-    CSPREAD = 0;
-    DITHER = 1;
-    break;
-  case DISPLAY_24_320x240:
-    DWIDTH = 240;
-    DHEIGHT = 320;
-    PIXVOFFSET = 0;
-    PIXHOFFSET = 0;
-    HCYCLE = 298;
-    HOFFSET = 57;
-    HSYNC0 = 38;
-    HSYNC1 = 48;
-    VCYCLE = 336;
-    VOFFSET = 15;
-    VSYNC0 = 8;
-    VSYNC1 = 8;
-    PCLK = 6;
-    SWIZZLE = 0;
-    PCLK_POL = 0;
-    HSIZE = 240;
-    VSIZE = 320;
-    CSPREAD = 1;
-    DITHER = 1;
-    break;
-  default:
-    printf("Unknown display type\n");
+  uint32_t Start = HAL_TimeUs();
+  EVE_Startup *Startup = &EVE_GetContext()->Startup;
+  const Display_Timing *Timing;
+
+  Timing = Configure(&display, &board, &touch);
+  if (!Timing)
     return 0;
-    break;
+  if (board == BOARD_AUTO)
+  {
+    if (!Eve_Reset())
+      return 0;
+    board = DetectBoard();
+    if (board == BOARD_AUTO)
+      return 1; // bridge detected but no eve found
+    EVE_GetContext()->Board = board;
   }
-  Width = DWIDTH;
-  Height = DHEIGHT;
-  HOffset = PIXHOFFSET;
-  VOffset = PIXVOFFSET;
-  Touch = touch;
+
   if (!Eve_Reset()) // Hard reset of the EVE chip
     return 0;
+  Startup->ResetUs = HAL_TimeUs() - Start;
 
-  // Wakeup EVE
+  // Wakeup EVE.  REG_ID reads 0x7C once the boot is done, REG_CPU_RESET 0 once the coprocessor,
+  // touch and audio engines left reset and REG_CMD_READ 0 once the coprocessor is idle.
   if (board >= BOARD_EVE3)
   {
     HostCommand(HCMD_CLKEXT);
   }
   HostCommand(HCMD_ACTIVE);
-  HAL_Delay(300);
-
-  for (int loop = 0; loop < 50; loop++)
-  {
-    Ready = Cmd_READ_REG_ID();
-    if (Ready)
-      break;
-    HAL_Delay(5);
-  }
-  if (!Ready)
+  if (!PollReg(REG_ID + RAM_REG, 0xFF, 0x7C, BOOT_TIMEOUT_US))
     return 1; // bridge detected but no eve found
+  Startup->BootUs = HAL_TimeUs() - Start;
 
-  for (int loop = 0; loop < 50; loop++)
-  {
-    Ready = rd16(REG_CPU_RESET);
-    if (Ready)
-      break;
-    HAL_Delay(5);
-  }
-  if (!Ready)
-    return 1; // bridge detected but no eve found
+  if (!PollReg(REG_CPU_RESET + RAM_REG, 0x07, 0, ENGINE_TIMEOUT_US) ||
+      !PollReg(REG_CMD_READ + RAM_REG, 0xFFF, 0, ENGINE_TIMEOUT_US))
+    Log("EVE engines not ready after %u us\n", (unsigned)(HAL_TimeUs() - Start));
+  Startup->EnginesUs = HAL_TimeUs() - Start;
 
   //  Log("EVE now ACTIVE\n");         //
 
@@ -685,16 +775,7 @@ int EVE_Init(int display, int board, int touch)
   // about something that happened before the last reset.  If EVE has just done a power cycle, this
   // would be unnecessary.
   if (rd16(REG_CMD_READ + RAM_REG) == 0xFFF)
-  {
-    // EVE is unhappy - needs a paddling.
-    uint32_t Patch_Add = rd32(REG_COPRO_PATCH_PTR + RAM_REG);
-    wr8(REG_CPU_RESET + RAM_REG, 1);
-    wr16(REG_CMD_READ + RAM_REG, 0);
-    wr16(REG_CMD_WRITE + RAM_REG, 0);
-    wr16(REG_CMD_DL + RAM_REG, 0);
-    wr8(REG_CPU_RESET + RAM_REG, 0);
-    wr32(REG_COPRO_PATCH_PTR + RAM_REG, Patch_Add);
-  }
+    ResetCoPro(); // EVE is unhappy - needs a paddling.
 
   // Turn off screen output during startup
   wr16(REG_GPIOX + RAM_REG,
@@ -710,37 +791,33 @@ int EVE_Init(int display, int board, int touch)
   // Load parameters of the physical screen to the EVE
   // All of these registers are 32 bits, but most bits are reserved, so only write what is actually
   // used
-  wr16(REG_HCYCLE + RAM_REG, HCYCLE);    // Set H_Cycle to 548
-  wr16(REG_HOFFSET + RAM_REG, HOFFSET);  // Set H_Offset to 43
-  wr16(REG_HSYNC0 + RAM_REG, HSYNC0);    // Set H_SYNC_0 to 0
-  wr16(REG_HSYNC1 + RAM_REG, HSYNC1);    // Set H_SYNC_1 to 41
-  wr16(REG_VCYCLE + RAM_REG, VCYCLE);    // Set V_Cycle to 292
-  wr16(REG_VOFFSET + RAM_REG, VOFFSET);  // Set V_OFFSET to 12
-  wr16(REG_VSYNC0 + RAM_REG, VSYNC0);    // Set V_SYNC_0 to 0
-  wr16(REG_VSYNC1 + RAM_REG, VSYNC1);    // Set V_SYNC_1 to 10
-  wr8(REG_SWIZZLE + RAM_REG, SWIZZLE);   // Set SWIZZLE to 0
-  wr8(REG_PCLK_POL + RAM_REG, PCLK_POL); // Set PCLK_POL to 1
-  wr16(REG_HSIZE + RAM_REG, HSIZE);      // Set H_SIZE to 480
-  wr16(REG_VSIZE + RAM_REG, VSIZE);      // Set V_SIZE to 272
-  wr8(REG_CSPREAD + RAM_REG, CSPREAD); // Set CSPREAD to 1    (32 bit register - write only 8 bits)
-  wr8(REG_DITHER + RAM_REG, DITHER);   // Set DITHER to 1     (32 bit register - write only 8 bits)
+  wr16(REG_HCYCLE + RAM_REG, Timing->HCycle);
+  wr16(REG_HOFFSET + RAM_REG, Timing->HOffset);
+  wr16(REG_HSYNC0 + RAM_REG, Timing->HSync0);
+  wr16(REG_HSYNC1 + RAM_REG, Timing->HSync1);
+  wr16(REG_VCYCLE + RAM_REG, Timing->VCycle);
+  wr16(REG_VOFFSET + RAM_REG, Timing->VOffset);
+  wr16(REG_VSYNC0 + RAM_REG, Timing->VSync0);
+  wr16(REG_VSYNC1 + RAM_REG, Timing->VSync1);
+  wr8(REG_SWIZZLE + RAM_REG, Timing->Swizzle);
+  wr8(REG_PCLK_POL + RAM_REG, Timing->PClkPol);
+  wr16(REG_HSIZE + RAM_REG, Timing->HSize);
+  wr16(REG_VSIZE + RAM_REG, Timing->VSize);
+  wr8(REG_CSPREAD + RAM_REG, Timing->CSpread); // 32 bit register - write only 8 bits
+  wr8(REG_DITHER + RAM_REG, Timing->Dither);   // 32 bit register - write only 8 bits
 
   /* Reset the touch engine, since it has sometimes issues starting up. */
   wr32(RAM_REG + REG_CPU_RESET, 1 << 1);
-  HAL_Delay(10);
+  HAL_DelayUs(100);
   wr32(RAM_REG + REG_CPU_RESET, 0);
-  HAL_Delay(10);
+  PollReg(REG_CPU_RESET + RAM_REG, 0x07, 0, ENGINE_TIMEOUT_US);
   // Configure touch & audio
-  if (touch == TOUCH_TPR)
+  if ((touch == TOUCH_TPR) || (touch == TOUCH_TPC))
   {
-    wr16(REG_TOUCH_CONFIG + RAM_REG, 0x8381);
+    wr16(REG_TOUCH_CONFIG + RAM_REG, TouchConfig(display, touch));
   }
-  else if (touch == TOUCH_TPC)
+  if (touch == TOUCH_TPC)
   {
-    if (display == DISPLAY_40_720x720)
-      wr16(REG_TOUCH_CONFIG + RAM_REG, 0x480); // FT6336U touch controller
-    else
-      wr16(REG_TOUCH_CONFIG + RAM_REG, 0x5d0);
     if (board == BOARD_EVE2)
     {
       Cap_Touch_Upload();
@@ -778,15 +855,144 @@ int EVE_Init(int display, int board, int touch)
   wr32(RAM_DL + 4, CLEAR(1, 1, 1));
   wr32(RAM_DL + 8, DISPLAY());
   wr8(REG_DLSWAP + RAM_REG, DLSWAP_FRAME); // Swap display lists
-  wr8(REG_PCLK + RAM_REG, PCLK);           // After this display is visible on the TFT
+  wr8(REG_PCLK + RAM_REG, Timing->PClk);   // After this display is visible on the TFT
+  Startup->FirstFrameUs = HAL_TimeUs() - Start;
+  Log("First frame after %u us (reset %u, boot %u, engines %u)\n",
+      (unsigned)Startup->FirstFrameUs,
+      (unsigned)Startup->ResetUs,
+      (unsigned)Startup->BootUs,
+      (unsigned)Startup->EnginesUs);
   return Ready;
 }
 
+void EVE_GetStartup(EVE_Startup *startup)
+{
+  *startup = EVE_GetContext()->Startup;
+}
+
+static uint32_t Get32(const uint8_t *buff)
+{
+  return buff[0] | ((uint32_t)buff[1] << 8) | ((uint32_t)buff[2] << 16) |
+         ((uint32_t)buff[3] << 24);
+}
+
+// Check the registers EVE_Init programs against what it would program now.  They are read back in
+// one burst from REG_FREQUENCY to REG_TOUCH_CONFIG, offsets below are relative to REG_FREQUENCY.
+static bool IsConfigured(const Display_Timing *timing, int display, int touch)
+{
+  static const uint8_t Registers[] = {REG_HCYCLE, REG_HOFFSET, REG_HSIZE,  REG_HSYNC0,
+                                      REG_HSYNC1, REG_VCYCLE,  REG_VOFFSET, REG_VSIZE,
+                                      REG_VSYNC0, REG_VSYNC1};
+  uint8_t Regs[REG_TOUCH_CONFIG + 4 - REG_FREQUENCY];
+  uint16_t Expected[sizeof(Registers)];
+  uint32_t Index;
+
+#define REG(reg) Get32(Regs + (reg) - REG_FREQUENCY)
+  rdN(REG_FREQUENCY + RAM_REG, Regs, sizeof(Regs));
+  Expected[0] = timing->HCycle;
+  Expected[1] = timing->HOffset;
+  Expected[2] = timing->HSize;
+  Expected[3] = timing->HSync0;
+  Expected[4] = timing->HSync1;
+  Expected[5] = timing->VCycle;
+  Expected[6] = timing->VOffset;
+  Expected[7] = timing->VSize;
+  Expected[8] = timing->VSync0;
+  Expected[9] = timing->VSync1;
+  for (Index = 0; Index < sizeof(Registers); Index++)
+  {
+    if ((REG(Registers[Index]) & 0xFFFF) != Expected[Index])
+      return false;
+  }
+  if ((REG(REG_FREQUENCY) != ((display == DISPLAY_101_1280x800) ? 80000000 : 60000000)) ||
+      (REG(REG_PCLK) != timing->PClk) || (REG(REG_SWIZZLE) != timing->Swizzle) ||
+      (REG(REG_PCLK_POL) != timing->PClkPol) || (REG(REG_CSPREAD) != timing->CSpread) ||
+      (REG(REG_DITHER) != timing->Dither) || (REG(REG_CPU_RESET) != 0))
+    return false;
+  if ((touch != TOUCH_TPN) && ((REG(REG_TOUCH_CONFIG) & 0xFFFF) != TouchConfig(display, touch)))
+    return false;
+
+  // The coprocessor has to be idle and without a fault, anything else is left over from a host
+  // that stopped in the middle of a command list
+  if ((REG(REG_CMD_READ) & 0xFFF) == 0xFFF)
+    return false;
+  if (REG(REG_CMD_READ) != REG(REG_CMD_WRITE))
+  {
+    if (!PollReg(REG_CMD_READ + RAM_REG, 0xFFF, REG(REG_CMD_WRITE) & 0xFFF, ENGINE_TIMEOUT_US))
+      return false;
+  }
+  FifoWriteLocation = REG(REG_CMD_WRITE) & 0xFFF;
+#undef REG
+  return true;
+}
+
+int EVE_Attach(int display, int board, int touch)
+{
+  uint32_t Start = HAL_TimeUs();
+  EVE_Startup *Startup = &EVE_GetContext()->Startup;
+  const EVE_Hal *Hal = &EVE_GetContext()->Hal;
+  const Display_Timing *Timing;
+  uint32_t ChipID;
+
+  Timing = Configure(&display, &board, &touch);
+  if (!Timing)
+    return 0;
+  if (!Hal->Open(Hal->Device))
+    return 0;
+  if ((rd8(REG_ID + RAM_REG) != 0x7C) || !IsConfigured(Timing, display, touch))
+  {
+    Log("EVE not set up for this display, initializing\n");
+    return EVE_Init(display, board, touch);
+  }
+
+  memset(Startup, 0, sizeof(*Startup));
+  Startup->FirstFrameUs = HAL_TimeUs() - Start;
+  Log("Attached to running EVE after %u us\n", (unsigned)Startup->FirstFrameUs);
+
+  // The chip ID is gone once the application used that part of RAM_G
+  ChipID = rd32(REG_CHIP_ID);
+  if ((ChipID & 0xFFFF00FF) != 0x00010008)
+    ChipID = 2;
+  return ChipID;
+}
+
+bool EVE_Lost(void)
+{
+  const EVE_Hal *Hal = &EVE_GetContext()->Hal;
+
+  return Hal->Lost && Hal->Lost(Hal->Device);
+}
+
+// Reopening a bridge that just went away often fails a few times while USB enumerates it again,
+// so keep trying.  EVE_Attach finds out whether EVE kept running meanwhile - it usually does, the
+// bridge does not power it - and then takes it over as it is.
+int EVE_Reconnect(uint32_t timeoutUs)
+{
+  EVE_Context *Context = EVE_GetContext();
+  uint32_t Start = HAL_TimeUs();
+  int Result;
+
+  do
+  {
+    Result = EVE_Attach(Context->Display, Context->Board, Context->Touch);
+    if ((Result > 1) && !EVE_Lost())
+    {
+      Log("Reconnected after %u us\n", (unsigned)(HAL_TimeUs() - Start));
+      return Context->Startup.ResetUs ? RECONNECT_COLD : RECONNECT_WARM;
+    }
+    HAL_DelayUs(RECONNECT_RETRY_US);
+  } while (HAL_TimeUs() - Start < timeoutUs);
+  Log("Reconnect failed\n");
+  return 0;
+}
+
 // Reset EVE chip via the hardware PDN line
 int Eve_Reset(void)
 {
+  const EVE_Hal *Hal = &EVE_GetContext()->Hal;
+
   FifoWriteLocation = 0;
-  return HAL_Eve_Reset_HW();
+  return Hal->Reset(Hal->Device);
 }
 
 // Upload Goodix Calibration file, ex GT911
@@ -877,16 +1083,75 @@ void Cap_Touch_Upload(void)
   wr8(REG_GPIOX_DIR + RAM_REG, (rd8(RAM_REG + REG_GPIOX_DIR) | 0x08)); // Set Disp GPIO Direction
   wr8(REG_GPIOX + RAM_REG, (rd8(RAM_REG + REG_GPIOX) | 0xF7));         // Clear GPIO
   // Wait more than 100us
-  HAL_Delay(1);
+  HAL_DelayUs(GOODIX_RESET_US);
   // Write REG_CPURESET=0
   wr8(REG_CPU_RESET + RAM_REG, 0);
   // Wait more than 55ms
-  HAL_Delay(100);
+  HAL_DelayUs(GOODIX_BOOT_US);
   // Set GPIO3 to input (floating)
   wr8(REG_GPIOX_DIR + RAM_REG, (rd8(RAM_REG + REG_GPIOX_DIR) & 0xF7)); // Set Disp GPIO Direction
 #endif
 }
 
+// Every SPI transaction in here goes through the HAL of the current context and is bracketed by
+// SPI_Begin and SPI_End, so with a bus lock set (EVE_SetBusLock) another thread can only get
+// between two transactions, never into one.
+void EVE_SetBusLock(void (*lock)(void), void (*unlock)(void))
+{
+  EVE_GetContext()->BusLock = lock;
+  EVE_GetContext()->BusUnlock = unlock;
+}
+
+void EVE_SetCmdHook(void (*word)(uint32_t data),
+                    void (*block)(const uint8_t *buffer, uint32_t count))
+{
+  EVE_GetContext()->CmdHook = word;
+  EVE_GetContext()->BlockHook = block;
+}
+
+static void SPI_Begin(void)
+{
+  EVE_Context *Context = EVE_GetContext();
+
+  if (Context->BusLock)
+    Context->BusLock();
+  Context->Hal.SPI_Enable(Context->Hal.Device);
+  Context->Stats.Transactions++;
+}
+
+static void SPI_End(void)
+{
+  EVE_Context *Context = EVE_GetContext();
+
+  Context->Hal.SPI_Disable(Context->Hal.Device);
+  if (Context->BusUnlock)
+    Context->BusUnlock();
+}
+
+static uint8_t SPI_Write(uint8_t data)
+{
+  EVE_Context *Context = EVE_GetContext();
+
+  Context->Stats.BytesWritten++;
+  return Context->Hal.SPI_Write(Context->Hal.Device, data);
+}
+
+static void SPI_WriteBuffer(uint8_t *buffer, uint32_t length)
+{
+  EVE_Context *Context = EVE_GetContext();
+
+  Context->Stats.BytesWritten += length;
+  Context->Hal.SPI_WriteBuffer(Context->Hal.Device, buffer, length);
+}
+
+static void SPI_ReadBuffer(uint8_t *buffer, uint32_t length)
+{
+  EVE_Context *Context = EVE_GetContext();
+
+  Context->Stats.BytesRead += length;
+  Context->Hal.SPI_ReadBuffer(Context->Hal.Device, buffer, length);
+}
+
 // *** Host Command - FT81X Embedded Video Engine Datasheet - 4.1.5
 // ********************************************** Host Command is a function for changing hardware
 // related parameters of the Eve chip.  The name is confusing. These are related to power modes and
@@ -895,16 +1160,16 @@ void HostCommand(uint8_t HCMD)
 {
   //  Log("Inside HostCommand\n");
 
-  HAL_SPI_Enable();
+  SPI_Begin();
 
-  /*  HAL_SPI_Write(HCMD | 0x40); // In case the manual is making you believe that you just found
+  /*  SPI_Write(HCMD | 0x40); // In case the manual is making you believe that you just found
    * the bug you were looking for - no. */
-  HAL_SPI_Write(HCMD);
-  HAL_SPI_Write(0x00); // This second byte is set to 0 but if there is need for fancy, never used
+  SPI_Write(HCMD);
+  SPI_Write(0x00); // This second byte is set to 0 but if there is need for fancy, never used
                        // setups, then rewrite.
-  HAL_SPI_Write(0x00);
+  SPI_Write(0x00);
 
-  HAL_SPI_Disable();
+  SPI_End();
 }
 
 // *** EVE API Reference Definitions
@@ -914,7 +1179,7 @@ void HostCommand(uint8_t HCMD)
 // ***************************************************************************************************************
 void wr32(uint32_t address, uint32_t parameter)
 {
-  HAL_SPI_Enable();
+  SPI_Begin();
   uint8_t buffer[16];
   int idx = 0;
 
@@ -929,40 +1194,40 @@ void wr32(uint32_t address, uint32_t parameter)
   buffer[idx++] = (uint8_t)((parameter >> 8) & 0xff);
   buffer[idx++] = (uint8_t)((parameter >> 16) & 0xff);
   buffer[idx++] = (uint8_t)((parameter >> 24) & 0xff);
-  HAL_SPI_WriteBuffer(buffer, idx);
+  SPI_WriteBuffer(buffer, idx);
 
-  HAL_SPI_Disable();
+  SPI_End();
 }
 
 void wr16(uint32_t address, uint16_t parameter)
 {
-  HAL_SPI_Enable();
+  SPI_Begin();
 
-  HAL_SPI_Write((uint8_t)((address >> 16) |
+  SPI_Write((uint8_t)((address >> 16) |
                           0x80)); // RAM_REG = 0x302000 and high bit is set - result always 0xB0
-  HAL_SPI_Write((uint8_t)(address >> 8)); // Next byte of the register address
-  HAL_SPI_Write((uint8_t)address); // Low byte of register address - usually just the 1 byte offset
+  SPI_Write((uint8_t)(address >> 8)); // Next byte of the register address
+  SPI_Write((uint8_t)address); // Low byte of register address - usually just the 1 byte offset
 
-  HAL_SPI_Write((uint8_t)(parameter & 0xff)); // Little endian (yes, it is most significant bit
+  SPI_Write((uint8_t)(parameter & 0xff)); // Little endian (yes, it is most significant bit
                                               // first and least significant byte first)
-  HAL_SPI_Write((uint8_t)(parameter >> 8));
+  SPI_Write((uint8_t)(parameter >> 8));
 
-  HAL_SPI_Disable();
+  SPI_End();
 }
 
 void wr8(uint32_t address, uint8_t parameter)
 {
-  HAL_SPI_Enable();
+  SPI_Begin();
 
-  HAL_SPI_Write((uint8_t)((address >> 16) |
+  SPI_Write((uint8_t)((address >> 16) |
                           0x80)); // RAM_REG = 0x302000 and high bit is set - result always 0xB0
-  HAL_SPI_Write((uint8_t)(address >> 8)); // Next byte of the register address
-  HAL_SPI_Write(
+  SPI_Write((uint8_t)(address >> 8)); // Next byte of the register address
+  SPI_Write(
       (uint8_t)(address)); // Low byte of register address - usually just the 1 byte offset
 
-  HAL_SPI_Write(parameter);
+  SPI_Write(parameter);
 
-  HAL_SPI_Disable();
+  SPI_End();
 }
 
 uint32_t rd32(uint32_t address)
@@ -971,15 +1236,15 @@ uint32_t rd32(uint32_t address)
   int idx = 0;
   uint32_t Data32;
 
-  HAL_SPI_Enable();
+  SPI_Begin();
 
   buf[idx++] = (address >> 16) & 0x3F;
   buf[idx++] = (address >> 8) & 0xff;
   buf[idx++] = address & 0xff;
-  HAL_SPI_WriteBuffer(buf, idx);
-  HAL_SPI_ReadBuffer(buf, 4);
+  SPI_WriteBuffer(buf, idx);
+  SPI_ReadBuffer(buf, 4);
 
-  HAL_SPI_Disable();
+  SPI_End();
 
   Data32 = buf[0] + ((uint32_t)buf[1] << 8) + ((uint32_t)buf[2] << 16) + ((uint32_t)buf[3] << 24);
   return (Data32);
@@ -988,15 +1253,15 @@ uint16_t rd16(uint32_t address)
 {
   uint8_t buf[2] = {0, 0};
 
-  HAL_SPI_Enable();
+  SPI_Begin();
 
-  HAL_SPI_Write((address >> 16) & 0x3F);
-  HAL_SPI_Write((address >> 8) & 0xff);
-  HAL_SPI_Write(address & 0xff);
+  SPI_Write((address >> 16) & 0x3F);
+  SPI_Write((address >> 8) & 0xff);
+  SPI_Write(address & 0xff);
 
-  HAL_SPI_ReadBuffer(buf, 2);
+  SPI_ReadBuffer(buf, 2);
 
-  HAL_SPI_Disable();
+  SPI_End();
 
   uint16_t Data16 = buf[0] + ((uint16_t)buf[1] << 8);
   return (Data16);
@@ -1006,31 +1271,71 @@ uint8_t rd8(uint32_t address)
 {
   uint8_t buf[1];
 
-  HAL_SPI_Enable();
+  SPI_Begin();
 
-  HAL_SPI_Write((address >> 16) & 0x3F);
-  HAL_SPI_Write((address >> 8) & 0xff);
-  HAL_SPI_Write(address & 0xff);
+  SPI_Write((address >> 16) & 0x3F);
+  SPI_Write((address >> 8) & 0xff);
+  SPI_Write(address & 0xff);
 
-  HAL_SPI_ReadBuffer(buf, 1);
+  SPI_ReadBuffer(buf, 1);
 
-  HAL_SPI_Disable();
+  SPI_End();
 
   return (buf[0]);
 }
 
+// Read a block of data in bursts, in pieces of BurstSz as wrN writes them
 void rdN(uint32_t address, uint8_t *buffer, uint32_t size)
 {
+  uint32_t TransferSize;
 
-  HAL_SPI_Enable();
+  do
+  {
+    TransferSize = (size > BurstSz) ? BurstSz : size;
 
-  HAL_SPI_Write((address >> 16) & 0x3F);
-  HAL_SPI_Write((address >> 8) & 0xff);
-  HAL_SPI_Write(address & 0xff);
+    SPI_Begin();
 
-  HAL_SPI_ReadBuffer(buffer, size);
+    SPI_Write((address >> 16) & 0x3F);
+    SPI_Write((address >> 8) & 0xff);
+    SPI_Write(address & 0xff);
 
-  HAL_SPI_Disable();
+    SPI_ReadBuffer(buffer, TransferSize);
+
+    SPI_End();
+
+    address += TransferSize;
+    buffer += TransferSize;
+    size -= TransferSize;
+  } while (size);
+}
+
+// Write a block of data in bursts - the address auto increments inside EVE, so each piece goes
+// out as one transaction instead of one transaction per byte.  The pieces are at most BurstSz:
+// MPSSE bridges clock out at most 64K per command, and between two pieces another thread on the
+// bus (the touch sampler of eve_sampler.h, locking with priority) gets its turn instead of
+// waiting for an upload of up to a megabyte.  Every piece sends its address again.
+void wrN(uint32_t address, const uint8_t *buffer, uint32_t size)
+{
+  uint32_t TransferSize;
+
+  do
+  {
+    TransferSize = (size > BurstSz) ? BurstSz : size;
+
+    SPI_Begin();
+
+    SPI_Write((uint8_t)((address >> 16) | 0x80));
+    SPI_Write((uint8_t)(address >> 8));
+    SPI_Write((uint8_t)address);
+
+    SPI_WriteBuffer((uint8_t *)buffer, TransferSize);
+
+    SPI_End();
+
+    address += TransferSize;
+    buffer += TransferSize;
+    size -= TransferSize;
+  } while (size);
 }
 
 // *** Send_Cmd() - this is like cmd() in (some) EVE docs - sends 32 bits but does not update the
@@ -1038,6 +1343,10 @@ void rdN(uint32_t address, uint8_t *buffer, uint32_t size)
 // and "Command buffer" and "Coprocessor") Don't miss section 5.3 - Interaction with RAM_DL
 void Send_CMD(uint32_t data)
 {
+  EVE_Context *Context = EVE_GetContext();
+
+  if (Context->CmdHook)
+    Context->CmdHook(data);
   wr32(FifoWriteLocation + RAM_CMD,
        data); // Write the command at the globally tracked "write pointer" for the FIFO
 
@@ -1060,12 +1369,12 @@ uint8_t Cmd_READ_REG_ID(void)
 {
   uint8_t readData[2];
 
-  HAL_SPI_Enable();
-  HAL_SPI_Write(0x30); // Base address RAM_REG = 0x302000
-  HAL_SPI_Write(0x20);
-  HAL_SPI_Write(REG_ID);           // REG_ID offset = 0x00
-  HAL_SPI_ReadBuffer(readData, 1); // There was a dummy read of the first byte in there
-  HAL_SPI_Disable();
+  SPI_Begin();
+  SPI_Write(0x30); // Base address RAM_REG = 0x302000
+  SPI_Write(0x20);
+  SPI_Write(REG_ID);           // REG_ID offset = 0x00
+  SPI_ReadBuffer(readData, 1); // There was a dummy read of the first byte in there
+  SPI_End();
 
   if (readData[0] == 0x7C) // FT81x Datasheet section 5.1, Table 5-2. Return value always 0x7C
   {
@@ -1288,6 +1597,138 @@ void Cmd_Memcpy(uint32_t dest, uint32_t src, uint32_t num)
   Send_CMD(num);
 }
 
+// *** Cmd_Inflate - decompress zlib data that follows in the FIFO - see CMD_INFLATE in the
+// FT81x Series Programmers Guide ***
+void Cmd_Inflate(uint32_t ptr)
+{
+  Send_CMD(CMD_INFLATE);
+  Send_CMD(ptr);
+}
+
+// *** Cmd_Inflate2 - like Cmd_Inflate, but the data may come from the media FIFO or flash
+// (OPT_MEDIAFIFO, OPT_FLASH) - see CMD_INFLATE2 in the BT81x Series Programming Guide ***
+void Cmd_Inflate2(uint32_t ptr, uint32_t options)
+{
+  Send_CMD(CMD_INFLATE2);
+  Send_CMD(ptr);
+  Send_CMD(options);
+}
+
+// *** Cmd_MediaFifo - set up a ring buffer in RAM_G for streamed data - see CMD_MEDIAFIFO in the
+// FT81x Series Programmers Guide ***
+void Cmd_MediaFifo(uint32_t ptr, uint32_t size)
+{
+  Send_CMD(CMD_MEDIAFIFO);
+  Send_CMD(ptr);
+  Send_CMD(size);
+}
+
+// *** Cmd_LoadImage - decompress a JPEG/PNG image into RAM_G - see CMD_LOADIMAGE in the FT81x
+// Series Programmers Guide ***
+// Without OPT_MEDIAFIFO (or OPT_FLASH) the image data has to follow the command in the FIFO
+void Cmd_LoadImage(uint32_t ptr, uint32_t options)
+{
+  Send_CMD(CMD_LOADIMAGE);
+  Send_CMD(ptr);
+  Send_CMD(options);
+}
+
+// *** Cmd_PlayVideo - play back a complete AVI stream - see CMD_PLAYVIDEO in the FT81x Series
+// Programmers Guide ***
+// With OPT_MEDIAFIFO the video is read from the media FIFO; REG_PLAY_CONTROL pauses or ends it
+void Cmd_PlayVideo(uint32_t options)
+{
+  Send_CMD(CMD_PLAYVIDEO);
+  Send_CMD(options);
+}
+
+// *** Cmd_VideoStart - start the AVI decoder on the stream in the media FIFO - see
+// CMD_VIDEOSTART in the FT81x Series Programmers Guide ***
+void Cmd_VideoStart(void)
+{
+  Send_CMD(CMD_VIDEOSTART);
+}
+
+// *** Cmd_VideoFrame - decode the next video frame from the media FIFO to dst as RGB565 - see
+// CMD_VIDEOFRAME in the FT81x Series Programmers Guide ***
+// ptr is a 32 bit word in RAM_G which is set to 0 after the last frame of the stream
+void Cmd_VideoFrame(uint32_t dst, uint32_t ptr)
+{
+  Send_CMD(CMD_VIDEOFRAME);
+  Send_CMD(dst);
+  Send_CMD(ptr);
+}
+
+// *** Cmd_MemWrite - write the data which follows in the FIFO to memory - see CMD_MEMWRITE in
+// the FT81x Series Programmers Guide ***
+// Unlike a direct write this happens in order with the other queued commands
+void Cmd_MemWrite(uint32_t ptr, uint32_t num)
+{
+  Send_CMD(CMD_MEMWRITE);
+  Send_CMD(ptr);
+  Send_CMD(num);
+}
+
+// *** Cmd_Append - append a block of display list commands from RAM_G to the current display
+// list - see CMD_APPEND in the FT81x Series Programmers Guide ***
+void Cmd_Append(uint32_t ptr, uint32_t num)
+{
+  Send_CMD(CMD_APPEND);
+  Send_CMD(ptr);
+  Send_CMD(num);
+}
+
+// *** Cmd_MemCrc - CRC-32 of a block of RAM_G - see CMD_MEMCRC in the FT81x Series Programmers
+// Guide ***
+// The result replaces the last parameter word in the FIFO
+void Cmd_MemCrc(uint32_t ptr, uint32_t num)
+{
+  Send_CMD(CMD_MEMCRC);
+  Send_CMD(ptr);
+  Send_CMD(num);
+  Send_CMD(0);
+}
+
+// *** Cmd_FlashWrite - write the data which follows in the FIFO to erased flash - see
+// CMD_FLASHWRITE in the BT81x Series Programming Guide ***
+// ptr must be 256 byte aligned, num a multiple of 256
+void Cmd_FlashWrite(uint32_t ptr, uint32_t num)
+{
+  Send_CMD(CMD_FLASHWRITE);
+  Send_CMD(ptr);
+  Send_CMD(num);
+}
+
+// *** Cmd_FlashRead - copy flash to RAM_G - see CMD_FLASHREAD in the BT81x Series Programming
+// Guide ***
+// dest must be 4 byte aligned, src 64 byte aligned and num a multiple of 4
+void Cmd_FlashRead(uint32_t dest, uint32_t src, uint32_t num)
+{
+  Send_CMD(CMD_FLASHREAD);
+  Send_CMD(dest);
+  Send_CMD(src);
+  Send_CMD(num);
+}
+
+// *** Cmd_FlashUpdate - write RAM_G to flash, erasing and programming only the sectors which
+// differ - see CMD_FLASHUPDATE in the BT81x Series Programming Guide ***
+// dest must be 4096 byte aligned, src 4 byte aligned and num a multiple of 4096
+void Cmd_FlashUpdate(uint32_t dest, uint32_t src, uint32_t num)
+{
+  Send_CMD(CMD_FLASHUPDATE);
+  Send_CMD(dest);
+  Send_CMD(src);
+  Send_CMD(num);
+}
+
+// *** Cmd_FlashSource - set the flash address for the following OPT_FLASH command - see
+// CMD_FLASHSOURCE in the BT81x Series Programming Guide ***
+void Cmd_FlashSource(uint32_t ptr)
+{
+  Send_CMD(CMD_FLASHSOURCE);
+  Send_CMD(ptr);
+}
+
 // *** Cmd_GetPtr - Get the last used address from CoPro operation - FT81x Series Programmers Guide
 // Section 5.47 *
 void Cmd_GetPtr(void)
@@ -1374,26 +1815,19 @@ void Cmd_Calibrate(uint32_t result)
 
 // An interactive calibration screen is created and executed.
 // New calibration values are written to the touch matrix registers of Eve.
+// The touch panel is read every CALIBRATE_POLL_MS so the bus stays free for other traffic, see
+// eve_calibrate.h for a version that does not block.
 void Calibrate_Manual(uint16_t Width, uint16_t Height, uint16_t V_Offset, uint16_t H_Offset)
 {
   uint32_t displayX[3], displayY[3];
   uint32_t touchX[3], touchY[3];
-  uint32_t touchValue = 0, storedValue = 0;
-  int32_t tmp, k;
+  uint32_t touchValue = 0;
   int32_t TransMatrix[6];
   uint8_t count = 0;
-  uint8_t pressed = 0;
   char num[2];
 
   // These values determine where your calibration points will be drawn on your display
-  displayX[0] = (uint32_t)(Width * 0.15) + H_Offset;
-  displayY[0] = (uint32_t)(Height * 0.15) + V_Offset;
-
-  displayX[1] = (uint32_t)(Width * 0.85) + H_Offset;
-  displayY[1] = (uint32_t)(Height / 2) + V_Offset;
-
-  displayX[2] = (uint32_t)(Width / 2) + H_Offset;
-  displayY[2] = (uint32_t)(Height * 0.85) + V_Offset;
+  Calibrate_Points(Width, Height, V_Offset, H_Offset, displayX, displayY);
 
   while (count < 3)
   {
@@ -1420,28 +1854,63 @@ void Calibrate_Manual(uint16_t Width, uint16_t Height, uint16_t V_Offset, uint16
     UpdateFIFO();          // Trigger the coprocessor to start processing commands out of the FIFO
     Wait4CoProFIFOEmpty(); // Wait here until the coprocessor has read and executed every pending
                            // command.
-    HAL_Delay(300);
 
-    while (pressed == count)
+    // Wait for the previous point to be released, then for a touch on this one
+    do
     {
+      HAL_Delay(CALIBRATE_POLL_MS);
+      touchValue = rd32(REG_TOUCH_DIRECT_XY + RAM_REG);
+    } while (!(touchValue & 0x80000000));
+    do
+    {
+      HAL_Delay(CALIBRATE_POLL_MS);
       touchValue = rd32(REG_TOUCH_DIRECT_XY + RAM_REG); // Read for any new touch tag inputs
-      if (!(touchValue & 0x80000000))
-      {
-        touchX[count] = (touchValue >> 16) & 0x03FF; // Raw Touchscreen Y coordinate
-        touchY[count] = touchValue & 0x03FF;         // Raw Touchscreen Y coordinate
-
-        // Log("\ndisplay x[%d]: %ld display y[%d]: %ld\n", count, displayX[count], count,
-        // displayY[count]); Log("touch x[%d]: %ld touch y[%d]: %ld\n", count, touchX[count],
-        // count, touchY[count]);
+    } while (touchValue & 0x80000000);
 
-        count++;
-      }
-    }
-    pressed = count;
+    touchX[count] = (touchValue >> 16) & 0x03FF; // Raw Touchscreen X coordinate
+    touchY[count] = touchValue & 0x03FF;         // Raw Touchscreen Y coordinate
+    count++;
+    if ((count == 3) && !Calibrate_Matrix(displayX, displayY, touchX, touchY, TransMatrix))
+      count = 0; // Touches in a line give no transform, take them again
   }
 
+  for (count = 0; count < 6; count++)
+    wr32(REG_TOUCH_TRANSFORM_A + RAM_REG + (count * 4),
+         TransMatrix[count]); // Write to Eve config registers
+}
+
+// Where the three calibration points are drawn
+void Calibrate_Points(uint16_t Width,
+                      uint16_t Height,
+                      uint16_t V_Offset,
+                      uint16_t H_Offset,
+                      uint32_t *displayX,
+                      uint32_t *displayY)
+{
+  displayX[0] = (uint32_t)(Width * 0.15) + H_Offset;
+  displayY[0] = (uint32_t)(Height * 0.15) + V_Offset;
+
+  displayX[1] = (uint32_t)(Width * 0.85) + H_Offset;
+  displayY[1] = (uint32_t)(Height / 2) + V_Offset;
+
+  displayX[2] = (uint32_t)(Width / 2) + H_Offset;
+  displayY[2] = (uint32_t)(Height * 0.85) + V_Offset;
+}
+
+// The touch transform mapping three raw touch points to the display points they were taken at.
+// False, with the matrix left alone, when the touch points are in a line and give no transform.
+bool Calibrate_Matrix(const uint32_t *displayX,
+                      const uint32_t *displayY,
+                      const uint32_t *touchX,
+                      const uint32_t *touchY,
+                      int32_t *TransMatrix)
+{
+  int32_t tmp, k;
+
   k = ((touchX[0] - touchX[2]) * (touchY[1] - touchY[2])) -
       ((touchX[1] - touchX[2]) * (touchY[0] - touchY[2]));
+  if (!k)
+    return false;
 
   tmp = (((displayX[0] - displayX[2]) * (touchY[1] - touchY[2])) -
          ((displayX[1] - displayX[2]) * (touchY[0] - touchY[2])));
@@ -1468,19 +1937,7 @@ void Calibrate_Manual(uint16_t Width, uint16_t Height, uint16_t V_Offset, uint16
          (touchY[1] * (((touchX[0] * displayY[2]) - (touchX[2] * displayY[0])))) +
          (touchY[2] * (((touchX[1] * displayY[0]) - (touchX[0] * displayY[1])))));
   TransMatrix[5] = ((int64_t)tmp << 16) / k;
-
-  count = 0;
-  do
-  {
-    wr32(REG_TOUCH_TRANSFORM_A + RAM_REG + (count * 4),
-         TransMatrix[count]); // Write to Eve config registers
-
-    //    uint16_t ValH = TransMatrix[count] >> 16;
-    //    uint16_t ValL = TransMatrix[count] & 0xFFFF;
-    //    Log("TM%d: 0x%04x %04x\n", count, ValH, ValL);
-
-    count++;
-  } while (count < 6);
+  return true;
 }
 // ***************************************************************************************************************
 // *** Animation functions
@@ -1528,18 +1985,36 @@ void Cmd_AnimDrawFrame(int16_t x, int16_t y, uint32_t aoptr, uint32_t frame)
 // ***************************************************************************************************************
 
 // Find the space available in the GPU AKA coprocessor AKA command buffer AKA FIFO
+// Our own write pointer is used rather than REG_CMD_WRITE, so commands which were queued with
+// Send_CMD() but not yet handed over with UpdateFIFO() count as used space as well.
 uint16_t CoProFIFO_FreeSpace(void)
 {
   uint16_t cmdBufferDiff, cmdBufferRd, cmdBufferWr, retval;
 
   cmdBufferRd = rd16(REG_CMD_READ + RAM_REG);
-  cmdBufferWr = rd16(REG_CMD_WRITE + RAM_REG);
+  cmdBufferWr = FifoWriteLocation;
 
   cmdBufferDiff = (cmdBufferWr - cmdBufferRd) % FT_CMD_FIFO_SIZE; // FT81x Programmers Guide 5.1.1
   retval = (FT_CMD_FIFO_SIZE - 4) - cmdBufferDiff;
   return (retval);
 }
 
+// Check without waiting whether the coprocessor has got to a point in the FIFO.  location is
+// FifoWriteLocation as it was right after queueing the command of interest, so other commands
+// may have been queued behind it since.  A coprocessor fault counts as done as well.
+bool CoProFIFO_Passed(uint16_t location)
+{
+  uint16_t cmdBufferRd, Unread, QueuedBehind;
+
+  cmdBufferRd = rd16(REG_CMD_READ + RAM_REG);
+  if (cmdBufferRd == 0xFFF)
+    return true;
+
+  Unread = (FifoWriteLocation - cmdBufferRd) % FT_CMD_FIFO_SIZE;
+  QueuedBehind = (FifoWriteLocation - location) % FT_CMD_FIFO_SIZE;
+  return Unread <= QueuedBehind;
+}
+
 // Sit and wait until there are the specified number of bytes free in the <GPU/Coprocessor>
 // incoming FIFO
 void Wait4CoProFIFO(uint32_t room)
@@ -1549,74 +2024,91 @@ void Wait4CoProFIFO(uint32_t room)
   do
   {
     getfreespace = CoProFIFO_FreeSpace();
-  } while (getfreespace < room);
+  } while ((getfreespace < room) && !EVE_Lost());
 }
 
-// Sit and wait until the CoPro FIFO is empty
-// Detect operational errors and print the error and stop.
-void Wait4CoProFIFOEmpty(void)
+int CoPro_Recover(void)
+{
+  EVE_Fault *Fault = &EVE_GetContext()->Fault;
+  uint32_t Start = HAL_TimeUs();
+
+  // The report in one read, instead of a byte at a time
+  rdN(RAM_ERR_REPORT, (uint8_t *)Fault->Report, sizeof(Fault->Report));
+  Fault->Report[sizeof(Fault->Report) - 1] = 0;
+  Fault->Faults++;
+  Log("Coprocessor fault: %s\n", Fault->Report);
+
+  if (!ResetCoPro())
+    return COPRO_STUCK;
+  Fault->RecoverUs = HAL_TimeUs() - Start; // Once it runs again, flash attached
+  return COPRO_RECOVERED;
+}
+
+void EVE_GetFault(EVE_Fault *fault)
+{
+  *fault = EVE_GetContext()->Fault;
+}
+
+int CoProFIFO_WaitEmpty(void)
 {
   uint16_t ReadReg;
-  uint8_t ErrChar;
+
   do
   {
     ReadReg = rd16(REG_CMD_READ + RAM_REG);
     if (ReadReg == 0xFFF)
-    {
-      // This is a error which would require sophistication to fix and continue but we fake it
-      // somewhat unsuccessfully
-      Log("\n");
-      uint8_t Offset = 0;
-      do
-      {
-        // Get the error character and display it
-        ErrChar = rd8(RAM_ERR_REPORT + Offset);
-        Offset++;
-        Log("%c", ErrChar);
-      } while ((ErrChar != 0) &&
-               (Offset < 128)); // When the last stuffed character was null, we are done
-      Log("\n");
-
-      // EVE is unhappy - needs a paddling.
-      uint32_t Patch_Add = rd32(REG_COPRO_PATCH_PTR + RAM_REG);
-      wr8(REG_CPU_RESET + RAM_REG, 1);
-      wr16(REG_CMD_READ + RAM_REG, 0);
-      wr16(REG_CMD_WRITE + RAM_REG, 0);
-      wr16(REG_CMD_DL + RAM_REG, 0);
-      wr8(REG_CPU_RESET + RAM_REG, 0);
-      wr32(REG_COPRO_PATCH_PTR + RAM_REG, Patch_Add);
-      HAL_Delay(250); // We already saw one error message and we don't need to see then 1000 times
-                      // a second
-    }
+      return CoPro_Recover();
+    if (EVE_Lost())
+      return COPRO_LOST;
   } while (ReadReg != rd16(REG_CMD_WRITE + RAM_REG));
+  return COPRO_OK;
+}
+
+// Sit and wait until the CoPro FIFO is empty
+// Detect operational errors, report them and get the coprocessor going again.
+void Wait4CoProFIFOEmpty(void)
+{
+  CoProFIFO_WaitEmpty();
 }
 
 // Every CoPro transaction starts with enabling the SPI and sending an address
 void StartCoProTransfer(uint32_t address, uint8_t reading)
 {
-  HAL_SPI_Enable();
+  SPI_Begin();
   if (reading)
   {
-    HAL_SPI_Write(address >> 16);
-    HAL_SPI_Write(address >> 8);
-    HAL_SPI_Write(address);
-    HAL_SPI_Write(0);
+    SPI_Write(address >> 16);
+    SPI_Write(address >> 8);
+    SPI_Write(address);
+    SPI_Write(0);
   }
   else
   {
-    HAL_SPI_Write((address >> 16) | 0x80);
-    HAL_SPI_Write(address >> 8);
-    HAL_SPI_Write(address);
+    SPI_Write((address >> 16) | 0x80);
+    SPI_Write(address >> 8);
+    SPI_Write(address);
   }
 }
 
+// And ends with disabling it again, which also lets other threads at the bus
+void EndCoProTransfer(void)
+{
+  SPI_End();
+}
+
 // *** CoProWrCmdBuf() - Transfer a buffer into the CoPro FIFO as part of an ongoing command
 // operation ***********
 void CoProWrCmdBuf(const uint8_t *buff, uint32_t count)
 {
   uint32_t TransferSize = 0;
+  uint32_t FirstPart;
+  uint32_t Room;
+  uint16_t ReadReg;
   int32_t Remaining = count; // Signed
 
+  if (EVE_GetContext()->BlockHook)
+    EVE_GetContext()->BlockHook(buff, count);
+
   do
   {
     // Here is the situation:  You have up to about a megabyte of data to transfer into the FIFO
@@ -1634,27 +2126,47 @@ void CoProWrCmdBuf(const uint8_t *buff, uint32_t count)
     // intermittently tell EVE to go process some FIFO in order to make room in the FIFO for more
     // RAM_G data.
 
-    Wait4CoProFIFO(
-        WorkBuffSz); // It is reasonable to wait for a small space instead of firing data piecemeal
-
-    if (Remaining > WorkBuffSz)  // Remaining data exceeds the size of our buffer
-      TransferSize = WorkBuffSz; // So set the transfer size to that of our buffer
+    // It is reasonable to wait for a small space instead of firing data piecemeal, but once there
+    // is room we fill all of it - each round trip costs far more than the bytes themselves.
+    do
+    {
+      if (EVE_Lost())
+        return; // The rest is lost with the bridge, EVE_Reconnect starts over
+      ReadReg = rd16(REG_CMD_READ + RAM_REG);
+      if (ReadReg == 0xFFF)
+        return; // The coprocessor faulted and takes no more, CoProFIFO_WaitEmpty recovers it
+      Room = (FT_CMD_FIFO_SIZE - 4) - ((FifoWriteLocation - ReadReg) % FT_CMD_FIFO_SIZE);
+    } while ((Room < WorkBuffSz) && (Room < (uint32_t)Remaining));
+
+    if ((uint32_t)Remaining > Room) // Remaining data exceeds the free space in the FIFO
+      TransferSize = Room;          // So set the transfer size to that space
     else
     {
-      TransferSize = Remaining;                  // Set size to this last dribble of data
-      TransferSize = (TransferSize + 3) & 0xFFC; // 4 byte alignment
+      TransferSize = Remaining;               // Set size to this last dribble of data
+      TransferSize = (TransferSize + 3) & ~3; // 4 byte alignment
     }
 
+    // The FIFO is a ring, so a transfer which runs over the end continues at the start of RAM_CMD
+    FirstPart = FT_CMD_FIFO_SIZE - FifoWriteLocation;
+    if (FirstPart > TransferSize)
+      FirstPart = TransferSize;
+
     StartCoProTransfer(FifoWriteLocation + RAM_CMD,
                        false); // Base address of the Command Buffer plus our offset into it -
                                // Start SPI transaction
+    SPI_WriteBuffer((uint8_t *)buff,
+                        FirstPart); // Write the little bit for which we found space
+    EndCoProTransfer();             // End SPI transaction with the FIFO
 
-    HAL_SPI_WriteBuffer((uint8_t *)buff,
-                        TransferSize); // Write the little bit for which we found space
-    buff += TransferSize;              // Move the working data read pointer to the next fresh data
+    if (TransferSize > FirstPart)
+    {
+      StartCoProTransfer(RAM_CMD, false);
+      SPI_WriteBuffer((uint8_t *)buff + FirstPart, TransferSize - FirstPart);
+      EndCoProTransfer();
+    }
+    buff += TransferSize; // Move the working data read pointer to the next fresh data
 
     FifoWriteLocation = (FifoWriteLocation + TransferSize) % FT_CMD_FIFO_SIZE;
-    HAL_SPI_Disable(); // End SPI transaction with the FIFO
 
     wr16(REG_CMD_WRITE + RAM_REG, FifoWriteLocation); // Manually update the write position pointer
                                                       // to initiate processing of the FIFO
@@ -1663,19 +2175,12 @@ void CoProWrCmdBuf(const uint8_t *buff, uint32_t count)
   } while (Remaining > 0); // Keep going as long as we still want more
 }
 
-// Write a block of data into EVE RAM space a byte at a time.
+// Write a block of data into EVE RAM space in bursts of BurstSz (see wrN).
 // Return the last written address + 1 (The next available RAM address)
 uint32_t WriteBlockRAM(uint32_t Add, const uint8_t *buff, uint32_t count)
 {
-  uint32_t index;
-  uint32_t WriteAddress =
-      Add; // I want to return the value instead of modifying the variable in place
-
-  for (index = 0; index < count; index++)
-  {
-    wr8(WriteAddress++, buff[index]);
-  }
-  return (WriteAddress);
+  wrN(Add, buff, count);
+  return (Add + count);
 }
 
 // CalcCoef - Support function for manual screen calibration function
@@ -1770,30 +2275,30 @@ void UploadTouchFirmware(const uint8_t *firmware, size_t length)
   wr8(REG_CPU_RESET + RAM_REG, 2);
   wr8(REG_GPIOX_DIR + RAM_REG, (rd8(RAM_REG + REG_GPIOX_DIR) | 0x08)); // Set Disp GPIO Direction
   wr8(REG_GPIOX + RAM_REG, (rd8(RAM_REG + REG_GPIOX) | 0xF7));         // Clear GPIO
-  HAL_Delay(1);
+  HAL_DelayUs(GOODIX_RESET_US);
   wr8(REG_CPU_RESET + RAM_REG, 0);
-  HAL_Delay(100);
+  HAL_DelayUs(GOODIX_BOOT_US);
   wr8(REG_GPIOX_DIR + RAM_REG, (rd8(RAM_REG + REG_GPIOX_DIR) & 0xF7)); // Set Disp GPIO Direction
 }
 
 #if defined(EVE_MO_INTERNAL_BUILD)
 void EVE_SPI_Enable(void)
 {
-  HAL_SPI_Enable();
+  SPI_Begin();
 }
 
 void EVE_SPI_Disable(void)
 {
-  HAL_SPI_Disable();
+  SPI_End();
 }
 
 uint8_t EVE_SPI_Write(uint8_t data)
 {
-  return HAL_SPI_Write(data);
+  return SPI_Write(data);
 }
 
 void EVE_SPI_WriteBuffer(uint8_t *Buffer, uint32_t Length)
 {
-  HAL_SPI_WriteBuffer(Buffer, Length);
+  SPI_WriteBuffer(Buffer, Length);
 }
 #endif
@@ -132,6 +132,7 @@ extern "C"
 #define OPT_MEDIAFIFO 16UL
 #define OPT_MONO 1UL
 #define OPT_NOBACK 4096UL
+#define OPT_FORMAT 4096UL // BT81x, CMD_TEXT, CMD_BUTTON and CMD_TOGGLE
 #define OPT_NODL 2UL
 #define OPT_NOHANDS 49152UL
 #define OPT_NOHM 16384UL
@@ -144,8 +145,8 @@ extern "C"
 #define OPT_SIGNED 256UL
 #define OPT_SOUND 32UL
 #define OPT_LEFTX 0UL
-#define VERTEX_TRANSLATE_X(x) ((43UL << 24) | ((x)&65535UL))
-#define VERTEX_TRANSLATE_Y(y) ((44UL << 24) | ((y)&65535UL))
+#define VERTEX_TRANSLATE_X(x) ((43UL << 24) | ((x)&131071UL))
+#define VERTEX_TRANSLATE_Y(y) ((44UL << 24) | ((y)&131071UL))
 
 #define ANIM_HOLD 2UL
 #define ANIM_LOOP 1UL
@@ -164,6 +165,7 @@ extern "C"
 #define RAM_REG 0x302000
 #define RAM_CMD 0x308000
 #define RAM_ERR_REPORT 0x309800 // Max 128 bytes null terminated string
+#define ROM_FONTROOT 0x2FFFFC   // Holds the address of the ROM font table
 #define RAM_FLASH 0x800000
 #define RAM_FLASH_POSTBLOB 0x801000
 
@@ -302,6 +304,16 @@ extern "C"
 #define REG_SPI_WIDTH 0x180
 #define REG_CHIP_ID 0xC0000 // Temporary Chip ID location in RAMG
 
+// Interrupt flags for REG_INT_FLAGS and REG_INT_MASK - FT81x Series Programmers Guide Section 3.6
+#define INT_SWAP 0x01
+#define INT_TOUCH 0x02
+#define INT_TAG 0x04
+#define INT_SOUND 0x08
+#define INT_PLAYBACK 0x10
+#define INT_CMDEMPTY 0x20
+#define INT_CMDFLAG 0x40
+#define INT_CONVCOMPLETE 0x80
+
 // Primitive Type Reference Definitions - FT81x Series Programmers Guide Section 4.5 - Table 6
 #define BITMAPS 1
 #define POINTS 2
@@ -387,6 +399,8 @@ extern "C"
    (((height)&511UL) << 0)) // BITMAP_LAYOUT - FT-PG Section 4.07
 #define BITMAP_LAYOUT2(linestride, height)                                                        \
   ((28UL << 24) | (((linestride >> 10) & 3) << 2) | ((height >> 9) & 3))
+#define BITMAP_SIZE2(width, height)                                                               \
+  ((41UL << 24) | ((((width) >> 9) & 3) << 2) | (((height) >> 9) & 3))
 #define BITMAP_SIZE(filter, wrapx, wrapy, width, height)                                          \
   ((8UL << 24) | (((filter)&1UL) << 20) | (((wrapx)&1UL) << 19) | (((wrapy)&1UL) << 18) |         \
    (((width)&511UL) << 9) | (((height)&511UL) << 0)) // BITMAP_SIZE - FT-PG Section 4.09
@@ -407,8 +421,100 @@ extern "C"
 // Non FTDI Helper Macros
 #define MAKE_COLOR(r, g, b) ((r << 16) | (g << 8) | (b))
 
+  // Panel timings for one display of displays.h, see EVE_Init
+  typedef struct
+  {
+    int Display;       // DISPLAY_* id
+    const char *Name;  // Name as used for the build directories, e.g. "43_480x272"
+    uint16_t Width;    // Visible area
+    uint16_t Height;
+    uint16_t PixHOffset; // Where the visible area starts within HSize / VSize
+    uint16_t PixVOffset;
+    uint16_t HCycle;
+    uint16_t HOffset;
+    uint16_t HSync0;
+    uint16_t HSync1;
+    uint16_t VCycle;
+    uint16_t VOffset;
+    uint16_t VSync0;
+    uint16_t VSync1;
+    uint8_t PClk;
+    uint8_t Swizzle;
+    uint8_t PClkPol;
+    uint8_t CSpread;
+    uint8_t Dither;
+    uint16_t HSize;
+    uint16_t VSize;
+  } Display_Timing;
+
+  // Microseconds from the start of EVE_Init, see EVE_GetStartup
+  typedef struct
+  {
+    uint32_t ResetUs;      // Bridge opened and PD_N toggled
+    uint32_t BootUs;       // REG_ID reads 0x7C
+    uint32_t EnginesUs;    // Coprocessor, touch and audio engines out of reset and idle
+    uint32_t FirstFrameUs; // Pixel clock on, the first frame is on its way to the display
+  } EVE_Startup;
+
+  // The bridge a context talks through.  Device is handed back to every call, so one
+  // implementation can serve several bridges.
+  typedef struct
+  {
+    void *Device;
+    void (*SPI_Enable)(void *device);
+    void (*SPI_Disable)(void *device);
+    uint8_t (*SPI_Write)(void *device, uint8_t data);
+    void (*SPI_WriteBuffer)(void *device, uint8_t *buffer, uint32_t length);
+    void (*SPI_ReadBuffer)(void *device, uint8_t *buffer, uint32_t length);
+    int (*Open)(void *device);  // As HAL_Eve_Open
+    int (*Reset)(void *device); // As HAL_Eve_Reset_HW
+    void (*Close)(void *device);
+    int (*Lost)(void *device); // As HAL_Eve_Lost, NULL for a bridge that can not tell
+  } EVE_Hal;
+
+  // The last coprocessor fault, see CoPro_Recover
+  typedef struct
+  {
+    uint32_t Faults;    // Since the context was set up
+    uint32_t RecoverUs; // Time the last recovery took, until the coprocessor ran again
+    char Report[128];   // RAM_ERR_REPORT, the message of the coprocessor
+  } EVE_Fault;
+
+  typedef struct
+  {
+    uint32_t Transactions; // SPI transactions, CS low to CS high
+    uint32_t BytesWritten; // Including the address bytes
+    uint32_t BytesRead;
+  } EVE_Stats;
+
+  // Everything eve.c knows about one EVE.  Each thread works on its current context, set with
+  // EVE_SetContext, and every function of the library acts on that one - so a process can drive
+  // several panels, each on its own bridge and thread.  Threads that never set one share the
+  // default context, which talks through the functions of hw_api.h as before.  The add-on modules
+  // (eve_events.h and the like) keep state of their own and serve one panel at a time.
+  typedef struct
+  {
+    uint16_t FifoWrite; // Offset of the next command in RAM_CMD, see FifoWriteLocation
+    uint32_t Width;
+    uint32_t Height;
+    uint32_t HOffset;
+    uint32_t VOffset;
+    uint8_t Touch;
+    int Display; // As given to EVE_Init, for EVE_Reconnect
+    int Board;
+    bool PanelAwake; // An ST7789V was taken out of sleep mode, see MO_ST7789V_init
+    EVE_Hal Hal;
+    void (*BusLock)(void); // See EVE_SetBusLock
+    void (*BusUnlock)(void);
+    void (*CmdHook)(uint32_t data); // See EVE_SetCmdHook
+    void (*BlockHook)(const uint8_t *buffer, uint32_t count);
+    EVE_Startup Startup;
+    EVE_Stats Stats;
+    EVE_Fault Fault;
+  } EVE_Context;
+
   // Global Variables
-  extern uint16_t FifoWriteLocation;
+#define FifoWriteLocation (EVE_GetContext()->FifoWrite)
 
   // Function Prototypes
 
@@ -416,9 +522,65 @@ extern "C"
   //    0 Hardware reset failed
   //    1 Hardware reset OK, but no EVE detected on the SPI bus
   // else the chipID of the EVE IC that was detected.
-  // The Display, board and touch defines can be found in displays.h
+  // The Display, board and touch defines can be found in displays.h.  With DISPLAY_AUTO,
+  // BOARD_AUTO or TOUCH_AUTO they are taken from the environment (EVE_DISPLAY, EVE_BOARD,
+  // EVE_TOUCH) or a config file (EVE_CONFIG, or eve.cfg) on hosted platforms; the board is
+  // detected from the chip ID otherwise and the touch defaults to TOUCH_TPN.
   int EVE_EXPORT EVE_Init(int display, int board, int touch);
 
+  // Attach to an EVE that is already running, e.g. after the host process restarted.  The
+  // registers EVE_Init sets are read back and compared with what it would set for display and
+  // touch; if they match and the coprocessor is idle, FifoWriteLocation is taken over and the
+  // chip is left as it is - no reset, no touch firmware upload, no blank screen.  Otherwise this
+  // falls back to EVE_Init.  Return values as EVE_Init, a warm attach returns 2 instead of the
+  // chip ID when the application has overwritten it in RAM_G since.
+  int EVE_EXPORT EVE_Attach(int display, int board, int touch);
+
+  // How long the phases of the last EVE_Init took
+  void EVE_EXPORT EVE_GetStartup(EVE_Startup *startup);
+
+  // Set up a context for another EVE, talking through hal - NULL for the functions of hw_api.h.
+  // Select it with EVE_SetContext before calling EVE_Init or EVE_Attach.
+  void EVE_EXPORT EVE_ContextInit(EVE_Context *context, const EVE_Hal *hal);
+  // The context of the calling thread, NULL goes back to the default one
+  void EVE_EXPORT EVE_SetContext(EVE_Context *context);
+  EVE_Context EVE_EXPORT *EVE_GetContext(void);
+  // SPI traffic of the current context
+  void EVE_EXPORT EVE_GetStats(EVE_Stats *stats);
+  // Close the bridge of the current context
+  void EVE_EXPORT EVE_Close(void);
+  // The last coprocessor fault of the current context
+  void EVE_EXPORT EVE_GetFault(EVE_Fault *fault);
+
+  // Whether the bridge of the current context stopped answering, see HAL_Eve_Lost.  The FIFO
+  // waits give up on a lost bridge instead of spinning.
+  bool EVE_EXPORT EVE_Lost(void);
+
+  // Open the bridge again and attach to EVE with EVE_Attach, as long as it takes up to timeoutUs.
+  // Returns 0 if that failed, RECONNECT_WARM if EVE kept running and RAM_G is as it was, or
+  // RECONNECT_COLD if it had to be initialized again.  Either way the commands of the frame in
+  // flight are gone, see Journal_Reconnect of eve_journal.h to bring the screen back as well.
+#define RECONNECT_WARM 1
+#define RECONNECT_COLD 2
+#define RECONNECT_RETRY_US 50000 // Between two attempts to open the bridge
+  int EVE_EXPORT EVE_Reconnect(uint32_t timeoutUs);
+
+  // Called around every SPI transaction, so threads sharing the bridge take turns one transaction
+  // at a time (see eve_bus.h).  NULL for both, the default, for a single thread.
+  void EVE_EXPORT EVE_SetBusLock(void (*lock)(void), void (*unlock)(void));
+
+  // Called with every word Send_CMD queues and every block CoProWrCmdBuf queues, e.g. for the
+  // journal of eve_journal.h.  A block may be commands (eve.hpp, eve_batch.h) or the data of the
+  // command before it (an upload).  NULL for both, the default, for none.
+  void EVE_EXPORT EVE_SetCmdHook(void (*word)(uint32_t data),
+                                 void (*block)(const uint8_t *buffer, uint32_t count));
+
+  // Timings of a display, NULL if there is no such display
+  const Display_Timing EVE_EXPORT *Display_Find(int display);
+  // Display, board or touch id from its name ("43_480x272", "EVE3", "TPC") or number, -1 if
+  // the name is not known
+  int EVE_EXPORT Display_Parse(const char *name);
+
   int EVE_EXPORT Eve_Reset(void);
   void EVE_EXPORT Cap_Touch_Upload(void);
 
@@ -430,6 +592,7 @@ extern "C"
   uint16_t EVE_EXPORT rd16(uint32_t RegAddr);
   uint32_t EVE_EXPORT rd32(uint32_t RegAddr);
   void EVE_EXPORT rdN(uint32_t address, uint8_t *buffer, uint32_t size);
+  void EVE_EXPORT wrN(uint32_t address, const uint8_t *buffer, uint32_t size);
   void EVE_EXPORT Send_CMD(uint32_t data);
   void EVE_EXPORT UpdateFIFO(void);
   uint8_t EVE_EXPORT Cmd_READ_REG_ID(void);
@@ -478,6 +641,20 @@ extern "C"
 
   void EVE_EXPORT Cmd_SetBitmap(uint32_t addr, uint16_t fmt, uint16_t width, uint16_t height);
   void EVE_EXPORT Cmd_Memcpy(uint32_t dest, uint32_t src, uint32_t num);
+  void EVE_EXPORT Cmd_Inflate(uint32_t ptr);
+  void EVE_EXPORT Cmd_Inflate2(uint32_t ptr, uint32_t options);
+  void EVE_EXPORT Cmd_MediaFifo(uint32_t ptr, uint32_t size);
+  void EVE_EXPORT Cmd_LoadImage(uint32_t ptr, uint32_t options);
+  void EVE_EXPORT Cmd_PlayVideo(uint32_t options);
+  void EVE_EXPORT Cmd_VideoStart(void);
+  void EVE_EXPORT Cmd_VideoFrame(uint32_t dst, uint32_t ptr);
+  void EVE_EXPORT Cmd_MemWrite(uint32_t ptr, uint32_t num);
+  void EVE_EXPORT Cmd_Append(uint32_t ptr, uint32_t num);
+  void EVE_EXPORT Cmd_MemCrc(uint32_t ptr, uint32_t num);
+  void EVE_EXPORT Cmd_FlashWrite(uint32_t ptr, uint32_t num);
+  void EVE_EXPORT Cmd_FlashRead(uint32_t dest, uint32_t src, uint32_t num);
+  void EVE_EXPORT Cmd_FlashUpdate(uint32_t dest, uint32_t src, uint32_t num);
+  void EVE_EXPORT Cmd_FlashSource(uint32_t ptr);
   void EVE_EXPORT Cmd_GetPtr(void);
   void EVE_EXPORT Cmd_GradientColor(uint32_t c);
   void EVE_EXPORT Cmd_FGcolor(uint32_t c);
@@ -499,11 +676,35 @@ extern "C"
                                    uint16_t Height,
                                    uint16_t V_Offset,
                                    uint16_t H_Offset);
+  void EVE_EXPORT Calibrate_Points(uint16_t Width,
+                                   uint16_t Height,
+                                   uint16_t V_Offset,
+                                   uint16_t H_Offset,
+                                   uint32_t *displayX,
+                                   uint32_t *displayY);
+  bool EVE_EXPORT Calibrate_Matrix(const uint32_t *displayX,
+                                   const uint32_t *displayY,
+                                   const uint32_t *touchX,
+                                   const uint32_t *touchY,
+                                   int32_t *TransMatrix);
   void EVE_EXPORT Cmd_SetFont2(uint32_t handle, uint32_t addr, uint32_t firstChar);
   uint16_t EVE_EXPORT CoProFIFO_FreeSpace(void);
   void EVE_EXPORT Wait4CoProFIFO(uint32_t room);
   void EVE_EXPORT Wait4CoProFIFOEmpty(void);
+  // Wait4CoProFIFOEmpty with the outcome: COPRO_OK once the coprocessor has caught up, else
+  // what CoPro_Recover made of the fault it ran into.  After COPRO_RECOVERED the FIFO is empty
+  // and the commands since the last wait are lost, so the caller can send the frame again.
+#define COPRO_OK 0
+#define COPRO_RECOVERED 1 // Faulted, reset and running again, see EVE_GetFault
+#define COPRO_STUCK 2     // Faulted and did not come back from the reset
+#define COPRO_LOST 3      // The bridge stopped answering, see EVE_Reconnect
+  int EVE_EXPORT CoProFIFO_WaitEmpty(void);
+  // Log the fault report, reset the coprocessor and start over with an empty FIFO.  A flash that
+  // was attached (and in full speed mode) is attached again.
+  int EVE_EXPORT CoPro_Recover(void);
+  bool EVE_EXPORT CoProFIFO_Passed(uint16_t location);
   void EVE_EXPORT StartCoProTransfer(uint32_t address, uint8_t reading);
+  void EVE_EXPORT EndCoProTransfer(void);
   void EVE_EXPORT CoProWrCmdBuf(const uint8_t *buffer, uint32_t count);
   uint32_t EVE_EXPORT WriteBlockRAM(uint32_t Add, const uint8_t *buff, uint32_t count);
   int32_t EVE_EXPORT CalcCoef(int32_t Q, int32_t K);
@@ -512,6 +713,9 @@ extern "C"
   uint8_t EVE_EXPORT Display_Touch();
   uint32_t EVE_EXPORT Display_HOffset();
   uint32_t EVE_EXPORT Display_VOffset();
+  // Whether EVE is a BT81x (BOARD_EVE3 and later), which has flash and the commands that came
+  // with it - CMD_INFLATE2, CMD_SETBITMAP, CMD_FLASH*, ...
+  bool EVE_EXPORT EVE_IsBT81x(void);
 
   /* Flash commands */
   bool EVE_EXPORT FlashAttach(void);
@@ -0,0 +1,953 @@
+#ifndef __EVE_HPP
+#define __EVE_HPP
+
+// C++17 front end for display lists and coprocessor commands
+//
+// The macros of eve.h (VERTEX2F, COLOR_RGB, BITMAP_LAYOUT, ...) take any value and quietly mask
+// it to the width of the field, and a static screen is still put together word by word through
+// Send_CMD at runtime.  Here every display list instruction (eve::dl) and coprocessor command
+// (eve::cmd) is a typed constexpr function instead.  Put together with eve::Sequence, a screen
+// that is fully known at compile time folds into a constexpr std::array, which eve::Send hands
+// to the coprocessor as a single burst:
+//
+//   static constexpr auto Splash = eve::Blob(eve::Sequence(
+//       eve::cmd::DlStart(),
+//       eve::dl::ClearColorRGB(0, 0, 64),
+//       eve::dl::Clear(true, true, true),
+//       eve::cmd::Text(240, 136, 31, OPT_CENTER, "Hello"),
+//       eve::dl::Display(),
+//       eve::cmd::Swap()));
+//
+//   eve::Send(Splash);
+//
+// An argument out of range for its field is a compile error wherever the encoder is evaluated at
+// compile time - in the example a VERTEX2II at x = 600 does not build.  The encoders call
+// OutOfRange() for such an argument, which is not constexpr and so ends constant evaluation.  At
+// runtime the same encoders mask the argument like the macros do.
+//
+// Words are sent through CoProWrCmdBuf, not Send_CMD; the journal of eve_journal.h sees them
+// through the block hook of EVE_SetCmdHook.
+
+#include "eve.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace eve
+{
+  using Word = uint32_t;
+
+  template <size_t N> using Words = std::array<Word, N>;
+
+  // An argument did not fit its field, see the top of this file
+  inline void OutOfRange(const char *what)
+  {
+    (void)what;
+  }
+
+  namespace detail
+  {
+    // An unsigned field of bits bits
+    constexpr Word Field(uint32_t value, unsigned bits, const char *what)
+    {
+      if (value >> bits)
+        OutOfRange(what);
+      return value & ((1UL << bits) - 1);
+    }
+
+    // A two's complement field of bits bits
+    constexpr Word Signed(int32_t value, unsigned bits, const char *what)
+    {
+      if ((value < -(1L << (bits - 1))) || (value >= (1L << (bits - 1))))
+        OutOfRange(what);
+      return (Word)value & ((1UL << bits) - 1);
+    }
+
+    constexpr Word Op(uint32_t opcode)
+    {
+      return (Word)opcode << 24;
+    }
+
+    // Two 16 bit arguments of a coprocessor command, the first one in the low half
+    constexpr Word Pair(int32_t low, int32_t high)
+    {
+      return ((Word)(uint16_t)high << 16) | (uint16_t)low;
+    }
+
+    template <typename T> struct Count
+    {
+      static_assert(std::is_integral_v<T>, "Sequence takes words and std::array<uint32_t, N>");
+      static constexpr size_t Value = 1;
+    };
+
+    template <size_t N> struct Count<Words<N>>
+    {
+      static constexpr size_t Value = N;
+    };
+
+    template <size_t N, typename T> constexpr void Append(Words<N> &out, size_t &at, T word)
+    {
+      out[at++] = (Word)word;
+    }
+
+    template <size_t N, size_t M>
+    constexpr void Append(Words<N> &out, size_t &at, const Words<M> &part)
+    {
+      for (size_t i = 0; i < M; i++)
+        out[at++] = part[i];
+    }
+  }
+
+  // Words and arrays of words, one after the other
+  template <typename... Parts> constexpr auto Sequence(const Parts &...parts)
+  {
+    Words<(detail::Count<Parts>::Value + ... + 0)> Out{};
+    size_t At = 0;
+
+    (detail::Append(Out, At, parts), ...);
+    return Out;
+  }
+
+  // A string for the coprocessor, zero terminated and padded to whole words
+  template <size_t N> constexpr Words<(N + 3) / 4> String(const char (&s)[N])
+  {
+    Words<(N + 3) / 4> Out{};
+
+    if (s[N - 1])
+      OutOfRange("String: not zero terminated");
+    for (size_t i = 0; i < N; i++)
+      Out[i / 4] |= (Word)(uint8_t)s[i] << ((i % 4) * 8);
+    return Out;
+  }
+
+  // The words as EVE takes them, little endian whatever the host is
+  template <size_t N> constexpr std::array<uint8_t, N * 4> Blob(const Words<N> &words)
+  {
+    std::array<uint8_t, N * 4> Out{};
+
+    for (size_t i = 0; i < N * 4; i++)
+      Out[i] = (uint8_t)(words[i / 4] >> ((i % 4) * 8));
+    return Out;
+  }
+
+  // Queue a blob in the coprocessor FIFO as one burst and start it
+  template <size_t N> inline void Send(const std::array<uint8_t, N> &blob)
+  {
+    static_assert(N % 4 == 0, "Send: the coprocessor takes whole words");
+    CoProWrCmdBuf(blob.data(), N);
+  }
+
+  template <size_t N> inline void Send(const Words<N> &words)
+  {
+    Send(Blob(words));
+  }
+
+  // Write a display list made of eve::dl only straight into RAM_DL and swap it in, without the
+  // coprocessor.  It must not be building a display list at the same time.
+  template <size_t N> inline void WriteDL(const std::array<uint8_t, N> &blob)
+  {
+    static_assert(N <= FT_DL_SIZE, "WriteDL: more than RAM_DL holds");
+    wrN(RAM_DL, blob.data(), N);
+    wr8(REG_DLSWAP + RAM_REG, DLSWAP_FRAME);
+  }
+
+  template <size_t N> inline void WriteDL(const Words<N> &words)
+  {
+    WriteDL(Blob(words));
+  }
+
+  // Display list instructions, FT81x / BT81x Series Programmers Guide chapter 4
+  namespace dl
+  {
+    enum class Primitive : uint8_t
+    {
+      Bitmaps = BITMAPS,
+      Points = POINTS,
+      Lines = LINES,
+      LineStrip = LINE_STRIP,
+      EdgeStripR = EDGE_STRIP_R,
+      EdgeStripL = EDGE_STRIP_L,
+      EdgeStripA = EDGE_STRIP_A,
+      EdgeStripB = EDGE_STRIP_B,
+      Rects = RECTS
+    };
+
+    enum class Test : uint8_t // ALPHA_FUNC and STENCIL_FUNC
+    {
+      Never,
+      Less,
+      LEqual,
+      Greater,
+      GEqual,
+      Equal,
+      NotEqual,
+      Always
+    };
+
+    enum class Blend : uint8_t
+    {
+      Zero,
+      One,
+      SrcAlpha,
+      DstAlpha,
+      OneMinusSrcAlpha,
+      OneMinusDstAlpha
+    };
+
+    enum class StencilAction : uint8_t
+    {
+      Zero,
+      Keep,
+      Replace,
+      Incr,
+      Decr,
+      Invert
+    };
+
+    enum class Filter : uint8_t
+    {
+      Nearest = NEAREST,
+      Bilinear = BILINEAR
+    };
+
+    enum class Wrap : uint8_t
+    {
+      Border = BORDER,
+      Repeat = REPEAT
+    };
+
+    constexpr Word AlphaFunc(Test func, uint8_t ref)
+    {
+      return detail::Op(0x09) | ((Word)func << 8) | ref;
+    }
+
+    constexpr Word Begin(Primitive prim)
+    {
+      return detail::Op(0x1F) | (Word)prim;
+    }
+
+    constexpr Word BitmapExtFormat(uint16_t format)
+    {
+      return detail::Op(0x2E) | format;
+    }
+
+    constexpr Word BitmapHandle(uint32_t handle)
+    {
+      return detail::Op(0x05) | detail::Field(handle, 5, "BitmapHandle: handle");
+    }
+
+    constexpr Word BitmapLayout(uint32_t format, uint32_t linestride, uint32_t height)
+    {
+      return detail::Op(0x07) | (detail::Field(format, 5, "BitmapLayout: format") << 19) |
+             (detail::Field(linestride, 10, "BitmapLayout: linestride, see BitmapLayoutH") << 9) |
+             detail::Field(height, 9, "BitmapLayout: height, see BitmapLayoutH");
+    }
+
+    // The high bits of linestride and height, for bitmaps beyond BitmapLayout
+    constexpr Word BitmapLayoutH(uint32_t linestride, uint32_t height)
+    {
+      return detail::Op(0x28) |
+             (detail::Field(linestride >> 10, 2, "BitmapLayoutH: linestride") << 2) |
+             detail::Field(height >> 9, 2, "BitmapLayoutH: height");
+    }
+
+    constexpr Word
+    BitmapSize(Filter filter, Wrap wrapx, Wrap wrapy, uint32_t width, uint32_t height)
+    {
+      return detail::Op(0x08) | ((Word)filter << 20) | ((Word)wrapx << 19) | ((Word)wrapy << 18) |
+             (detail::Field(width, 9, "BitmapSize: width, see BitmapSizeH") << 9) |
+             detail::Field(height, 9, "BitmapSize: height, see BitmapSizeH");
+    }
+
+    // The high bits of width and height, for bitmaps beyond BitmapSize
+    constexpr Word BitmapSizeH(uint32_t width, uint32_t height)
+    {
+      return detail::Op(0x29) | (detail::Field(width >> 9, 2, "BitmapSizeH: width") << 2) |
+             detail::Field(height >> 9, 2, "BitmapSizeH: height");
+    }
+
+    // Bit 23 selects the flash on BT81x
+    constexpr Word BitmapSource(uint32_t addr)
+    {
+      return detail::Op(0x01) | detail::Field(addr, 24, "BitmapSource: address");
+    }
+
+    constexpr Word BitmapSwizzle(uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+    {
+      return detail::Op(0x2F) | (detail::Field(r, 3, "BitmapSwizzle: r") << 9) |
+             (detail::Field(g, 3, "BitmapSwizzle: g") << 6) |
+             (detail::Field(b, 3, "BitmapSwizzle: b") << 3) |
+             detail::Field(a, 3, "BitmapSwizzle: a");
+    }
+
+    // A, B, D and E in 8.8 fixed point, C and F in 15.8
+    constexpr Word BitmapTransformA(int32_t a)
+    {
+      return detail::Op(0x15) | detail::Signed(a, 17, "BitmapTransformA");
+    }
+
+    constexpr Word BitmapTransformB(int32_t b)
+    {
+      return detail::Op(0x16) | detail::Signed(b, 17, "BitmapTransformB");
+    }
+
+    constexpr Word BitmapTransformC(int32_t c)
+    {
+      return detail::Op(0x17) | detail::Signed(c, 24, "BitmapTransformC");
+    }
+
+    constexpr Word BitmapTransformD(int32_t d)
+    {
+      return detail::Op(0x18) | detail::Signed(d, 17, "BitmapTransformD");
+    }
+
+    constexpr Word BitmapTransformE(int32_t e)
+    {
+      return detail::Op(0x19) | detail::Signed(e, 17, "BitmapTransformE");
+    }
+
+    constexpr Word BitmapTransformF(int32_t f)
+    {
+      return detail::Op(0x1A) | detail::Signed(f, 24, "BitmapTransformF");
+    }
+
+    constexpr Word BlendFunc(Blend src, Blend dst)
+    {
+      return detail::Op(0x0B) | ((Word)src << 3) | (Word)dst;
+    }
+
+    constexpr Word Call(uint32_t dest)
+    {
+      return detail::Op(0x1D) | detail::Field(dest, 16, "Call: destination");
+    }
+
+    constexpr Word Cell(uint32_t cell)
+    {
+      return detail::Op(0x06) | detail::Field(cell, 7, "Cell: cell");
+    }
+
+    constexpr Word Clear(bool color, bool stencil, bool tag)
+    {
+      return detail::Op(0x26) | ((Word)color << 2) | ((Word)stencil << 1) | (Word)tag;
+    }
+
+    constexpr Word ClearColorA(uint8_t alpha)
+    {
+      return detail::Op(0x0F) | alpha;
+    }
+
+    constexpr Word ClearColorRGB(uint8_t red, uint8_t green, uint8_t blue)
+    {
+      return detail::Op(0x02) | ((Word)red << 16) | ((Word)green << 8) | blue;
+    }
+
+    constexpr Word ClearStencil(uint8_t s)
+    {
+      return detail::Op(0x11) | s;
+    }
+
+    constexpr Word ClearTag(uint8_t t)
+    {
+      return detail::Op(0x12) | t;
+    }
+
+    constexpr Word ColorA(uint8_t alpha)
+    {
+      return detail::Op(0x10) | alpha;
+    }
+
+    constexpr Word ColorMask(bool r, bool g, bool b, bool a)
+    {
+      return detail::Op(0x20) | ((Word)r << 3) | ((Word)g << 2) | ((Word)b << 1) | (Word)a;
+    }
+
+    constexpr Word ColorRGB(uint8_t red, uint8_t green, uint8_t blue)
+    {
+      return detail::Op(0x04) | ((Word)red << 16) | ((Word)green << 8) | blue;
+    }
+
+    constexpr Word Display()
+    {
+      return detail::Op(0x00);
+    }
+
+    constexpr Word End()
+    {
+      return detail::Op(0x21);
+    }
+
+    constexpr Word Jump(uint32_t dest)
+    {
+      return detail::Op(0x1E) | detail::Field(dest, 16, "Jump: destination");
+    }
+
+    // In 1/16 pixel
+    constexpr Word LineWidth(uint32_t width)
+    {
+      return detail::Op(0x0E) | detail::Field(width, 12, "LineWidth: width");
+    }
+
+    constexpr Word Macro(uint32_t m)
+    {
+      return detail::Op(0x25) | detail::Field(m, 1, "Macro: register");
+    }
+
+    constexpr Word Nop()
+    {
+      return detail::Op(0x2D);
+    }
+
+    constexpr Word PaletteSource(uint32_t addr)
+    {
+      return detail::Op(0x2A) | detail::Field(addr, 22, "PaletteSource: address");
+    }
+
+    // In 1/16 pixel
+    constexpr Word PointSize(uint32_t size)
+    {
+      return detail::Op(0x0D) | detail::Field(size, 13, "PointSize: size");
+    }
+
+    constexpr Word RestoreContext()
+    {
+      return detail::Op(0x23);
+    }
+
+    constexpr Word Return()
+    {
+      return detail::Op(0x24);
+    }
+
+    constexpr Word SaveContext()
+    {
+      return detail::Op(0x22);
+    }
+
+    constexpr Word ScissorSize(uint32_t width, uint32_t height)
+    {
+      return detail::Op(0x1C) | (detail::Field(width, 12, "ScissorSize: width") << 12) |
+             detail::Field(height, 12, "ScissorSize: height");
+    }
+
+    constexpr Word ScissorXY(uint32_t x, uint32_t y)
+    {
+      return detail::Op(0x1B) | (detail::Field(x, 11, "ScissorXY: x") << 11) |
+             detail::Field(y, 11, "ScissorXY: y");
+    }
+
+    constexpr Word StencilFunc(Test func, uint8_t ref, uint8_t mask)
+    {
+      return detail::Op(0x0A) | ((Word)func << 16) | ((Word)ref << 8) | mask;
+    }
+
+    constexpr Word StencilMask(uint8_t mask)
+    {
+      return detail::Op(0x13) | mask;
+    }
+
+    constexpr Word StencilOp(StencilAction sfail, StencilAction spass)
+    {
+      return detail::Op(0x0C) | ((Word)sfail << 3) | (Word)spass;
+    }
+
+    constexpr Word Tag(uint8_t s)
+    {
+      return detail::Op(0x03) | s;
+    }
+
+    constexpr Word TagMask(bool mask)
+    {
+      return detail::Op(0x14) | (Word)mask;
+    }
+
+    // x and y in the units of VertexFormat, 1/16 pixel by default
+    constexpr Word Vertex2F(int32_t x, int32_t y)
+    {
+      return (1UL << 30) | (detail::Signed(x, 15, "Vertex2F: x") << 15) |
+             detail::Signed(y, 15, "Vertex2F: y");
+    }
+
+    // Whole pixels from 0 to 511, see Vertex2F for the rest of the screen
+    constexpr Word Vertex2II(uint32_t x, uint32_t y, uint32_t handle = 0, uint32_t cell = 0)
+    {
+      return (2UL << 30) | (detail::Field(x, 9, "Vertex2II: x") << 21) |
+             (detail::Field(y, 9, "Vertex2II: y") << 12) |
+             (detail::Field(handle, 5, "Vertex2II: handle") << 7) |
+             detail::Field(cell, 7, "Vertex2II: cell");
+    }
+
+    // Fraction bits of Vertex2F, 0 to 4
+    constexpr Word VertexFormat(uint32_t frac)
+    {
+      if (frac > 4)
+        OutOfRange("VertexFormat: frac");
+      return detail::Op(0x27) | (frac & 7);
+    }
+
+    // In 1/16 pixel
+    constexpr Word VertexTranslateX(int32_t x)
+    {
+      return detail::Op(0x2B) | detail::Signed(x, 17, "VertexTranslateX: x");
+    }
+
+    constexpr Word VertexTranslateY(int32_t y)
+    {
+      return detail::Op(0x2C) | detail::Signed(y, 17, "VertexTranslateY: y");
+    }
+  }
+
+  // Coprocessor commands, as the Cmd_ functions of eve.h send them.  Commands that return a value
+  // have a placeholder word for it; commands followed by data (CMD_INFLATE, CMD_MEMWRITE, ...)
+  // only get their header here.  CMD_CRC of eve.h is the opcode of CMD_MEMCRC under an older
+  // name, see MemCrc.
+  namespace cmd
+  {
+    using detail::Pair;
+
+    constexpr Words<1> DlStart()
+    {
+      return {CMD_DLSTART};
+    }
+
+    constexpr Words<1> Swap()
+    {
+      return {CMD_SWAP};
+    }
+
+    constexpr Words<1> ColdStart()
+    {
+      return {CMD_COLDSTART};
+    }
+
+    constexpr Words<2> Interrupt(uint32_t ms)
+    {
+      return {CMD_INTERRUPT, ms};
+    }
+
+    constexpr Words<1> LoadIdentity()
+    {
+      return {CMD_LOADIDENTITY};
+    }
+
+    constexpr Words<1> SetMatrix()
+    {
+      return {CMD_SETMATRIX};
+    }
+
+    constexpr Words<1> Stop()
+    {
+      return {CMD_STOP};
+    }
+
+    constexpr Words<1> Screensaver()
+    {
+      return {CMD_SCREENSAVER};
+    }
+
+    constexpr Words<1> Logo()
+    {
+      return {CMD_LOGO};
+    }
+
+    constexpr Words<1> VideoStart()
+    {
+      return {CMD_VIDEOSTART};
+    }
+
+    // BT817 / BT818, video from flash
+    constexpr Words<1> VideoStartF()
+    {
+      return {CMD_VIDEOSTARTF};
+    }
+
+    constexpr Words<1> ClearCache()
+    {
+      return {CMD_CLEARCACHE};
+    }
+
+    constexpr Words<1> FlashAttach()
+    {
+      return {CMD_FLASHATTACH};
+    }
+
+    constexpr Words<1> FlashDetach()
+    {
+      return {CMD_FLASHDETACH};
+    }
+
+    constexpr Words<1> FlashErase()
+    {
+      return {CMD_FLASHERASE};
+    }
+
+    constexpr Words<2> FlashFast()
+    {
+      return {CMD_FLASHFAST, 0};
+    }
+
+    constexpr Words<2> GetPtr()
+    {
+      return {CMD_GETPTR, 0};
+    }
+
+    constexpr Words<4> GetProps()
+    {
+      return {CMD_GETPROPS, 0, 0, 0};
+    }
+
+    constexpr Words<7> GetMatrix()
+    {
+      return {CMD_GETMATRIX, 0, 0, 0, 0, 0, 0};
+    }
+
+    constexpr Words<3> RegRead(uint32_t ptr)
+    {
+      return {CMD_REGREAD, ptr, 0};
+    }
+
+    constexpr Words<4> MemCrc(uint32_t ptr, uint32_t num)
+    {
+      return {CMD_MEMCRC, ptr, num, 0};
+    }
+
+    constexpr Words<2> Calibrate()
+    {
+      return {CMD_CALIBRATE, 0};
+    }
+
+    constexpr Words<3> Append(uint32_t ptr, uint32_t num)
+    {
+      return {CMD_APPEND, ptr, num};
+    }
+
+    constexpr Words<2> BgColor(uint32_t rgb)
+    {
+      return {CMD_BGCOLOR, rgb & 0xFFFFFF};
+    }
+
+    constexpr Words<2> FgColor(uint32_t rgb)
+    {
+      return {CMD_FGCOLOR, rgb & 0xFFFFFF};
+    }
+
+    constexpr Words<2> GradColor(uint32_t rgb)
+    {
+      return {CMD_GRADCOLOR, rgb & 0xFFFFFF};
+    }
+
+    constexpr Words<5> Gradient(
+        int16_t x0, int16_t y0, uint32_t rgb0, int16_t x1, int16_t y1, uint32_t rgb1)
+    {
+      return {CMD_GRADIENT, Pair(x0, y0), rgb0 & 0xFFFFFF, Pair(x1, y1), rgb1 & 0xFFFFFF};
+    }
+
+    template <size_t N>
+    constexpr auto Button(int16_t x,
+                          int16_t y,
+                          int16_t w,
+                          int16_t h,
+                          int16_t font,
+                          uint16_t options,
+                          const char (&s)[N])
+    {
+      return Sequence(CMD_BUTTON, Pair(x, y), Pair(w, h), Pair(font, options), String(s));
+    }
+
+    template <size_t N>
+    constexpr auto Keys(int16_t x,
+                        int16_t y,
+                        int16_t w,
+                        int16_t h,
+                        int16_t font,
+                        uint16_t options,
+                        const char (&s)[N])
+    {
+      return Sequence(CMD_KEYS, Pair(x, y), Pair(w, h), Pair(font, options), String(s));
+    }
+
+    template <size_t N>
+    constexpr auto Text(int16_t x, int16_t y, int16_t font, uint16_t options, const char (&s)[N])
+    {
+      return Sequence(CMD_TEXT, Pair(x, y), Pair(font, options), String(s));
+    }
+
+    // s holds the labels for off and on, separated by \xff
+    template <size_t N>
+    constexpr auto Toggle(int16_t x,
+                          int16_t y,
+                          int16_t w,
+                          int16_t font,
+                          uint16_t options,
+                          uint16_t state,
+                          const char (&s)[N])
+    {
+      return Sequence(CMD_TOGGLE, Pair(x, y), Pair(w, font), Pair(options, state), String(s));
+    }
+
+    constexpr Words<5> Clock(int16_t x,
+                             int16_t y,
+                             int16_t r,
+                             uint16_t options,
+                             uint16_t h,
+                             uint16_t m,
+                             uint16_t s,
+                             uint16_t ms)
+    {
+      return {CMD_CLOCK, Pair(x, y), Pair(r, options), Pair(h, m), Pair(s, ms)};
+    }
+
+    constexpr Words<4> Dial(int16_t x, int16_t y, int16_t r, uint16_t options, uint16_t val)
+    {
+      return {CMD_DIAL, Pair(x, y), Pair(r, options), val};
+    }
+
+    constexpr Words<5> Gauge(int16_t x,
+                             int16_t y,
+                             int16_t r,
+                             uint16_t options,
+                             uint16_t major,
+                             uint16_t minor,
+                             uint16_t val,
+                             uint16_t range)
+    {
+      if ((major < 1) || (major > 10))
+        OutOfRange("Gauge: major");
+      if ((minor < 1) || (minor > 10))
+        OutOfRange("Gauge: minor");
+      if (val > range)
+        OutOfRange("Gauge: val");
+      return {CMD_GAUGE, Pair(x, y), Pair(r, options), Pair(major, minor), Pair(val, range)};
+    }
+
+    constexpr Words<4> Number(int16_t x, int16_t y, int16_t font, uint16_t options, int32_t n)
+    {
+      return {CMD_NUMBER, Pair(x, y), Pair(font, options), (Word)n};
+    }
+
+    constexpr Words<5> Progress(
+        int16_t x, int16_t y, int16_t w, int16_t h, uint16_t options, uint16_t val, uint16_t range)
+    {
+      if (val > range)
+        OutOfRange("Progress: val");
+      return {CMD_PROGRESS, Pair(x, y), Pair(w, h), Pair(options, val), range};
+    }
+
+    constexpr Words<5> Scrollbar(int16_t x,
+                                 int16_t y,
+                                 int16_t w,
+                                 int16_t h,
+                                 uint16_t options,
+                                 uint16_t val,
+                                 uint16_t size,
+                                 uint16_t range)
+    {
+      return {CMD_SCROLLBAR, Pair(x, y), Pair(w, h), Pair(options, val), Pair(size, range)};
+    }
+
+    constexpr Words<5> Slider(
+        int16_t x, int16_t y, int16_t w, int16_t h, uint16_t options, uint16_t val, uint16_t range)
+    {
+      if (val > range)
+        OutOfRange("Slider: val");
+      return {CMD_SLIDER, Pair(x, y), Pair(w, h), Pair(options, val), range};
+    }
+
+    constexpr Words<3> Spinner(int16_t x, int16_t y, uint16_t style, uint16_t scale)
+    {
+      if (style > 3)
+        OutOfRange("Spinner: style");
+      return {CMD_SPINNER, Pair(x, y), Pair(style, scale)};
+    }
+
+    constexpr Words<4> Track(int16_t x, int16_t y, int16_t w, int16_t h, uint8_t tag)
+    {
+      return {CMD_TRACK, Pair(x, y), Pair(w, h), tag};
+    }
+
+    constexpr Words<5> Sketch(
+        int16_t x, int16_t y, uint16_t w, uint16_t h, uint32_t ptr, uint16_t format)
+    {
+      return {CMD_SKETCH, Pair(x, y), Pair(w, h), ptr, format};
+    }
+
+    // 16.16 fixed point
+    constexpr Words<3> Translate(int32_t tx, int32_t ty)
+    {
+      return {CMD_TRANSLATE, (Word)tx, (Word)ty};
+    }
+
+    constexpr Words<3> Scale(int32_t sx, int32_t sy)
+    {
+      return {CMD_SCALE, (Word)sx, (Word)sy};
+    }
+
+    // In units of 1/65536 of a circle
+    constexpr Words<2> Rotate(int32_t a)
+    {
+      return {CMD_ROTATE, (Word)a};
+    }
+
+    constexpr Words<2> SetRotate(uint32_t rotation)
+    {
+      if (rotation > 7)
+        OutOfRange("SetRotate: rotation");
+      return {CMD_SETROTATE, rotation};
+    }
+
+    constexpr Words<3> SetFont(uint32_t font, uint32_t ptr)
+    {
+      return {CMD_SETFONT, detail::Field(font, 5, "SetFont: font"), ptr};
+    }
+
+    constexpr Words<4> SetFont2(uint32_t font, uint32_t ptr, uint32_t firstChar)
+    {
+      return {CMD_SETFONT2, detail::Field(font, 5, "SetFont2: font"), ptr, firstChar};
+    }
+
+    constexpr Words<3> RomFont(uint32_t font, uint32_t romSlot)
+    {
+      if ((romSlot < 16) || (romSlot > 34))
+        OutOfRange("RomFont: romSlot");
+      return {CMD_ROMFONT, detail::Field(font, 5, "RomFont: font"), romSlot};
+    }
+
+    constexpr Words<4> SetBitmap(uint32_t addr, uint16_t format, uint16_t width, uint16_t height)
+    {
+      return {CMD_SETBITMAP, addr, Pair(format, width), height};
+    }
+
+    constexpr Words<4> Memcpy(uint32_t dest, uint32_t src, uint32_t num)
+    {
+      return {CMD_MEMCPY, dest, src, num};
+    }
+
+    constexpr Words<4> Memset(uint32_t ptr, uint8_t value, uint32_t num)
+    {
+      return {CMD_MEMSET, ptr, value, num};
+    }
+
+    constexpr Words<3> Memzero(uint32_t ptr, uint32_t num)
+    {
+      return {CMD_MEMZERO, ptr, num};
+    }
+
+    constexpr Words<3> MemWrite(uint32_t ptr, uint32_t num)
+    {
+      return {CMD_MEMWRITE, ptr, num};
+    }
+
+    constexpr Words<2> Inflate(uint32_t ptr)
+    {
+      return {CMD_INFLATE, ptr};
+    }
+
+    constexpr Words<3> Inflate2(uint32_t ptr, uint32_t options)
+    {
+      return {CMD_INFLATE2, ptr, options};
+    }
+
+    constexpr Words<3> LoadImage(uint32_t ptr, uint32_t options)
+    {
+      return {CMD_LOADIMAGE, ptr, options};
+    }
+
+    constexpr Words<3> MediaFifo(uint32_t ptr, uint32_t size)
+    {
+      return {CMD_MEDIAFIFO, ptr, size};
+    }
+
+    constexpr Words<2> PlayVideo(uint32_t options)
+    {
+      return {CMD_PLAYVIDEO, options};
+    }
+
+    constexpr Words<3> VideoFrame(uint32_t dst, uint32_t ptr)
+    {
+      return {CMD_VIDEOFRAME, dst, ptr};
+    }
+
+    constexpr Words<2> Snapshot(uint32_t ptr)
+    {
+      return {CMD_SNAPSHOT, ptr};
+    }
+
+    constexpr Words<4> FlashRead(uint32_t dest, uint32_t src, uint32_t num)
+    {
+      if ((src % 64) || (dest % 4) || (num % 4))
+        OutOfRange("FlashRead: alignment");
+      return {CMD_FLASHREAD, dest, src, num};
+    }
+
+    constexpr Words<4> FlashUpdate(uint32_t dest, uint32_t src, uint32_t num)
+    {
+      if ((dest % 4096) || (num % 4096))
+        OutOfRange("FlashUpdate: alignment");
+      return {CMD_FLASHUPDATE, dest, src, num};
+    }
+
+    constexpr Words<3> FlashWrite(uint32_t ptr, uint32_t num)
+    {
+      return {CMD_FLASHWRITE, ptr, num};
+    }
+
+    // BT81x, the flash driven over SPI directly (CMD_FLASHSPIDESEL/TX/RX).  The data
+    // of FlashSpiTx follows the command.
+    constexpr Words<1> FlashSpiDesel()
+    {
+      return {CMD_FLASHSPIDESEL};
+    }
+
+    constexpr Words<2> FlashSpiTx(uint32_t num)
+    {
+      return {CMD_FLASHSPITX, num};
+    }
+
+    constexpr Words<3> FlashSpiRx(uint32_t ptr, uint32_t num)
+    {
+      return {CMD_FLASHSPIRX, ptr, num};
+    }
+
+    // CMD_APPENDF, append display list commands from flash
+    constexpr Words<3> FlashAppendF(uint32_t ptr, uint32_t num)
+    {
+      if ((ptr % 64) || (num % 4))
+        OutOfRange("FlashAppendF: alignment");
+      return {CMD_FLASHAPPENDF, ptr, num};
+    }
+
+    constexpr Words<2> FlashSource(uint32_t ptr)
+    {
+      if (ptr % 64)
+        OutOfRange("FlashSource: alignment");
+      return {CMD_FLASHSOURCE, ptr};
+    }
+
+    constexpr Words<4> AnimStart(int32_t ch, uint32_t aoptr, uint32_t loop)
+    {
+      return {CMD_ANIMSTART, (Word)ch, aoptr, loop};
+    }
+
+    constexpr Words<2> AnimStop(int32_t ch)
+    {
+      return {CMD_ANIMSTOP, (Word)ch};
+    }
+
+    constexpr Words<3> AnimXY(int32_t ch, int16_t x, int16_t y)
+    {
+      return {CMD_ANIMXY, (Word)ch, Pair(x, y)};
+    }
+
+    constexpr Words<2> AnimDraw(int32_t ch)
+    {
+      return {CMD_ANIMDRAW, (Word)ch};
+    }
+
+    constexpr Words<4> AnimFrame(int16_t x, int16_t y, uint32_t aoptr, uint32_t frame)
+    {
+      return {CMD_ANIMFRAME, Pair(x, y), aoptr, frame};
+    }
+  }
+}
+
+#endif
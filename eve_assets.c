@@ -0,0 +1,310 @@
+// Flash asset manager - see eve_assets.h
+
+#include "eve_assets.h"
+#include "eve.h"
+#include "hw_api.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define Log printf
+
+#define ASSETS_MAX_RESIDENT 64 // Assets staged in RAM_G at the same time
+#define XFONT_GRAPHIC_DATA 32  // Offset of start_of_graphic_data in an xfont header
+
+typedef struct
+{
+  uint32_t Asset;    // Index into the manifest
+  uint32_t Address;  // Location in RAM_G
+  uint32_t Size;
+  uint32_t LastUse;  // Frame it was last used in
+} Assets_Block;
+
+typedef struct
+{
+  Asset_Entry *Entries;
+  uint32_t Count;
+  uint32_t PoolAddress;
+  uint32_t PoolSize;
+  Assets_Block Resident[ASSETS_MAX_RESIDENT]; // Sorted by address
+  uint32_t ResidentCount;
+  uint32_t Frame;
+} Assets_State;
+
+static Assets_State Assets;
+
+static uint32_t Get32(const uint8_t *buff)
+{
+  return buff[0] | ((uint32_t)buff[1] << 8) | ((uint32_t)buff[2] << 16) |
+         ((uint32_t)buff[3] << 24);
+}
+
+static uint16_t Get16(const uint8_t *buff)
+{
+  return (uint16_t)(buff[0] | (buff[1] << 8));
+}
+
+// Copy a piece of flash to RAM_G and read it back to the host
+static void ReadFlash(uint32_t offset, uint8_t *buff, uint32_t count)
+{
+  Cmd_FlashRead(Assets.PoolAddress, offset, (count + 3) & ~3);
+  UpdateFIFO();
+  Wait4CoProFIFOEmpty();
+  rdN(Assets.PoolAddress, buff, count);
+}
+
+bool Assets_Init(uint32_t poolAddress, uint32_t poolSize)
+{
+  uint8_t Header[ASSET_HEADER_SIZE];
+  uint8_t *Manifest, *Entry;
+  uint32_t Count, Size, Index;
+
+  free(Assets.Entries);
+  memset(&Assets, 0, sizeof(Assets));
+  Assets.PoolAddress = poolAddress;
+  Assets.PoolSize = poolSize & ~3;
+
+  if ((poolAddress & 3) || (poolSize < ASSET_HEADER_SIZE))
+    return false;
+  if (rd8(REG_FLASH_STATUS + RAM_REG) != FLASH_STATUS_FULL)
+  {
+    Log("Assets: flash not in full speed mode\n");
+    return false;
+  }
+
+  ReadFlash(ASSET_MANIFEST_OFFSET, Header, ASSET_HEADER_SIZE);
+  Count = Get16(Header + 6);
+  Size = Get32(Header + 8);
+  if ((Get32(Header) != ASSET_MANIFEST_MAGIC) || (Get16(Header + 4) != ASSET_MANIFEST_VERSION) ||
+      (Size < ASSET_HEADER_SIZE + Count * ASSET_ENTRY_SIZE))
+  {
+    Log("Assets: no manifest in flash\n");
+    return false;
+  }
+  if (Size > Assets.PoolSize)
+  {
+    Log("Assets: pool too small to read the manifest\n");
+    return false;
+  }
+
+  Manifest = (uint8_t *)malloc(Size);
+  Assets.Entries = (Asset_Entry *)calloc(Count ? Count : 1, sizeof(Asset_Entry));
+  if (!Manifest || !Assets.Entries)
+  {
+    free(Manifest);
+    free(Assets.Entries);
+    Assets.Entries = NULL;
+    return false;
+  }
+  ReadFlash(ASSET_MANIFEST_OFFSET, Manifest, Size);
+
+  for (Index = 0; Index < Count; Index++)
+  {
+    Entry = Manifest + ASSET_HEADER_SIZE + Index * ASSET_ENTRY_SIZE;
+    memcpy(Assets.Entries[Index].Name, Entry, ASSET_NAME_SIZE);
+    Assets.Entries[Index].Name[ASSET_NAME_SIZE - 1] = 0;
+    Assets.Entries[Index].Offset = Get32(Entry + 32);
+    Assets.Entries[Index].Size = Get32(Entry + 36);
+    Assets.Entries[Index].RawSize = Get32(Entry + 40);
+    Assets.Entries[Index].Crc = Get32(Entry + 44);
+    Assets.Entries[Index].Type = Get16(Entry + 48);
+    Assets.Entries[Index].Format = Get16(Entry + 50);
+    Assets.Entries[Index].Flags = Get16(Entry + 52);
+    Assets.Entries[Index].Width = Get16(Entry + 54);
+    Assets.Entries[Index].Height = Get16(Entry + 56);
+    Assets.Entries[Index].DataOffset = Get32(Entry + 58);
+  }
+  free(Manifest);
+  Assets.Count = Count;
+  return true;
+}
+
+uint32_t Assets_Count(void)
+{
+  return Assets.Count;
+}
+
+const Asset_Entry *Assets_Get(uint32_t index)
+{
+  return (index < Assets.Count) ? &Assets.Entries[index] : NULL;
+}
+
+const Asset_Entry *Assets_Find(const char *name)
+{
+  uint32_t Index;
+
+  for (Index = 0; Index < Assets.Count; Index++)
+  {
+    if (!strncmp(Assets.Entries[Index].Name, name, ASSET_NAME_SIZE))
+      return &Assets.Entries[Index];
+  }
+  return NULL;
+}
+
+static bool IsASTC(uint16_t format)
+{
+  return (format >= COMPRESSED_RGBA_ASTC_4x4_KHR) && (format <= COMPRESSED_RGBA_ASTC_12x12_KHR);
+}
+
+bool Assets_InFlash(const Asset_Entry *asset)
+{
+  return (asset->Type == ASSET_TYPE_BITMAP) && !(asset->Flags & ASSET_FLAG_DEFLATED) &&
+         IsASTC(asset->Format);
+}
+
+// Find room for a block in the pool, dropping assets not used lately as needed.  Returns the
+// index in Resident where the block goes, or -1.
+static int Allocate(uint32_t size, uint32_t *address)
+{
+  uint32_t Index, Start, End, Oldest;
+  int Victim;
+
+  for (;;)
+  {
+    Start = Assets.PoolAddress;
+    for (Index = 0; Index <= Assets.ResidentCount; Index++)
+    {
+      End = (Index < Assets.ResidentCount) ? Assets.Resident[Index].Address
+                                           : Assets.PoolAddress + Assets.PoolSize;
+      if ((End - Start >= size) && (Assets.ResidentCount < ASSETS_MAX_RESIDENT))
+      {
+        *address = Start;
+        return (int)Index;
+      }
+      if (Index < Assets.ResidentCount)
+        Start = Assets.Resident[Index].Address + Assets.Resident[Index].Size;
+    }
+
+    // No gap big enough - drop the least recently used asset that cannot be on screen
+    Victim = -1;
+    Oldest = Assets.Frame;
+    for (Index = 0; Index < Assets.ResidentCount; Index++)
+    {
+      if ((Assets.Resident[Index].LastUse + 1 < Assets.Frame) &&
+          (Assets.Resident[Index].LastUse < Oldest))
+      {
+        Oldest = Assets.Resident[Index].LastUse;
+        Victim = (int)Index;
+      }
+    }
+    if (Victim < 0)
+      return -1;
+    memmove(&Assets.Resident[Victim],
+            &Assets.Resident[Victim + 1],
+            (Assets.ResidentCount - Victim - 1) * sizeof(Assets_Block));
+    Assets.ResidentCount--;
+  }
+}
+
+uint32_t Assets_Load(const char *name)
+{
+  const Asset_Entry *Asset = Assets_Find(name);
+  uint32_t Index, Address, Size;
+  int Slot;
+
+  if (!Asset)
+    return ASSET_NONE;
+
+  for (Index = 0; Index < Assets.ResidentCount; Index++)
+  {
+    if (Assets.Resident[Index].Asset == (uint32_t)(Asset - Assets.Entries))
+    {
+      Assets.Resident[Index].LastUse = Assets.Frame;
+      return Assets.Resident[Index].Address;
+    }
+  }
+
+  Size = (Asset->RawSize + 3) & ~3;
+  Slot = Allocate(Size, &Address);
+  if (Slot < 0)
+  {
+    Log("Assets: no room in RAM_G for %s\n", Asset->Name);
+    return ASSET_NONE;
+  }
+  memmove(&Assets.Resident[Slot + 1],
+          &Assets.Resident[Slot],
+          (Assets.ResidentCount - Slot) * sizeof(Assets_Block));
+  Assets.Resident[Slot].Asset = (uint32_t)(Asset - Assets.Entries);
+  Assets.Resident[Slot].Address = Address;
+  Assets.Resident[Slot].Size = Size;
+  Assets.Resident[Slot].LastUse = Assets.Frame;
+  Assets.ResidentCount++;
+
+  // The coprocessor does the copy, the host only queues the command
+  if (Asset->Type == ASSET_TYPE_IMAGE)
+  {
+    Cmd_FlashSource(Asset->Offset);
+    Cmd_LoadImage(Address, OPT_FLASH | OPT_NODL);
+  }
+  else if (Asset->Flags & ASSET_FLAG_DEFLATED)
+  {
+    Cmd_FlashSource(Asset->Offset);
+    Cmd_Inflate2(Address, OPT_FLASH);
+  }
+  else
+    Cmd_FlashRead(Address, Asset->Offset, Size);
+
+  if (Asset->Type == ASSET_TYPE_FONT)
+  {
+    // Point start_of_graphic_data at the glyphs, in flash for ASTC fonts
+    Cmd_MemWrite(Address + XFONT_GRAPHIC_DATA, 4);
+    if (IsASTC(Asset->Format))
+      Send_CMD(RAM_FLASH | ((Asset->Offset + Asset->DataOffset) >> 5));
+    else
+      Send_CMD(Address + Asset->DataOffset);
+  }
+  UpdateFIFO();
+  return Address;
+}
+
+bool Assets_SetBitmap(const char *name)
+{
+  const Asset_Entry *Asset = Assets_Find(name);
+  uint32_t Source;
+
+  if (!Asset || ((Asset->Type != ASSET_TYPE_BITMAP) && (Asset->Type != ASSET_TYPE_IMAGE)))
+    return false;
+
+  if (Assets_InFlash(Asset))
+    Source = RAM_FLASH | (Asset->Offset >> 5); // Flash addresses go in 32 byte units
+  else
+  {
+    Source = Assets_Load(name);
+    if (Source == ASSET_NONE)
+      return false;
+  }
+  Cmd_SetBitmap(Source, Asset->Format, Asset->Width, Asset->Height);
+  return true;
+}
+
+bool Assets_SetFont(const char *name, uint32_t handle, uint32_t firstChar)
+{
+  uint32_t Address = Assets_Load(name);
+
+  if (Address == ASSET_NONE)
+    return false;
+  Cmd_SetFont2(handle, Address, firstChar);
+  return true;
+}
+
+bool Assets_Append(const char *name)
+{
+  const Asset_Entry *Asset = Assets_Find(name);
+  uint32_t Address = Assets_Load(name);
+
+  if (Address == ASSET_NONE)
+    return false;
+  Cmd_Append(Address, Asset->RawSize);
+  return true;
+}
+
+void Assets_NextFrame(void)
+{
+  Assets.Frame++;
+}
+
+void Assets_Flush(void)
+{
+  Assets.ResidentCount = 0;
+}
@@ -0,0 +1,112 @@
+#ifndef __EVE_ASSETS_H
+#define __EVE_ASSETS_H
+
+// Flash asset manager
+//
+// Assets live in the EVE flash, described by a manifest stored right after the flash blob.
+// ASTC bitmaps are rendered straight from flash - they never take any RAM_G.  Everything else
+// (other bitmap formats, compressed data, fonts, display list snippets) is staged into a pool in
+// RAM_G when it is first used, with CMD_FLASHREAD, or CMD_FLASHSOURCE + CMD_INFLATE2 /
+// CMD_LOADIMAGE for deflated data and JPEG/PNG images.  When the pool is full the assets used
+// least recently are dropped again, which leaves most of the 1 MB RAM_G for dynamic content.
+//
+// The flash has to be attached and in full speed mode (FlashAttach / FlashFast) first.
+//
+// Manifest layout in flash, all values little endian:
+//   header, 16 bytes:  Magic, Version (16 bit), Count (16 bit), Size (whole manifest), Reserved
+//   Count entries, 64 bytes each:
+//     0  Name        32 chars, zero padded
+//     32 Offset      flash offset of the data, a multiple of ASSET_ALIGN
+//     36 Size        bytes of data in flash
+//     40 RawSize     bytes the asset takes in RAM_G once loaded
+//     44 Crc         CRC-32 of the data in flash
+//     48 Type        ASSET_TYPE_*
+//     50 Format      bitmap format, e.g. RGB565 or COMPRESSED_RGBA_ASTC_4x4_KHR
+//     52 Flags       ASSET_FLAG_*
+//     54 Width       bitmap size in pixels
+//     56 Height
+//     58 DataOffset  fonts: offset of the glyph data from the start of the asset
+//     62 Reserved    2 bytes
+//
+// Fonts are extended fonts (xfont) whose start_of_graphic_data holds DataOffset rather than an
+// address; it is set when the font is loaded.  The glyphs of ASTC fonts stay in flash (DataOffset
+// has to be a multiple of ASSET_ALIGN then) and only the font header is loaded - RawSize tells
+// how much of the asset goes into RAM_G.
+
+#include "eve.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define ASSET_MANIFEST_MAGIC 0x54535341UL // "ASST"
+#define ASSET_MANIFEST_VERSION 1
+#define ASSET_MANIFEST_OFFSET 4096UL // The first sector of flash is the blob
+#define ASSET_HEADER_SIZE 16
+#define ASSET_ENTRY_SIZE 64
+#define ASSET_NAME_SIZE 32
+#define ASSET_ALIGN 64 // CMD_FLASHREAD wants 64 byte aligned flash addresses
+
+#define ASSET_TYPE_BITMAP 0  // Raw bitmap data
+#define ASSET_TYPE_IMAGE 1   // JPEG or PNG, decoded by CMD_LOADIMAGE
+#define ASSET_TYPE_FONT 2    // Extended font (xfont) including glyphs
+#define ASSET_TYPE_DL 3      // Display list snippet for CMD_APPEND
+#define ASSET_TYPE_BLOB 4    // Anything else
+
+#define ASSET_FLAG_DEFLATED 1 // Data is zlib compressed, RawSize is the inflated size
+
+#define ASSET_NONE 0xFFFFFFFFUL
+
+  typedef struct
+  {
+    char Name[ASSET_NAME_SIZE];
+    uint32_t Offset;
+    uint32_t Size;
+    uint32_t RawSize;
+    uint32_t Crc;
+    uint16_t Type;
+    uint16_t Format;
+    uint16_t Flags;
+    uint16_t Width;
+    uint16_t Height;
+    uint32_t DataOffset;
+  } Asset_Entry;
+
+  // Read the manifest from flash and set up the RAM_G pool used for staging.  Returns false when
+  // the flash holds no manifest.
+  bool EVE_EXPORT Assets_Init(uint32_t poolAddress, uint32_t poolSize);
+
+  uint32_t EVE_EXPORT Assets_Count(void);
+  const Asset_Entry EVE_EXPORT *Assets_Get(uint32_t index);
+  const Asset_Entry EVE_EXPORT *Assets_Find(const char *name);
+
+  // True for assets used in place from flash - ASTC bitmaps
+  bool EVE_EXPORT Assets_InFlash(const Asset_Entry *asset);
+
+  // Make sure an asset is in RAM_G and return its address there, ASSET_NONE when it does not
+  // fit.  The load is queued in the command FIFO, so commands after it can use the data.
+  uint32_t EVE_EXPORT Assets_Load(const char *name);
+
+  // Set up the current bitmap handle for a bitmap or image asset (CMD_SETBITMAP).  ASTC bitmaps
+  // point straight into flash, others are loaded into RAM_G first.
+  bool EVE_EXPORT Assets_SetBitmap(const char *name);
+
+  // Load a font asset and register it with CMD_SETFONT2
+  bool EVE_EXPORT Assets_SetFont(const char *name, uint32_t handle, uint32_t firstChar);
+
+  // Load a display list asset and append it to the current display list (CMD_APPEND)
+  bool EVE_EXPORT Assets_Append(const char *name);
+
+  // Call once per displayed frame (after CMD_SWAP).  Assets used in the current or the previous
+  // frame may still be on screen and are never dropped from RAM_G.
+  void EVE_EXPORT Assets_NextFrame(void);
+
+  // Drop everything from the RAM_G pool
+  void EVE_EXPORT Assets_Flush(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
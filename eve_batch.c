@@ -0,0 +1,272 @@
+// Batched primitives - see eve_batch.h
+
+#include "eve_batch.h"
+#include "eve.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define Log printf
+
+#define VERTEX2F_MIN -16384 // Range of a VERTEX2F coordinate, 15 bits signed
+#define VERTEX2F_MAX 16383
+#define VERTEX2II_MAX 511 // Range of a VERTEX2II coordinate, in pixels
+#define SETUP_WORDS 12    // Around the vertices: settings, BEGIN, END and the defaults again
+
+typedef struct
+{
+  uint8_t *Buff;
+  uint32_t Room;  // Words the buffer holds
+  uint32_t Count; // Words in it
+
+  // How the vertices of the batch going out are encoded
+  uint32_t Frac; // VERTEXFORMAT of the VERTEX2F vertices
+  int32_t TX;    // VERTEX_TRANSLATE, in 1/16 pixel
+  int32_t TY;
+} Batch_State;
+
+static Batch_State Batch;
+
+// The points of a batch are Batch_Vertex or Batch_Sprite, both start with X and Y
+typedef struct
+{
+  const uint8_t *Base;
+  uint32_t Stride;
+  uint32_t Count;
+} Batch_List;
+
+static const int16_t *Point(const Batch_List *points, uint32_t i)
+{
+  return (const int16_t *)(points->Base + i * points->Stride);
+}
+
+// Make room for a batch of up to words words
+static bool Start(uint32_t words)
+{
+  uint8_t *Buff;
+
+  Batch.Count = 0;
+  if (words <= Batch.Room)
+    return true;
+  Buff = (uint8_t *)realloc(Batch.Buff, words * 4);
+  if (!Buff)
+  {
+    Log("Batch: out of memory for %u words\n", (unsigned)words);
+    return false;
+  }
+  Batch.Buff = Buff;
+  Batch.Room = words;
+  return true;
+}
+
+static void Put(uint32_t word)
+{
+  uint8_t *Out = Batch.Buff + Batch.Count++ * 4;
+
+  Out[0] = word;
+  Out[1] = word >> 8;
+  Out[2] = word >> 16;
+  Out[3] = word >> 24;
+}
+
+// A coordinate in 1/16 pixel in the units of VERTEXFORMAT(4 - shift), rounded to the nearest
+static int32_t Scale(int32_t value, uint32_t shift)
+{
+  return (value + ((1 << shift) >> 1)) >> shift;
+}
+
+static bool Narrow(int32_t value)
+{
+  return !(value & 15) && (value >= 0) && (value <= VERTEX2II_MAX * 16);
+}
+
+static bool Fits(int32_t min, int32_t max, uint32_t frac)
+{
+  return (Scale(min, 4 - frac) >= VERTEX2F_MIN) && (Scale(max, 4 - frac) <= VERTEX2F_MAX);
+}
+
+typedef struct
+{
+  bool Any; // Vertices which need VERTEX2F at all
+  int32_t MinX, MaxX, MinY, MaxY;
+  uint32_t Need; // VERTEXFORMAT that holds them exactly
+} Batch_Wide;
+
+// The vertices that cannot go out as VERTEX2II with the translation tx, ty
+static void FindWide(const Batch_List *points, int32_t tx, int32_t ty, Batch_Wide *wide)
+{
+  uint32_t i, Bits = 0;
+  int32_t X, Y;
+
+  wide->Any = false;
+  for (i = 0; i < points->Count; i++)
+  {
+    X = Point(points, i)[0] - tx;
+    Y = Point(points, i)[1] - ty;
+    if (Narrow(X) && Narrow(Y))
+      continue;
+    if (!wide->Any)
+    {
+      wide->MinX = wide->MaxX = X;
+      wide->MinY = wide->MaxY = Y;
+      wide->Any = true;
+    }
+    wide->MinX = X < wide->MinX ? X : wide->MinX;
+    wide->MaxX = X > wide->MaxX ? X : wide->MaxX;
+    wide->MinY = Y < wide->MinY ? Y : wide->MinY;
+    wide->MaxY = Y > wide->MaxY ? Y : wide->MaxY;
+    Bits |= X | Y;
+  }
+  // The lowest bit set in any of them is the finest fraction needed
+  for (wide->Need = 4; (wide->Need > 0) && !(Bits & (1 << (4 - wide->Need))); wide->Need--)
+    ;
+}
+
+// Pick VERTEXFORMAT and VERTEX_TRANSLATE for the batch and queue them
+static void Plan(const Batch_List *points)
+{
+  Batch_Wide Wide;
+  bool FitX, FitY;
+  int32_t MinX, MinY;
+  uint32_t i;
+
+  Batch.Frac = 4;
+  Batch.TX = Batch.TY = 0;
+  FindWide(points, 0, 0, &Wide);
+  if (!Wide.Any)
+    return; // All VERTEX2II, nothing to set
+
+  Batch.Frac = Wide.Need;
+  FitX = Fits(Wide.MinX, Wide.MaxX, Wide.Need);
+  FitY = Fits(Wide.MinY, Wide.MaxY, Wide.Need);
+  if (!FitX || !FitY)
+  {
+    // Beyond the range at this precision, move the origin to the corner of the batch
+    MinX = Point(points, 0)[0];
+    MinY = Point(points, 0)[1];
+    for (i = 1; i < points->Count; i++)
+    {
+      MinX = Point(points, i)[0] < MinX ? Point(points, i)[0] : MinX;
+      MinY = Point(points, i)[1] < MinY ? Point(points, i)[1] : MinY;
+    }
+    Batch.TX = FitX ? 0 : MinX & ~15; // On a whole pixel, so VERTEX2II still works
+    Batch.TY = FitY ? 0 : MinY & ~15;
+    FindWide(points, Batch.TX, Batch.TY, &Wide);
+    for (Batch.Frac = Wide.Need; Batch.Frac > 0; Batch.Frac--)
+      if (Fits(Wide.MinX, Wide.MaxX, Batch.Frac) && Fits(Wide.MinY, Wide.MaxY, Batch.Frac))
+        break;
+  }
+
+  if (Batch.Frac != 4)
+    Put(VERTEXFORMAT(Batch.Frac));
+  if (Batch.TX)
+    Put(VERTEX_TRANSLATE_X(Batch.TX));
+  if (Batch.TY)
+    Put(VERTEX_TRANSLATE_Y(Batch.TY));
+}
+
+static void Vertex(int32_t x, int32_t y, uint8_t handle, uint8_t cell)
+{
+  x -= Batch.TX;
+  y -= Batch.TY;
+  if (Narrow(x) && Narrow(y))
+    Put(VERTEX2II(x >> 4, y >> 4, handle, cell));
+  else
+    Put(VERTEX2F(Scale(x, 4 - Batch.Frac), Scale(y, 4 - Batch.Frac)));
+}
+
+// Put the defaults back and send the batch as one burst
+static uint32_t Send(void)
+{
+  uint32_t Words;
+
+  if (Batch.Frac != 4)
+    Put(VERTEXFORMAT(4));
+  if (Batch.TX)
+    Put(VERTEX_TRANSLATE_X(0));
+  if (Batch.TY)
+    Put(VERTEX_TRANSLATE_Y(0));
+
+  Words = Batch.Count;
+  CoProWrCmdBuf(Batch.Buff, Words * 4);
+  Batch.Count = 0;
+  return Words;
+}
+
+static uint32_t
+Primitive(uint32_t prim, uint32_t setting, const Batch_Vertex *vertices, uint32_t count)
+{
+  Batch_List Points = {(const uint8_t *)vertices, sizeof(Batch_Vertex), count};
+  uint32_t i;
+
+  if (!count || !Start(count + SETUP_WORDS))
+    return 0;
+  if (setting)
+    Put(setting);
+  Plan(&Points);
+  Put(BEGIN(prim));
+  for (i = 0; i < count; i++)
+    Vertex(vertices[i].X, vertices[i].Y, 0, 0);
+  Put(END());
+  return Send();
+}
+
+uint32_t Batch_Points(const Batch_Vertex *vertices, uint32_t count, uint16_t size)
+{
+  return Primitive(POINTS, size ? POINT_SIZE(size) : 0, vertices, count);
+}
+
+uint32_t Batch_Lines(const Batch_Vertex *vertices, uint32_t count, uint16_t width)
+{
+  return Primitive(LINES, width ? LINE_WIDTH(width) : 0, vertices, count & ~1);
+}
+
+uint32_t Batch_LineStrip(const Batch_Vertex *vertices, uint32_t count, uint16_t width)
+{
+  return Primitive(LINE_STRIP, width ? LINE_WIDTH(width) : 0, vertices, count);
+}
+
+uint32_t Batch_Rects(const Batch_Vertex *corners, uint32_t count, uint16_t width)
+{
+  return Primitive(RECTS, width ? LINE_WIDTH(width) : 0, corners, count * 2);
+}
+
+uint32_t Batch_Sprites(const Batch_Sprite *sprites, uint32_t count)
+{
+  Batch_List Points = {(const uint8_t *)sprites, sizeof(Batch_Sprite), count};
+  const Batch_Sprite *Sprite;
+  bool HandleSet = false; // BITMAP_HANDLE and CELL are unknown until the batch sets them
+  uint8_t Handle = 0, Cell = 0;
+  uint32_t i;
+
+  // Up to a BITMAP_HANDLE and a CELL ahead of every VERTEX2F
+  if (!count || !Start(count * 3 + SETUP_WORDS))
+    return 0;
+  Plan(&Points);
+  Put(BEGIN(BITMAPS));
+  for (i = 0; i < count; i++)
+  {
+    Sprite = &sprites[i];
+    if (!Narrow(Sprite->X - Batch.TX) || !Narrow(Sprite->Y - Batch.TY))
+    {
+      // VERTEX2F takes the handle and cell from the graphics state
+      if (!HandleSet || (Handle != Sprite->Handle))
+        Put(BITMAP_HANDLE(Sprite->Handle));
+      if (!HandleSet || (Cell != Sprite->Cell))
+        Put(CELL(Sprite->Cell));
+      HandleSet = true;
+      Handle = Sprite->Handle;
+      Cell = Sprite->Cell;
+    }
+    Vertex(Sprite->X, Sprite->Y, Sprite->Handle, Sprite->Cell);
+  }
+  Put(END());
+  return Send();
+}
+
+void Batch_Free(void)
+{
+  free(Batch.Buff);
+  Batch.Buff = NULL;
+  Batch.Room = 0;
+}
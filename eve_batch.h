@@ -0,0 +1,87 @@
+#ifndef __EVE_BATCH_H
+#define __EVE_BATCH_H
+
+// Batched primitives
+//
+// A chart or a field of particles is a BEGIN, one vertex per point and an END, and sent through
+// Send_CMD that is a round of the FIFO bookkeeping per word.  The Batch_ functions take the
+// vertices as an array instead, encode the whole primitive on the host and queue it with a single
+// CoProWrCmdBuf burst.
+//
+// Vertices are in 1/16 pixel, as VERTEX2F takes them by default.  Each one goes out as VERTEX2II
+// where it can - a whole pixel from 0 to 511 - and as VERTEX2F otherwise.  For the VERTEX2F ones
+// the batch picks VERTEXFORMAT once: the finest that still holds all of them, with a
+// VERTEX_TRANSLATE to the corner of the batch when they are beyond the +-1024 pixels VERTEX2F
+// covers at 1/16 pixel.  Both are set back to their defaults (VERTEXFORMAT(4), no translation)
+// at the end of the batch, so a display list that changes them itself has to set them again.
+// Batch_Sprites also sets BITMAP_HANDLE and CELL for its VERTEX2F sprites and leaves them as the
+// last of those sprites had them - there are no defaults to go back to.
+//
+//   Batch_Vertex Trace[480];
+//   for (i = 0; i < 480; i++)
+//   {
+//     Trace[i].X = BATCH_PX(i);
+//     Trace[i].Y = BATCH_PX(136) + Samples[i];
+//   }
+//   Send_CMD(COLOR_RGB(0, 255, 0));
+//   Batch_LineStrip(Trace, 480, 24);
+//
+// RAM_DL holds 2048 instructions per frame, so that is the ceiling on vertices, not the FIFO.
+// Each Batch_ function returns the number of display list words the batch took.
+//
+// Batches go to the block hook of EVE_SetCmdHook like any CoProWrCmdBuf block, so the journal of
+// eve_journal.h keeps them with the rest of the frame.
+//
+// The batches are put together in one static buffer, shared by all contexts.  With a context per
+// thread (EVE_SetContext) only one thread at a time may use the Batch_ functions.
+
+#include "eve.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define BATCH_PX(p) ((int16_t)((p) * 16)) // Whole pixels in the units of Batch_Vertex
+
+  typedef struct
+  {
+    int16_t X; // In 1/16 pixel
+    int16_t Y;
+  } Batch_Vertex;
+
+  typedef struct
+  {
+    int16_t X; // Top left corner, in 1/16 pixel
+    int16_t Y;
+    uint8_t Handle; // Bitmap handle, 0 - 31
+    uint8_t Cell;   // Cell of the bitmap, 0 - 127
+  } Batch_Sprite;
+
+  // Points of size/16 pixel radius, 0 to keep the POINT_SIZE set before
+  uint32_t EVE_EXPORT Batch_Points(const Batch_Vertex *vertices, uint32_t count, uint16_t size);
+
+  // count / 2 separate lines, width/16 pixel wide, 0 to keep the LINE_WIDTH set before
+  uint32_t EVE_EXPORT Batch_Lines(const Batch_Vertex *vertices, uint32_t count, uint16_t width);
+
+  // One line through count vertices
+  uint32_t EVE_EXPORT Batch_LineStrip(const Batch_Vertex *vertices,
+                                      uint32_t count,
+                                      uint16_t width);
+
+  // count rectangles, each given by two opposite corners (2 * count vertices).  width rounds the
+  // corners as LINE_WIDTH does, 0 to keep the one set before.
+  uint32_t EVE_EXPORT Batch_Rects(const Batch_Vertex *corners, uint32_t count, uint16_t width);
+
+  // count bitmaps.  The bitmap handles have to be set up already.  Sprites that go out as
+  // VERTEX2F change BITMAP_HANDLE and CELL, which are not set back.
+  uint32_t EVE_EXPORT Batch_Sprites(const Batch_Sprite *sprites, uint32_t count);
+
+  // Release the buffer the batches are put together in
+  void EVE_EXPORT Batch_Free(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,96 @@
+// Several EVEs, each on a USB bridge of its own - see eve_bridges.h
+
+#include "eve_bridges.h"
+#include "eve.h"
+#include "eve_os.h"
+#include "hw_api.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define Log printf
+
+static void BringUp(void *arg)
+{
+  Bridges_Panel *Panel = (Bridges_Panel *)arg;
+  uint32_t Start = HAL_TimeUs();
+
+  EVE_SetContext(&Panel->Context);
+  Panel->ChipID = EVE_Init(Panel->Display, Panel->Board, Panel->Touch);
+  Panel->StartUs = HAL_TimeUs() - Start;
+  EVE_SetContext(NULL);
+}
+
+void Bridges_Hal(void *bridge, EVE_Hal *hal)
+{
+  hal->Device = bridge;
+  hal->SPI_Enable = HAL_Bridge_SPI_Enable;
+  hal->SPI_Disable = HAL_Bridge_SPI_Disable;
+  hal->SPI_Write = HAL_Bridge_SPI_Write;
+  hal->SPI_WriteBuffer = HAL_Bridge_SPI_WriteBuffer;
+  hal->SPI_ReadBuffer = HAL_Bridge_SPI_ReadBuffer;
+  hal->Open = HAL_Bridge_Open;
+  hal->Reset = HAL_Bridge_Reset;
+  hal->Close = HAL_Bridge_Close;
+  hal->Lost = HAL_Bridge_Lost;
+}
+
+int Bridges_Open(Bridges_Panel *panels, int count)
+{
+  OS_Thread Threads[BRIDGES_MAX];
+  bool Started[BRIDGES_MAX];
+  EVE_Hal Hal;
+  int i, Up = 0;
+
+  if (count > BRIDGES_MAX)
+    count = BRIDGES_MAX;
+  HAL_Bridge_List(NULL, 0); // Search the bus once, here, rather than from every thread
+  for (i = 0; i < count; i++)
+  {
+    panels[i].ChipID = 0;
+    panels[i].StartUs = 0;
+    panels[i].Bridge = HAL_Bridge_Get(panels[i].Serial, panels[i].Location);
+    Started[i] = false;
+    if (!panels[i].Bridge)
+      continue;
+    Bridges_Hal(panels[i].Bridge, &Hal);
+    EVE_ContextInit(&panels[i].Context, &Hal);
+    Started[i] = OS_ThreadStart(&Threads[i], BringUp, &panels[i]);
+    if (!Started[i])
+      BringUp(&panels[i]); // No thread, this one the slow way
+  }
+
+  for (i = 0; i < count; i++)
+  {
+    if (Started[i])
+      OS_ThreadJoin(&Threads[i]);
+    if (panels[i].ChipID > 1)
+      Up++;
+    else
+      Log("Bridges: panel %d (%s) did not come up\n", i,
+          panels[i].Serial ? panels[i].Serial : "by location");
+  }
+  return Up;
+}
+
+void Bridges_Close(Bridges_Panel *panels, int count)
+{
+  int i;
+
+  for (i = 0; i < count; i++)
+  {
+    if (!panels[i].Bridge)
+      continue;
+    HAL_Bridge_Free(panels[i].Bridge);
+    panels[i].Bridge = NULL;
+    panels[i].Context.Hal.Device = NULL;
+  }
+}
+
+void Bridges_GetStats(const Bridges_Panel *panel, HAL_BridgeStats *stats)
+{
+  if (panel->Bridge)
+    HAL_Bridge_GetStats(panel->Bridge, stats);
+  else
+    memset(stats, 0, sizeof(*stats));
+}
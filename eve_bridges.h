@@ -0,0 +1,63 @@
+#ifndef __EVE_BRIDGES_H
+#define __EVE_BRIDGES_H
+
+// Several EVEs, each on a USB bridge of its own
+//
+// Every panel gets a context (see EVE_Context) that talks through its bridge with the
+// HAL_Bridge_* functions of hw_api.h.  The bridges are picked by serial number, which stays with
+// the bridge, or by location, which stays with the USB port.  Bringing a panel up is mostly
+// waiting - the PD_N pulse, the boot of the chip, the touch engine - so Bridges_Open() runs
+// EVE_Init for all of them at once, each on a thread of its own, and the whole setup takes about
+// as long as the slowest panel instead of the sum of them.
+//
+//   Bridges_Panel Panels[2] = {{"MO123456", 0, DISPLAY_70, BOARD_EVE4, TOUCH_TPC},
+//                              {"MO123457", 0, DISPLAY_43, BOARD_EVE3, TOUCH_TPR}};
+//   Bridges_Open(Panels, 2);
+//   EVE_SetContext(&Panels[0].Context);
+//   ... draw on the first panel ...
+//
+// A thread talks to the panel of the context it has set, so after Bridges_Open each panel can be
+// driven by a thread of its own just the same, without locking - the bridges are independent.
+
+#include "eve.h"
+#include "hw_api.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define BRIDGES_MAX 8 // Panels brought up by one Bridges_Open
+
+  typedef struct
+  {
+    const char *Serial; // Of the bridge, NULL to go by Location
+    uint32_t Location;  // See HAL_BridgeInfo, used when Serial is NULL
+    int Display;        // As EVE_Init
+    int Board;
+    int Touch;
+
+    // Filled in by Bridges_Open
+    EVE_Context Context;
+    void *Bridge;
+    int ChipID;        // Return value of EVE_Init, 0 or 1 if the panel did not come up
+    uint32_t StartUs;  // Time EVE_Init took for this panel
+  } Bridges_Panel;
+
+  // Point hal at one bridge of HAL_Bridge_Get
+  void EVE_EXPORT Bridges_Hal(void *bridge, EVE_Hal *hal);
+
+  // Bring up count panels in parallel, returns how many of them came up
+  int EVE_EXPORT Bridges_Open(Bridges_Panel *panels, int count);
+
+  // Close the bridges again and free them
+  void EVE_EXPORT Bridges_Close(Bridges_Panel *panels, int count);
+
+  // Transfers and throughput of the bridge of a panel
+  void EVE_EXPORT Bridges_GetStats(const Bridges_Panel *panel, HAL_BridgeStats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
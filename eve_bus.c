@@ -0,0 +1,154 @@
+// Bus arbiter for threads sharing one bridge - see eve_bus.h
+
+#include "eve_bus.h"
+#include "eve.h"
+#include "eve_os.h"
+#include <stdint.h>
+#include <string.h>
+
+// One lock with an owner, taken with a compare and swap of Held when it is free.  Owner and
+// Depth are only written by the thread that holds it, which is all the nesting check needs.
+typedef struct
+{
+  volatile uint32_t Held;
+  volatile uint32_t Depth;
+  volatile uint32_t Waiting;  // Threads in the slow path
+  volatile uint32_t Priority; // Of those, the ones with priority
+  OS_ThreadId Owner;
+  uint32_t Locks; // Counted by each new owner, so under the lock itself
+  uint32_t Contended;
+  uint32_t PriorityLocks;
+} Bus_Owner;
+
+typedef struct
+{
+  OS_Mutex Lock; // Only for waiting, Released is signalled when an owner lets go
+  OS_Cond Released;
+  Bus_Owner Bus;
+  Bus_Owner Stream;
+  bool Installed;
+} Bus_State;
+
+static Bus_State Bus;
+
+static bool Nested(Bus_Owner *owner)
+{
+  if (!OS_AtomicLoad(&owner->Depth) || !OS_ThreadIsSelf(owner->Owner))
+    return false;
+  owner->Depth++;
+  return true;
+}
+
+static void Take(Bus_Owner *owner)
+{
+  owner->Owner = OS_ThreadSelf();
+  OS_AtomicStore(&owner->Depth, 1);
+  owner->Locks++;
+}
+
+static void Acquire(Bus_Owner *owner, bool priority)
+{
+  if (Nested(owner))
+    return;
+  if ((priority || !OS_AtomicLoad(&owner->Priority)) &&
+      OS_AtomicCompareExchange(&owner->Held, 0, 1))
+  {
+    Take(owner);
+    owner->PriorityLocks += priority;
+    return;
+  }
+
+  OS_MutexLock(&Bus.Lock);
+  OS_AtomicAdd(&owner->Waiting, 1);
+  if (priority)
+    OS_AtomicAdd(&owner->Priority, 1);
+  while ((!priority && OS_AtomicLoad(&owner->Priority)) ||
+         !OS_AtomicCompareExchange(&owner->Held, 0, 1))
+    OS_CondWait(&Bus.Released, &Bus.Lock);
+  if (priority)
+    OS_AtomicAdd(&owner->Priority, -1);
+  OS_AtomicAdd(&owner->Waiting, -1);
+  OS_MutexUnlock(&Bus.Lock);
+  Take(owner);
+  owner->PriorityLocks += priority;
+  owner->Contended++;
+}
+
+static void Release(Bus_Owner *owner)
+{
+  if (!owner->Depth || --owner->Depth)
+    return;
+  OS_AtomicCompareExchange(&owner->Held, 1, 0); // A full barrier before Waiting is looked at
+  if (!OS_AtomicAdd(&owner->Waiting, 0))
+    return;
+  OS_MutexLock(&Bus.Lock);
+  OS_CondBroadcast(&Bus.Released);
+  OS_MutexUnlock(&Bus.Lock);
+}
+
+static void TransactionLock(void)
+{
+  Bus_Lock(false);
+}
+
+void Bus_Init(void)
+{
+  if (Bus.Installed)
+    return;
+  memset(&Bus, 0, sizeof(Bus));
+  OS_MutexInit(&Bus.Lock);
+  OS_CondInit(&Bus.Released);
+  Bus.Installed = true;
+  EVE_SetBusLock(TransactionLock, Bus_Unlock);
+}
+
+void Bus_Close(void)
+{
+  if (!Bus.Installed)
+    return;
+  EVE_SetBusLock(NULL, NULL);
+  OS_CondDestroy(&Bus.Released);
+  OS_MutexDestroy(&Bus.Lock);
+  Bus.Installed = false;
+}
+
+void Bus_Lock(bool priority)
+{
+  if (!Bus.Installed)
+    return;
+  Acquire(&Bus.Bus, priority);
+}
+
+void Bus_Unlock(void)
+{
+  if (Bus.Installed)
+    Release(&Bus.Bus);
+}
+
+void Bus_BeginFrame(void)
+{
+  if (!Bus.Installed)
+    return;
+  Acquire(&Bus.Stream, false);
+}
+
+void Bus_EndFrame(void)
+{
+  if (Bus.Installed)
+    Release(&Bus.Stream);
+}
+
+void Bus_GetStats(Bus_Stats *stats)
+{
+  stats->Locks = Bus.Bus.Locks;
+  stats->Contended = Bus.Bus.Contended;
+  stats->Priority = Bus.Bus.PriorityLocks;
+  stats->Frames = Bus.Stream.Locks;
+  stats->FramesContended = Bus.Stream.Contended;
+}
+
+void Bus_ResetStats(void)
+{
+  Bus.Bus.Locks = Bus.Bus.Contended = Bus.Bus.PriorityLocks = 0;
+  Bus.Stream.Locks = Bus.Stream.Contended = 0;
+}
@@ -0,0 +1,66 @@
+#ifndef __EVE_BUS_H
+#define __EVE_BUS_H
+
+// Bus arbiter for threads sharing one bridge
+//
+// Bus_Init() hooks the arbiter into the current context of eve.c (EVE_SetBusLock), after which
+// every SPI transaction locks the bus for its duration.  Long operations such as CoProWrCmdBuf
+// are made of many short transactions, so another thread gets its turn between two of them
+// instead of after the whole upload.  Threads which lock with priority, like the touch sampler,
+// are served before the threads waiting without it - the lane for small register reads.
+//
+// The command stream needs more than that: Send_CMD and friends move FifoWriteLocation, so the
+// commands of two threads must not mix.  A thread that writes commands owns the stream from
+// Bus_BeginFrame() to Bus_EndFrame(), usually for one frame.  Other threads still get single
+// transactions in between, register reads for example, which leave the FIFO alone.
+//
+//   Bus_BeginFrame();
+//   Send_CMD(CMD_DLSTART);
+//   ...
+//   Send_CMD(CMD_SWAP);
+//   UpdateFIFO();
+//   Bus_EndFrame();
+//
+// Both locks take a single atomic operation while nobody else wants them, the mutex is only
+// used for waiting.  A thread holding a lock may take it again, e.g. the bus around a few rd32()s
+// that have to go out back to back; every lock needs its unlock.  A thread that wants both takes
+// the frame first and the bus second.
+
+#include "eve.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  typedef struct
+  {
+    uint32_t Locks;           // Bus locks taken, not counting nested ones
+    uint32_t Contended;       // Of those, the ones that had to wait
+    uint32_t Priority;        // Of those, the ones taken with priority
+    uint32_t Frames;          // Command stream owned with Bus_BeginFrame
+    uint32_t FramesContended; // Of those, the ones that had to wait
+  } Bus_Stats;
+
+  // Install the arbiter, call this before starting other threads that use the bus
+  void EVE_EXPORT Bus_Init(void);
+
+  // Remove it again, once only one thread is left using the bus
+  void EVE_EXPORT Bus_Close(void);
+
+  // Own the bus for one or more transactions
+  void EVE_EXPORT Bus_Lock(bool priority);
+  void EVE_EXPORT Bus_Unlock(void);
+
+  // Own the command stream
+  void EVE_EXPORT Bus_BeginFrame(void);
+  void EVE_EXPORT Bus_EndFrame(void);
+
+  void EVE_EXPORT Bus_GetStats(Bus_Stats *stats);
+  void EVE_EXPORT Bus_ResetStats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,302 @@
+// Touch calibration without blocking - see eve_calibrate.h
+
+#include "eve_calibrate.h"
+#include "eve.h"
+#include "eve_flash.h"
+#include "hw_api.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define Log printf
+
+#define STEP_IDLE 0
+#define STEP_RELEASE 1 // Waiting for the panel to be released
+#define STEP_PRESS 2   // Waiting for a steady touch on the current point
+#define STEP_COPRO 3   // Waiting for CMD_CALIBRATE to finish
+#define STEP_DONE 4
+#define STEP_FAILED 5
+
+#define TOUCH_NONE 0x80000000UL // REG_TOUCH_DIRECT_XY while the panel is not touched
+
+typedef struct
+{
+  uint32_t DisplayX[3], DisplayY[3];
+  uint32_t TouchX[3], TouchY[3];
+  int32_t Matrix[6];
+  uint32_t LastPoll;
+  uint16_t ResultLocation;
+  uint8_t Step;
+  uint8_t Point;
+  uint8_t Stable;
+} Calibrate_State;
+
+static Calibrate_State Calibrate;
+
+static void Put32(uint8_t *buff, uint32_t value)
+{
+  buff[0] = (uint8_t)value;
+  buff[1] = (uint8_t)(value >> 8);
+  buff[2] = (uint8_t)(value >> 16);
+  buff[3] = (uint8_t)(value >> 24);
+}
+
+static uint32_t Get32(const uint8_t *buff)
+{
+  return buff[0] | ((uint32_t)buff[1] << 8) | ((uint32_t)buff[2] << 16) |
+         ((uint32_t)buff[3] << 24);
+}
+
+static void DrawPoint(void)
+{
+  uint16_t Width = (uint16_t)Display_Width(), Height = (uint16_t)Display_Height();
+  uint16_t X = (uint16_t)Display_HOffset(), Y = (uint16_t)Display_VOffset();
+  char Num[2] = {(char)('1' + Calibrate.Point), 0};
+
+  Send_CMD(CMD_DLSTART);
+  Send_CMD(CLEAR_COLOR_RGB(0, 0, 0));
+  Send_CMD(CLEAR(1, 1, 1));
+  Send_CMD(COLOR_RGB(255, 0, 0));
+  Send_CMD(POINT_SIZE(20 * 16));
+  Send_CMD(BEGIN(POINTS));
+  Send_CMD(VERTEX2F(Calibrate.DisplayX[Calibrate.Point] * 16,
+                    Calibrate.DisplayY[Calibrate.Point] * 16));
+  Send_CMD(END());
+  Send_CMD(COLOR_RGB(255, 255, 255));
+  Cmd_Text(Width / 2 + X, Height / 3 + Y, 27, OPT_CENTER, "Calibrating");
+  Cmd_Text(Width / 2 + X, Height / 2 + Y, 27, OPT_CENTER, "Please tap the dots");
+  Cmd_Text((uint16_t)Calibrate.DisplayX[Calibrate.Point],
+           (uint16_t)Calibrate.DisplayY[Calibrate.Point],
+           27,
+           OPT_CENTER,
+           Num);
+  Send_CMD(DISPLAY());
+  Send_CMD(CMD_SWAP);
+  UpdateFIFO(); // No need to wait, the next poll is a while off
+}
+
+void Calibrate_Start(uint32_t mode)
+{
+  memset(&Calibrate, 0, sizeof(Calibrate));
+  if (mode == CALIBRATE_COPRO)
+  {
+    Send_CMD(CMD_DLSTART);
+    Send_CMD(CLEAR_COLOR_RGB(0, 0, 0));
+    Send_CMD(CLEAR(1, 1, 1));
+    Cmd_Text((uint16_t)(Display_Width() / 2 + Display_HOffset()),
+             (uint16_t)(Display_Height() / 2 + Display_VOffset()),
+             27,
+             OPT_CENTER,
+             "Please tap the dots");
+    Cmd_Calibrate(0);
+    Calibrate.ResultLocation = (FifoWriteLocation - 4) % FT_CMD_FIFO_SIZE;
+    UpdateFIFO();
+    Calibrate.Step = STEP_COPRO;
+  }
+  else
+  {
+    Calibrate_Points((uint16_t)Display_Width(),
+                     (uint16_t)Display_Height(),
+                     (uint16_t)Display_VOffset(),
+                     (uint16_t)Display_HOffset(),
+                     Calibrate.DisplayX,
+                     Calibrate.DisplayY);
+    DrawPoint();
+    Calibrate.Step = STEP_RELEASE; // A finger still on the panel does not count for point 1
+  }
+  Calibrate.LastPoll = HAL_TimeUs();
+}
+
+// Write the transform to the touch registers in one burst
+static void WriteMatrix(const int32_t *matrix)
+{
+  uint8_t Regs[24];
+  uint32_t Index;
+
+  for (Index = 0; Index < 6; Index++)
+    Put32(Regs + Index * 4, (uint32_t)matrix[Index]);
+  wrN(REG_TOUCH_TRANSFORM_A + RAM_REG, Regs, sizeof(Regs));
+}
+
+static void ReadMatrix(int32_t *matrix)
+{
+  uint8_t Regs[24];
+  uint32_t Index;
+
+  rdN(REG_TOUCH_TRANSFORM_A + RAM_REG, Regs, sizeof(Regs));
+  for (Index = 0; Index < 6; Index++)
+    matrix[Index] = (int32_t)Get32(Regs + Index * 4);
+}
+
+static bool Near(uint32_t a, uint32_t b)
+{
+  return ((a > b) ? a - b : b - a) <= CALIBRATE_JITTER;
+}
+
+static int PollCoPro(void)
+{
+  uint16_t Read = rd16(REG_CMD_READ + RAM_REG);
+
+  if (Read == 0xFFF)
+  {
+    CoPro_Recover(); // Reports the fault and gets the coprocessor going again
+    Calibrate.Step = STEP_FAILED;
+    return CALIBRATE_FAILED;
+  }
+  if (Read != FifoWriteLocation)
+    return CALIBRATE_BUSY;
+  if (!rd32(RAM_CMD + Calibrate.ResultLocation))
+  {
+    Log("Calibrate: CMD_CALIBRATE failed\n");
+    Calibrate.Step = STEP_FAILED;
+    return CALIBRATE_FAILED;
+  }
+  ReadMatrix(Calibrate.Matrix);
+  Calibrate.Step = STEP_DONE;
+  return CALIBRATE_DONE;
+}
+
+int Calibrate_Poll(void)
+{
+  uint32_t Now = HAL_TimeUs(), Touch, X, Y;
+
+  if (Calibrate.Step == STEP_DONE)
+    return CALIBRATE_DONE;
+  if ((Calibrate.Step == STEP_IDLE) || (Calibrate.Step == STEP_FAILED))
+    return CALIBRATE_FAILED;
+  if (Now - Calibrate.LastPoll < CALIBRATE_POLL_US)
+    return CALIBRATE_BUSY;
+  Calibrate.LastPoll = Now;
+
+  if (Calibrate.Step == STEP_COPRO)
+    return PollCoPro();
+
+  Touch = rd32(REG_TOUCH_DIRECT_XY + RAM_REG);
+  if (Calibrate.Step == STEP_RELEASE)
+  {
+    if (Touch & TOUCH_NONE)
+    {
+      Calibrate.Stable = 0;
+      Calibrate.Step = STEP_PRESS;
+    }
+    return CALIBRATE_BUSY;
+  }
+
+  if (Touch & TOUCH_NONE)
+  {
+    Calibrate.Stable = 0;
+    return CALIBRATE_BUSY;
+  }
+  X = (Touch >> 16) & 0x03FF;
+  Y = Touch & 0x03FF;
+  if (Calibrate.Stable && (!Near(X, Calibrate.TouchX[Calibrate.Point]) ||
+                           !Near(Y, Calibrate.TouchY[Calibrate.Point])))
+    Calibrate.Stable = 0;
+  Calibrate.TouchX[Calibrate.Point] = X;
+  Calibrate.TouchY[Calibrate.Point] = Y;
+  if (++Calibrate.Stable < CALIBRATE_DEBOUNCE)
+    return CALIBRATE_BUSY;
+
+  if (++Calibrate.Point < 3)
+  {
+    DrawPoint();
+    Calibrate.Step = STEP_RELEASE;
+    return CALIBRATE_BUSY;
+  }
+  if (!Calibrate_Matrix(Calibrate.DisplayX,
+                        Calibrate.DisplayY,
+                        Calibrate.TouchX,
+                        Calibrate.TouchY,
+                        Calibrate.Matrix))
+  {
+    // The touches were in a line and give no transform, start over
+    Log("Calibrate: points in a line, again\n");
+    Calibrate.Point = 0;
+    DrawPoint();
+    Calibrate.Step = STEP_RELEASE;
+    return CALIBRATE_BUSY;
+  }
+  WriteMatrix(Calibrate.Matrix);
+  Calibrate.Step = STEP_DONE;
+  return CALIBRATE_DONE;
+}
+
+bool Calibrate_GetMatrix(int32_t *matrix)
+{
+  if (Calibrate.Step != STEP_DONE)
+    return false;
+  memcpy(matrix, Calibrate.Matrix, sizeof(Calibrate.Matrix));
+  return true;
+}
+
+// The current transform as stored in files and flash
+static void Pack(uint8_t *data)
+{
+  int32_t Matrix[6];
+  uint32_t Index;
+
+  ReadMatrix(Matrix);
+  Put32(data, CALIBRATE_MAGIC);
+  for (Index = 0; Index < 6; Index++)
+    Put32(data + 4 + Index * 4, (uint32_t)Matrix[Index]);
+}
+
+static bool Unpack(const uint8_t *data)
+{
+  int32_t Matrix[6];
+  uint32_t Index;
+
+  if (Get32(data) != CALIBRATE_MAGIC)
+    return false;
+  for (Index = 0; Index < 6; Index++)
+    Matrix[Index] = (int32_t)Get32(data + 4 + Index * 4);
+  WriteMatrix(Matrix);
+  return true;
+}
+
+bool Calibrate_Save(const char *fileName)
+{
+  uint8_t Data[CALIBRATE_DATA_SIZE];
+  bool Result;
+  FILE *File = fopen(fileName, "wb");
+
+  if (!File)
+    return false;
+  Pack(Data);
+  Result = fwrite(Data, sizeof(Data), 1, File) == 1;
+  return (fclose(File) == 0) && Result;
+}
+
+bool Calibrate_Load(const char *fileName)
+{
+  uint8_t Data[CALIBRATE_DATA_SIZE];
+  bool Result;
+  FILE *File = fopen(fileName, "rb");
+
+  if (!File)
+    return false;
+  Result = (fread(Data, sizeof(Data), 1, File) == 1) && Unpack(Data);
+  fclose(File);
+  return Result;
+}
+
+bool Calibrate_SaveFlash(uint32_t flashAddress, uint32_t stagingAddress)
+{
+  uint8_t Data[CALIBRATE_DATA_SIZE];
+
+  Pack(Data);
+  return Flash_Program(flashAddress, Data, sizeof(Data), NULL, stagingAddress, NULL);
+}
+
+bool Calibrate_LoadFlash(uint32_t flashAddress, uint32_t stagingAddress)
+{
+  uint8_t Data[CALIBRATE_DATA_SIZE];
+
+  // CMD_FLASHREAD moves multiples of 4 bytes from 64 byte aligned flash addresses
+  Cmd_FlashRead(stagingAddress, flashAddress, (CALIBRATE_DATA_SIZE + 3) & ~3);
+  UpdateFIFO();
+  Wait4CoProFIFOEmpty();
+  rdN(stagingAddress, Data, sizeof(Data));
+  return Unpack(Data);
+}
@@ -0,0 +1,70 @@
+#ifndef __EVE_CALIBRATE_H
+#define __EVE_CALIBRATE_H
+
+// Touch calibration without blocking, with persistent results
+//
+// Calibrate_Manual() and CMD_CALIBRATE both keep the host busy until all three points were
+// tapped.  Here calibration is a state machine instead: Calibrate_Start() puts the first point on
+// screen and Calibrate_Poll(), called from the normal main loop, advances it.  The touch panel
+// is read at most every CALIBRATE_POLL_US, a point only counts once CALIBRATE_DEBOUNCE readings
+// in a row agree, and the next point is only taken after the panel was released.  With
+// CALIBRATE_COPRO the coprocessor runs CMD_CALIBRATE and only its completion is polled.
+//
+// The resulting transform can be kept in a host file or in the EVE flash and loaded at the next
+// start, so calibration only has to be done once:
+//
+//   if (!Calibrate_Load("touch.cal"))
+//   {
+//     Calibrate_Start(CALIBRATE_POINTS);
+//     while (Calibrate_Poll() == CALIBRATE_BUSY)
+//       DoOtherWork();
+//     Calibrate_Save("touch.cal");
+//   }
+
+#include "eve.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// Calibrate_Start modes
+#define CALIBRATE_POINTS 0 // Points drawn and transform calculated by the host
+#define CALIBRATE_COPRO 1  // CMD_CALIBRATE, the transform is read back afterwards
+
+// Calibrate_Poll results
+#define CALIBRATE_BUSY 0
+#define CALIBRATE_DONE 1
+#define CALIBRATE_FAILED 2 // Coprocessor calibration failed, or no calibration was started
+
+#define CALIBRATE_POLL_US 10000 // Touch panel read rate
+#define CALIBRATE_DEBOUNCE 3    // Readings in a row that have to agree
+#define CALIBRATE_JITTER 8      // How far, in raw touch units, readings may differ and agree
+
+#define CALIBRATE_MAGIC 0x4C414354UL // "TCAL"
+#define CALIBRATE_DATA_SIZE 28       // Magic, REG_TOUCH_TRANSFORM_A - F
+
+  // Put up the calibration screen and start polling
+  void EVE_EXPORT Calibrate_Start(uint32_t mode);
+
+  // Advance the calibration, call it from the main loop until it returns something other than
+  // CALIBRATE_BUSY.  Once done the transform is in the touch registers.
+  int EVE_EXPORT Calibrate_Poll(void);
+
+  // The transform of the last calibration, false if none completed
+  bool EVE_EXPORT Calibrate_GetMatrix(int32_t *matrix);
+
+  // Keep the current touch transform in a host file, or load it into the touch registers
+  bool EVE_EXPORT Calibrate_Save(const char *fileName);
+  bool EVE_EXPORT Calibrate_Load(const char *fileName);
+
+  // The same for the EVE flash, at a sector aligned flashAddress.  The flash has to be in full
+  // speed mode (FlashAttach / FlashFast); two sectors of RAM_G at stagingAddress are used.
+  bool EVE_EXPORT Calibrate_SaveFlash(uint32_t flashAddress, uint32_t stagingAddress);
+  bool EVE_EXPORT Calibrate_LoadFlash(uint32_t flashAddress, uint32_t stagingAddress);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
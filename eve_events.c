@@ -0,0 +1,164 @@
+// Interrupt driven touch events - see eve_events.h
+
+#include "eve_events.h"
+#include "eve.h"
+#include "hw_api.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define Log printf
+
+#define TOUCH_NONE 0x80008000UL // REG_TOUCH_SCREEN_XY while the panel is not touched
+#define TOUCH_BURST (REG_TOUCH_TAG + 4 - REG_TOUCH_SCREEN_XY) // SCREEN_XY, TAG_XY, TAG
+
+typedef struct
+{
+  Touch_Event Queue[EVENTS_QUEUE_SIZE];
+  uint32_t Head; // Next event to take
+  uint32_t Count;
+  bool (*IntLine)(void);
+  bool Pressed;
+  uint8_t Tag;
+  int16_t X;
+  int16_t Y;
+  Events_Stats Stats;
+} Events_State;
+
+static Events_State Events;
+
+static uint32_t Get32(const uint8_t *buff)
+{
+  return buff[0] | ((uint32_t)buff[1] << 8) | ((uint32_t)buff[2] << 16) |
+         ((uint32_t)buff[3] << 24);
+}
+
+void Events_Init(uint8_t mask)
+{
+  bool (*IntLine)(void) = Events.IntLine;
+
+  memset(&Events, 0, sizeof(Events));
+  Events.IntLine = IntLine;
+  wr8(REG_INT_MASK + RAM_REG, mask);
+  wr8(REG_INT_EN + RAM_REG, 1);
+  rd8(REG_INT_FLAGS + RAM_REG); // Start from a clean slate
+}
+
+void Events_Stop(void)
+{
+  wr8(REG_INT_EN + RAM_REG, 0);
+}
+
+void Events_SetIntLine(bool (*pending)(void))
+{
+  Events.IntLine = pending;
+}
+
+static void Queue(uint8_t type, uint32_t time)
+{
+  Touch_Event *Event;
+
+  if (Events.Count == EVENTS_QUEUE_SIZE)
+  {
+    // Full - the oldest event goes
+    Events.Head = (Events.Head + 1) % EVENTS_QUEUE_SIZE;
+    Events.Count--;
+    Events.Stats.Dropped++;
+  }
+  Event = &Events.Queue[(Events.Head + Events.Count) % EVENTS_QUEUE_SIZE];
+  Event->Time = time;
+  Event->Type = type;
+  Event->Tag = Events.Tag;
+  Event->X = Events.X;
+  Event->Y = Events.Y;
+  Events.Count++;
+  Events.Stats.Events++;
+}
+
+uint32_t Events_Poll(void)
+{
+  uint8_t Regs[TOUCH_BURST];
+  uint32_t Before = Events.Stats.Events, Time, XY;
+  uint8_t Flags, Tag;
+  int16_t X, Y;
+  bool Pressed;
+
+  Events.Stats.Polls++;
+  if (Events.IntLine && !Events.IntLine())
+    return 0;
+  Flags = rd8(REG_INT_FLAGS + RAM_REG);
+  Events.Stats.Flags++;
+
+  // Conversions complete all the time, they only matter while there is a touch to follow
+  if (!(Flags & (INT_TOUCH | INT_TAG)) && !(Events.Pressed && (Flags & INT_CONVCOMPLETE)))
+    return 0;
+
+  Time = HAL_TimeUs();
+  rdN(REG_TOUCH_SCREEN_XY + RAM_REG, Regs, TOUCH_BURST);
+  Events.Stats.Bursts++;
+  XY = Get32(Regs);
+  Tag = Regs[REG_TOUCH_TAG - REG_TOUCH_SCREEN_XY];
+  Pressed = XY != TOUCH_NONE;
+
+  X = (int16_t)(XY >> 16);
+  Y = (int16_t)(XY & 0xFFFF);
+  if (Pressed && !Events.Pressed)
+  {
+    Events.X = X;
+    Events.Y = Y;
+    Events.Tag = Tag;
+    Queue(EVENT_DOWN, Time);
+  }
+  else if (Pressed && ((X != Events.X) || (Y != Events.Y)))
+  {
+    Events.X = X;
+    Events.Y = Y;
+    Queue(EVENT_MOVE, Time);
+  }
+  if (Pressed && (Tag != Events.Tag))
+  {
+    Events.Tag = Tag;
+    Queue(EVENT_TAG, Time);
+  }
+  if (!Pressed && Events.Pressed)
+  {
+    Queue(EVENT_UP, Time);
+    Events.Tag = 0;
+  }
+  Events.Pressed = Pressed;
+  return Events.Stats.Events - Before;
+}
+
+bool Events_Get(Touch_Event *event)
+{
+  if (!Events.Count)
+    return false;
+  *event = Events.Queue[Events.Head];
+  Events.Head = (Events.Head + 1) % EVENTS_QUEUE_SIZE;
+  Events.Count--;
+  return true;
+}
+
+bool Events_Wait(Touch_Event *event, uint32_t timeoutUs)
+{
+  uint32_t Start = HAL_TimeUs();
+
+  while (!Events_Get(event))
+  {
+    if (HAL_TimeUs() - Start >= timeoutUs)
+      return false;
+    if (!Events_Poll())
+      HAL_DelayUs(EVENTS_POLL_US);
+  }
+  return true;
+}
+
+void Events_GetStats(Events_Stats *stats)
+{
+  *stats = Events.Stats;
+}
+
+void Events_ResetStats(void)
+{
+  memset(&Events.Stats, 0, sizeof(Events.Stats));
+}
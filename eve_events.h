@@ -0,0 +1,87 @@
+#ifndef __EVE_EVENTS_H
+#define __EVE_EVENTS_H
+
+// Interrupt driven touch events
+//
+// Reading REG_TOUCH_TAG in a loop keeps the SPI link busy all the time, even when nobody touches
+// the screen.  Here EVE raises interrupt flags for touches and tag changes instead, and
+// Events_Poll() only reads REG_INT_FLAGS - a single byte.  The touch registers are read, in one
+// burst, only when a flag is set, and the changes found turn into timestamped events in a
+// queue.  Where the platform has EVE's INT_N line wired up, Events_SetIntLine() lets Events_Poll
+// skip even the flag read while the line is inactive.
+//
+//   Events_Init(EVENTS_DEFAULT_MASK);
+//   while (1)
+//   {
+//     Touch_Event Event;
+//     if (Events_Wait(&Event, 100000))
+//       Handle(&Event);
+//   }
+//
+// REG_INT_FLAGS is cleared by reading it, so nothing else should read it while events are in
+// use.
+
+#include "eve.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// INT_CONVCOMPLETE can be added to follow a touch at every conversion, at the cost of a touch
+// register burst that often
+#define EVENTS_DEFAULT_MASK (INT_TOUCH | INT_TAG)
+#define EVENTS_QUEUE_SIZE 64 // Events kept until Events_Get, the oldest are dropped beyond that
+#define EVENTS_POLL_US 5000  // REG_INT_FLAGS read rate of Events_Wait
+
+// Touch_Event types
+#define EVENT_DOWN 1 // Touch started at X, Y on Tag
+#define EVENT_MOVE 2 // Touch moved to X, Y
+#define EVENT_UP 3   // Touch ended, X and Y are where it was last seen
+#define EVENT_TAG 4  // The tag under the touch changed to Tag
+
+  typedef struct
+  {
+    uint32_t Time; // HAL_TimeUs() when the change was seen
+    uint8_t Type;  // EVENT_*
+    uint8_t Tag;
+    int16_t X;
+    int16_t Y;
+  } Touch_Event;
+
+  typedef struct
+  {
+    uint32_t Polls;   // Events_Poll calls
+    uint32_t Flags;   // REG_INT_FLAGS reads
+    uint32_t Bursts;  // Touch register bursts
+    uint32_t Events;  // Events queued
+    uint32_t Dropped; // Events lost because the queue was full
+  } Events_Stats;
+
+  // Enable the EVE interrupts in mask (INT_*) and start with an empty queue
+  void EVE_EXPORT Events_Init(uint8_t mask);
+
+  // Turn the interrupts off again
+  void EVE_EXPORT Events_Stop(void);
+
+  // Report whether EVE's INT_N line is active, for platforms that have it wired up.  NULL goes
+  // back to reading REG_INT_FLAGS on every poll.
+  void EVE_EXPORT Events_SetIntLine(bool (*pending)(void));
+
+  // Check for interrupts and queue the resulting events.  Returns the number of events queued.
+  uint32_t EVE_EXPORT Events_Poll(void);
+
+  // Take the oldest event from the queue, false if it is empty
+  bool EVE_EXPORT Events_Get(Touch_Event *event);
+
+  // Events_Get, polling every EVENTS_POLL_US for at most timeoutUs while the queue is empty
+  bool EVE_EXPORT Events_Wait(Touch_Event *event, uint32_t timeoutUs);
+
+  void EVE_EXPORT Events_GetStats(Events_Stats *stats);
+  void EVE_EXPORT Events_ResetStats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,267 @@
+// Sector-diffing flash programming - see eve_flash.h
+
+#include "eve_flash.h"
+#include "eve.h"
+#include "hw_api.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define Log printf
+
+// Sectors checked per coprocessor round trip.  Each takes 32 bytes of commands and the CRCs are
+// read back from the command FIFO, so a batch has to fit in it with room to spare.
+#define FLASH_CRC_BATCH 64
+#define FLASH_CRC_CMD_SIZE 32
+
+#define FLASH_MANIFEST_MAGIC 0x46455645UL // "EVEF"
+
+static uint32_t CrcTable[256];
+
+static void Put32(uint8_t *buff, uint32_t value)
+{
+  buff[0] = (uint8_t)value;
+  buff[1] = (uint8_t)(value >> 8);
+  buff[2] = (uint8_t)(value >> 16);
+  buff[3] = (uint8_t)(value >> 24);
+}
+
+static uint32_t Get32(const uint8_t *buff)
+{
+  return buff[0] | ((uint32_t)buff[1] << 8) | ((uint32_t)buff[2] << 16) |
+         ((uint32_t)buff[3] << 24);
+}
+
+uint32_t Flash_Crc32(uint32_t crc, const uint8_t *buff, uint32_t count)
+{
+  uint32_t Index, Bit, Value;
+
+  if (!CrcTable[1])
+  {
+    for (Index = 0; Index < 256; Index++)
+    {
+      Value = Index;
+      for (Bit = 0; Bit < 8; Bit++)
+        Value = (Value & 1) ? (Value >> 1) ^ 0xEDB88320UL : Value >> 1;
+      CrcTable[Index] = Value;
+    }
+  }
+
+  crc = ~crc;
+  while (count--)
+    crc = CrcTable[(crc ^ *buff++) & 0xFF] ^ (crc >> 8);
+  return ~crc;
+}
+
+// Data of one sector of the image - a partial last sector is copied and padded into spare
+static const uint8_t *SectorData(const uint8_t *image,
+                                 uint32_t size,
+                                 uint32_t sector,
+                                 uint8_t *spare)
+{
+  uint32_t Offset = sector * FLASH_SECTOR_SIZE;
+
+  if (Offset + FLASH_SECTOR_SIZE <= size)
+    return image + Offset;
+
+  memset(spare, 0xFF, FLASH_SECTOR_SIZE);
+  memcpy(spare, image + Offset, size - Offset);
+  return spare;
+}
+
+void Flash_ImageCrcs(const uint8_t *image, uint32_t size, uint32_t *crcs)
+{
+  uint8_t Spare[FLASH_SECTOR_SIZE];
+  uint32_t Sectors = (size + FLASH_SECTOR_SIZE - 1) / FLASH_SECTOR_SIZE, Sector;
+
+  for (Sector = 0; Sector < Sectors; Sector++)
+    crcs[Sector] = Flash_Crc32(0, SectorData(image, size, Sector, Spare), FLASH_SECTOR_SIZE);
+}
+
+bool Flash_DeviceCrcs(uint32_t flashAddress,
+                      uint32_t sectors,
+                      uint32_t stagingAddress,
+                      uint32_t *crcs)
+{
+  uint8_t Cmds[FLASH_CRC_BATCH * FLASH_CRC_CMD_SIZE];
+  uint8_t Fifo[FT_CMD_FIFO_SIZE];
+  uint8_t *Cmd;
+  uint32_t Done = 0, Batch, Index;
+  uint16_t Start;
+
+  if ((flashAddress & 63) || (stagingAddress & 3))
+    return false;
+  if (rd8(REG_FLASH_STATUS + RAM_REG) != FLASH_STATUS_FULL)
+  {
+    Log("Flash: not in full speed mode\n");
+    return false;
+  }
+
+  while (Done < sectors)
+  {
+    Batch = sectors - Done;
+    if (Batch > FLASH_CRC_BATCH)
+      Batch = FLASH_CRC_BATCH;
+
+    // Copy each sector to RAM_G and let EVE checksum it there
+    for (Index = 0; Index < Batch; Index++)
+    {
+      Cmd = Cmds + Index * FLASH_CRC_CMD_SIZE;
+      Put32(Cmd, CMD_FLASHREAD);
+      Put32(Cmd + 4, stagingAddress);
+      Put32(Cmd + 8, flashAddress + (Done + Index) * FLASH_SECTOR_SIZE);
+      Put32(Cmd + 12, FLASH_SECTOR_SIZE);
+      Put32(Cmd + 16, CMD_MEMCRC);
+      Put32(Cmd + 20, stagingAddress);
+      Put32(Cmd + 24, FLASH_SECTOR_SIZE);
+      Put32(Cmd + 28, 0); // Replaced by the result
+    }
+    Start = FifoWriteLocation;
+    CoProWrCmdBuf(Cmds, Batch * FLASH_CRC_CMD_SIZE);
+    Wait4CoProFIFOEmpty();
+
+    // Pick all the results out of one read of the FIFO
+    rdN(RAM_CMD, Fifo, FT_CMD_FIFO_SIZE);
+    for (Index = 0; Index < Batch; Index++)
+      crcs[Done + Index] = Get32(
+          Fifo + (Start + Index * FLASH_CRC_CMD_SIZE + FLASH_CRC_CMD_SIZE - 4) % FT_CMD_FIFO_SIZE);
+    Done += Batch;
+  }
+  return true;
+}
+
+bool Flash_Program(uint32_t flashAddress,
+                   const uint8_t *image,
+                   uint32_t size,
+                   const uint32_t *deviceCrcs,
+                   uint32_t stagingAddress,
+                   Flash_Stats *stats)
+{
+  uint8_t Spare[FLASH_SECTOR_SIZE];
+  uint32_t Sectors = (size + FLASH_SECTOR_SIZE - 1) / FLASH_SECTOR_SIZE, Sector, Crc;
+  uint32_t *ImageCrcs, *ReadCrcs = NULL;
+  uint16_t BufferDone[2];
+  bool BufferBusy[2] = {false, false};
+  uint8_t *Changed;
+  uint8_t Buffer = 0;
+  Flash_Stats Stats = {0, 0, 0, 0};
+  bool Result = false;
+
+  if ((flashAddress % FLASH_SECTOR_SIZE) || (stagingAddress & 3))
+    return false;
+
+  ImageCrcs = (uint32_t *)malloc(Sectors * sizeof(uint32_t));
+  Changed = (uint8_t *)calloc(Sectors ? Sectors : 1, 1);
+  if (!ImageCrcs || !Changed)
+    goto done;
+  Flash_ImageCrcs(image, size, ImageCrcs);
+  Stats.Sectors = Sectors;
+
+  if (!deviceCrcs)
+  {
+    ReadCrcs = (uint32_t *)malloc(Sectors * sizeof(uint32_t));
+    if (!ReadCrcs || !Flash_DeviceCrcs(flashAddress, Sectors, stagingAddress, ReadCrcs))
+      goto done;
+    deviceCrcs = ReadCrcs;
+  }
+
+  for (Sector = 0; Sector < Sectors; Sector++)
+  {
+    if (ImageCrcs[Sector] == deviceCrcs[Sector])
+      continue;
+
+    // The buffer was handed to the CMD_FLASHUPDATE two sectors back, which may still run.  The
+    // other buffer is being programmed right now while this one gets the next sector.
+    while (BufferBusy[Buffer] && !CoProFIFO_Passed(BufferDone[Buffer]))
+      ;
+    wrN(stagingAddress + Buffer * FLASH_SECTOR_SIZE,
+        SectorData(image, size, Sector, Spare),
+        FLASH_SECTOR_SIZE);
+    Cmd_FlashUpdate(flashAddress + Sector * FLASH_SECTOR_SIZE,
+                    stagingAddress + Buffer * FLASH_SECTOR_SIZE,
+                    FLASH_SECTOR_SIZE);
+    UpdateFIFO();
+    BufferDone[Buffer] = FifoWriteLocation;
+    BufferBusy[Buffer] = true;
+    Buffer ^= 1;
+
+    Changed[Sector] = 1;
+    Stats.Changed++;
+    Stats.BytesSent += FLASH_SECTOR_SIZE;
+  }
+  Wait4CoProFIFOEmpty();
+
+  // Check what was written
+  for (Sector = 0; Sector < Sectors; Sector++)
+  {
+    if (!Changed[Sector])
+      continue;
+    if (!Flash_DeviceCrcs(flashAddress + Sector * FLASH_SECTOR_SIZE, 1, stagingAddress, &Crc) ||
+        (Crc != ImageCrcs[Sector]))
+    {
+      Log("Flash: verify failed at 0x%06X\n",
+          (unsigned)(flashAddress + Sector * FLASH_SECTOR_SIZE));
+      Stats.VerifyErrors++;
+    }
+  }
+  Result = !Stats.VerifyErrors;
+
+done:
+  free(ImageCrcs);
+  free(ReadCrcs);
+  free(Changed);
+  if (stats)
+    *stats = Stats;
+  return Result;
+}
+
+bool Flash_SaveManifest(const char *fileName, const uint32_t *crcs, uint32_t sectors)
+{
+  uint8_t Word[4];
+  uint32_t Sector;
+  bool Result;
+  FILE *File = fopen(fileName, "wb");
+
+  if (!File)
+    return false;
+
+  Put32(Word, FLASH_MANIFEST_MAGIC);
+  Result = fwrite(Word, 4, 1, File) == 1;
+  Put32(Word, sectors);
+  Result = Result && (fwrite(Word, 4, 1, File) == 1);
+  for (Sector = 0; Result && (Sector < sectors); Sector++)
+  {
+    Put32(Word, crcs[Sector]);
+    Result = fwrite(Word, 4, 1, File) == 1;
+  }
+  return (fclose(File) == 0) && Result;
+}
+
+uint32_t Flash_LoadManifest(const char *fileName, uint32_t *crcs, uint32_t maxSectors)
+{
+  uint8_t Word[4];
+  uint32_t Sectors, Sector;
+  FILE *File = fopen(fileName, "rb");
+
+  if (!File)
+    return 0;
+
+  if ((fread(Word, 4, 1, File) != 1) || (Get32(Word) != FLASH_MANIFEST_MAGIC) ||
+      (fread(Word, 4, 1, File) != 1))
+  {
+    fclose(File);
+    return 0;
+  }
+  Sectors = Get32(Word);
+  if (Sectors > maxSectors)
+    Sectors = maxSectors;
+  for (Sector = 0; Sector < Sectors; Sector++)
+  {
+    if (fread(Word, 4, 1, File) != 1)
+      break;
+    crcs[Sector] = Get32(Word);
+  }
+  fclose(File);
+  return Sector;
+}
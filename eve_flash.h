@@ -0,0 +1,70 @@
+#ifndef __EVE_FLASH_H
+#define __EVE_FLASH_H
+
+// Sector-diffing flash programming
+//
+// Reflashing a whole asset image over a USB bridge takes minutes, while usually only a few
+// sectors changed.  The image is compared to the device sector by sector using CRC-32s - either
+// computed by EVE (CMD_FLASHREAD into RAM_G followed by CMD_MEMCRC, so only 4 bytes per sector
+// travel back) or taken from a manifest saved when the device was last programmed.  Only the
+// sectors that differ are sent.  They go through two staging buffers in RAM_G: while the
+// coprocessor programs one sector with CMD_FLASHUPDATE the next one is uploaded into the other.
+//
+// The flash has to be attached and in full speed mode (FlashAttach / FlashFast) first.
+
+#include "eve.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define FLASH_SECTOR_SIZE 4096UL
+// Two sectors of RAM_G used by default - just below the default media FIFO
+#define FLASH_STAGING_DEFAULT_ADDRESS (RAM_G + 0xF0000UL - 2 * FLASH_SECTOR_SIZE)
+
+  typedef struct
+  {
+    uint32_t Sectors;      // Sectors in the image
+    uint32_t Changed;      // Sectors which differed and were programmed
+    uint32_t BytesSent;    // Image bytes written over the wire
+    uint32_t VerifyErrors; // Programmed sectors whose CRC did not match afterwards
+  } Flash_Stats;
+
+  // CRC-32 as calculated by CMD_MEMCRC.  Start with crc 0; pass the previous result to continue.
+  uint32_t EVE_EXPORT Flash_Crc32(uint32_t crc, const uint8_t *buff, uint32_t count);
+
+  // Host side CRCs of each sector of an image.  A partial last sector is treated as padded with
+  // 0xFF, like erased flash.
+  void EVE_EXPORT Flash_ImageCrcs(const uint8_t *image, uint32_t size, uint32_t *crcs);
+
+  // CRCs of sectors in the device flash, calculated by EVE.  Needs one sector of RAM_G at
+  // stagingAddress.
+  bool EVE_EXPORT Flash_DeviceCrcs(uint32_t flashAddress,
+                                   uint32_t sectors,
+                                   uint32_t stagingAddress,
+                                   uint32_t *crcs);
+
+  // Program an image to flashAddress (sector aligned), writing only the sectors that differ.
+  // deviceCrcs holds the sector CRCs of the device flash when they are known (from a manifest),
+  // with NULL they are read from the device.  Two sectors of RAM_G at stagingAddress are used.
+  // Programmed sectors are verified afterwards.  stats may be NULL.
+  bool EVE_EXPORT Flash_Program(uint32_t flashAddress,
+                                const uint8_t *image,
+                                uint32_t size,
+                                const uint32_t *deviceCrcs,
+                                uint32_t stagingAddress,
+                                Flash_Stats *stats);
+
+  // A manifest is a small host file with the sector CRCs of what was last programmed.  Load
+  // returns the number of sectors read (at most maxSectors), 0 if there is no usable manifest.
+  bool EVE_EXPORT Flash_SaveManifest(const char *fileName,
+                                     const uint32_t *crcs,
+                                     uint32_t sectors);
+  uint32_t EVE_EXPORT Flash_LoadManifest(const char *fileName, uint32_t *crcs, uint32_t maxSectors);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,312 @@
+// Multi-touch gestures for capacitive panels - see eve_gestures.h
+
+#include "eve_gestures.h"
+#include "eve.h"
+#include "hw_api.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define Log printf
+
+#define CTOUCH_FIRST REG_CTOUCH_TOUCH1_XY                 // Lowest register of the burst
+#define CTOUCH_BURST (REG_CTOUCH_TOUCH3_XY + 4 - CTOUCH_FIRST) // Up to the highest one
+#define CTOUCH_NONE 0x8000                                // Coordinate of a slot without contact
+
+#define TRACK_DISTANCE 150 // Pixels a contact may jump between two samples and stay the same
+
+typedef struct
+{
+  Gesture_Contact Contacts[GESTURE_MAX_CONTACTS];
+  uint32_t Count;
+  uint32_t NextId;
+  uint32_t MaxCount;    // Most contacts seen since the panel was last released
+  bool LongPressDone;   // The current single contact was reported already
+  uint32_t PairIds[2];  // Contacts of the current pinch / rotate
+  int32_t PairDistance; // Their distance and angle when they touched down
+  uint16_t PairAngle;
+  int32_t LastScale;
+  int32_t LastAngle;
+  Gesture_Event Queue[GESTURE_QUEUE_SIZE];
+  uint32_t Head;
+  uint32_t Queued;
+} Gestures_State;
+
+static Gestures_State Gestures;
+
+static uint32_t Get32(const uint8_t *buff)
+{
+  return buff[0] | ((uint32_t)buff[1] << 8) | ((uint32_t)buff[2] << 16) |
+         ((uint32_t)buff[3] << 24);
+}
+
+void Gestures_Init(void)
+{
+  memset(&Gestures, 0, sizeof(Gestures));
+  wr8(REG_CTOUCH_EXTEND + RAM_REG, 0); // 0 is extended mode, 1 compatibility mode
+}
+
+void Gestures_Stop(void)
+{
+  wr8(REG_CTOUCH_EXTEND + RAM_REG, 1);
+}
+
+static Gesture_Event *Queue(uint32_t time, uint8_t type, const Gesture_Contact *contact)
+{
+  Gesture_Event *Event;
+
+  if (Gestures.Queued == GESTURE_QUEUE_SIZE)
+  {
+    Gestures.Head = (Gestures.Head + 1) % GESTURE_QUEUE_SIZE; // Full - the oldest goes
+    Gestures.Queued--;
+  }
+  Event = &Gestures.Queue[(Gestures.Head + Gestures.Queued) % GESTURE_QUEUE_SIZE];
+  memset(Event, 0, sizeof(*Event));
+  Event->Time = time;
+  Event->Type = type;
+  Event->Tag = contact->Tag;
+  Event->X = contact->X;
+  Event->Y = contact->Y;
+  Gestures.Queued++;
+  return Event;
+}
+
+static uint32_t Sqrt(uint32_t value)
+{
+  uint32_t Root = 0, Bit = 1UL << 30;
+
+  while (Bit > value)
+    Bit >>= 2;
+  while (Bit)
+  {
+    if (value >= Root + Bit)
+    {
+      value -= Root + Bit;
+      Root = (Root >> 1) + Bit;
+    }
+    else
+      Root >>= 1;
+    Bit >>= 2;
+  }
+  return Root;
+}
+
+// Angle of a vector in EVE units, 65536 per turn.  atan(a) for 0 <= a <= 1 is approximated as
+// a * (pi/4 + 0.273 * (1 - a)), which is good to about a quarter of a degree.
+static uint16_t Angle(int32_t dx, int32_t dy)
+{
+  uint32_t AX = (uint32_t)abs(dx), AY = (uint32_t)abs(dy), Result;
+  int64_t A;
+
+  if (!AX && !AY)
+    return 0;
+  A = ((int64_t)((AY <= AX) ? AY : AX) << 16) / ((AY <= AX) ? AX : AY);
+  Result = (uint32_t)((A * (8192 + ((2847 * (65536 - A)) >> 16))) >> 16);
+  if (AY > AX)
+    Result = 16384 - Result;
+  if (dx < 0)
+    Result = 32768 - Result;
+  if (dy < 0)
+    Result = 65536 - Result;
+  return (uint16_t)Result;
+}
+
+// The contacts EVE reports now, in slot order
+static uint32_t ReadContacts(int16_t *x, int16_t *y, uint8_t *tag)
+{
+  static const uint16_t XY[4] = {
+      REG_CTOUCH_TOUCH_XY, REG_CTOUCH_TOUCH1_XY, REG_CTOUCH_TOUCH2_XY, REG_CTOUCH_TOUCH3_XY};
+  static const uint16_t Tags[5] = {
+      REG_CTOUCH_TAG, REG_CTOUCH_TAG1, REG_CTOUCH_TAG2, REG_CTOUCH_TAG3, REG_CTOUCH_TAG4};
+  uint8_t Regs[CTOUCH_BURST];
+  uint32_t Slot, Count = 0, Value;
+  uint16_t X, Y;
+
+  rdN(CTOUCH_FIRST + RAM_REG, Regs, CTOUCH_BURST);
+  for (Slot = 0; Slot < GESTURE_MAX_CONTACTS; Slot++)
+  {
+    if (Slot < 4)
+    {
+      Value = Get32(Regs + XY[Slot] - CTOUCH_FIRST);
+      X = (uint16_t)(Value >> 16);
+      Y = (uint16_t)Value;
+    }
+    else
+    {
+      X = (uint16_t)Get32(Regs + REG_CTOUCH_TOUCH4_X - CTOUCH_FIRST);
+      Y = (uint16_t)Get32(Regs + REG_CTOUCH_TOUCH4_Y - CTOUCH_FIRST);
+    }
+    if ((X == CTOUCH_NONE) || (Y == CTOUCH_NONE))
+      continue;
+    x[Count] = (int16_t)X;
+    y[Count] = (int16_t)Y;
+    tag[Count] = Regs[Tags[Slot] - CTOUCH_FIRST];
+    Count++;
+  }
+  return Count;
+}
+
+// A contact left the panel - it was a swipe if it was alone, quick and went far enough
+static void Released(uint32_t time, const Gesture_Contact *contact)
+{
+  int32_t DX = contact->X - contact->StartX, DY = contact->Y - contact->StartY;
+  Gesture_Event *Event;
+
+  if ((Gestures.MaxCount != 1) || (time - contact->Start > GESTURE_SWIPE_US) ||
+      ((abs(DX) < GESTURE_SWIPE_MIN) && (abs(DY) < GESTURE_SWIPE_MIN)))
+    return;
+  Event = Queue(time, GESTURE_SWIPE, contact);
+  Event->DX = (int16_t)DX;
+  Event->DY = (int16_t)DY;
+}
+
+// Match the new readings to the tracked contacts, nearest first
+static void Track(uint32_t time,
+                  uint32_t count,
+                  const int16_t *x,
+                  const int16_t *y,
+                  const uint8_t *tag)
+{
+  Gesture_Contact Tracked[GESTURE_MAX_CONTACTS];
+  bool Taken[GESTURE_MAX_CONTACTS] = {false};
+  uint32_t Index, Old, Best, Distance, BestDistance;
+
+  for (Index = 0; Index < count; Index++)
+  {
+    Best = GESTURE_MAX_CONTACTS;
+    BestDistance = TRACK_DISTANCE * TRACK_DISTANCE + 1;
+    for (Old = 0; Old < Gestures.Count; Old++)
+    {
+      if (Taken[Old])
+        continue;
+      Distance = (uint32_t)((x[Index] - Gestures.Contacts[Old].X) *
+                                (x[Index] - Gestures.Contacts[Old].X) +
+                            (y[Index] - Gestures.Contacts[Old].Y) *
+                                (y[Index] - Gestures.Contacts[Old].Y));
+      if (Distance < BestDistance)
+      {
+        Best = Old;
+        BestDistance = Distance;
+      }
+    }
+    if (Best < GESTURE_MAX_CONTACTS)
+    {
+      Tracked[Index] = Gestures.Contacts[Best];
+      Taken[Best] = true;
+    }
+    else
+    {
+      memset(&Tracked[Index], 0, sizeof(Tracked[Index]));
+      Tracked[Index].Id = ++Gestures.NextId;
+      Tracked[Index].Start = time;
+      Tracked[Index].StartX = x[Index];
+      Tracked[Index].StartY = y[Index];
+    }
+    Tracked[Index].X = x[Index];
+    Tracked[Index].Y = y[Index];
+    Tracked[Index].Tag = tag[Index];
+  }
+
+  for (Old = 0; Old < Gestures.Count; Old++)
+  {
+    if (!Taken[Old])
+      Released(time, &Gestures.Contacts[Old]);
+  }
+  memcpy(Gestures.Contacts, Tracked, count * sizeof(Tracked[0]));
+  Gestures.Count = count;
+}
+
+// Pinch and rotate, measured between the two contacts in the order they touched down
+static void TwoContacts(uint32_t time)
+{
+  const Gesture_Contact *A = &Gestures.Contacts[0], *B = &Gestures.Contacts[1], *Swap;
+  int32_t DX, DY, Distance, Scale, Turn;
+  Gesture_Contact Center;
+
+  if (A->Id > B->Id)
+  {
+    Swap = A;
+    A = B;
+    B = Swap;
+  }
+  DX = B->X - A->X;
+  DY = B->Y - A->Y;
+  Center = *A;
+
+  Distance = (int32_t)Sqrt((uint32_t)(DX * DX + DY * DY));
+  if ((Gestures.PairIds[0] != A->Id) || (Gestures.PairIds[1] != B->Id))
+  {
+    Gestures.PairIds[0] = A->Id;
+    Gestures.PairIds[1] = B->Id;
+    Gestures.PairDistance = Distance ? Distance : 1;
+    Gestures.PairAngle = Angle(DX, DY);
+    Gestures.LastScale = 0x10000;
+    Gestures.LastAngle = 0;
+    return;
+  }
+
+  Center.X = (int16_t)((A->X + B->X) / 2);
+  Center.Y = (int16_t)((A->Y + B->Y) / 2);
+  Scale = (int32_t)(((int64_t)Distance << 16) / Gestures.PairDistance);
+  if (abs(Scale - Gestures.LastScale) >= GESTURE_PINCH_STEP)
+  {
+    Gestures.LastScale = Scale;
+    Queue(time, GESTURE_PINCH, &Center)->Value = Scale;
+  }
+  Turn = (int16_t)(Angle(DX, DY) - Gestures.PairAngle); // -32768 .. 32767
+  if (abs(Turn - Gestures.LastAngle) >= GESTURE_ROTATE_STEP)
+  {
+    Gestures.LastAngle = Turn;
+    Queue(time, GESTURE_ROTATE, &Center)->Value = Turn;
+  }
+}
+
+uint32_t Gestures_Sample(void)
+{
+  int16_t X[GESTURE_MAX_CONTACTS], Y[GESTURE_MAX_CONTACTS];
+  uint8_t Tag[GESTURE_MAX_CONTACTS];
+  uint32_t Time = HAL_TimeUs(), Count;
+  const Gesture_Contact *Contact;
+
+  Count = ReadContacts(X, Y, Tag);
+  if (!Gestures.Count)
+  {
+    Gestures.MaxCount = 0;
+    Gestures.LongPressDone = false;
+  }
+  if (Count > Gestures.MaxCount)
+    Gestures.MaxCount = Count;
+  Track(Time, Count, X, Y, Tag);
+
+  Contact = &Gestures.Contacts[0];
+  if ((Count == 1) && (Gestures.MaxCount == 1) && !Gestures.LongPressDone &&
+      (abs(Contact->X - Contact->StartX) <= GESTURE_SLOP) &&
+      (abs(Contact->Y - Contact->StartY) <= GESTURE_SLOP) &&
+      (Time - Contact->Start >= GESTURE_LONG_PRESS_US))
+  {
+    Gestures.LongPressDone = true;
+    Queue(Time, GESTURE_LONG_PRESS, Contact);
+  }
+  if (Count == 2)
+    TwoContacts(Time);
+  else
+    Gestures.PairIds[0] = Gestures.PairIds[1] = 0;
+  return Count;
+}
+
+uint32_t Gestures_Contacts(Gesture_Contact *contacts)
+{
+  memcpy(contacts, Gestures.Contacts, Gestures.Count * sizeof(Gestures.Contacts[0]));
+  return Gestures.Count;
+}
+
+bool Gestures_Get(Gesture_Event *event)
+{
+  if (!Gestures.Queued)
+    return false;
+  *event = Gestures.Queue[Gestures.Head];
+  Gestures.Head = (Gestures.Head + 1) % GESTURE_QUEUE_SIZE;
+  Gestures.Queued--;
+  return true;
+}
@@ -0,0 +1,87 @@
+#ifndef __EVE_GESTURES_H
+#define __EVE_GESTURES_H
+
+// Multi-touch gestures for capacitive panels
+//
+// In extended mode (REG_CTOUCH_EXTEND = 0) the capacitive touch engine reports up to five
+// contacts.  Gestures_Sample() reads all of them, with their tags, in one burst per call and
+// matches them to the contacts of the previous sample, so each finger keeps its Id for as long as
+// it stays on the panel.  The gestures are recognized on the host from the tracked contacts:
+//   - long press: one contact that stays within GESTURE_SLOP for GESTURE_LONG_PRESS_US
+//   - swipe:      one contact that moved at least GESTURE_SWIPE_MIN within GESTURE_SWIPE_US and
+//                 was released
+//   - pinch:      two contacts moving apart or together, Value is the scale since they touched
+//                 down in 16.16 fixed point
+//   - rotate:     two contacts turning around each other, Value is the angle since they touched
+//                 down in EVE units (65536 per full turn, as for CMD_ROTATE)
+//
+// Call Gestures_Sample() once per tick, e.g. once per frame, and take the events with
+// Gestures_Get().
+
+#include "eve.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define GESTURE_MAX_CONTACTS 5
+#define GESTURE_QUEUE_SIZE 32
+
+#define GESTURE_SLOP 10              // Pixels a contact may move and still stand still
+#define GESTURE_LONG_PRESS_US 600000 // Time until a press becomes a long press
+#define GESTURE_SWIPE_MIN 60         // Pixels a swipe has to cover
+#define GESTURE_SWIPE_US 500000      // Time a swipe may take
+#define GESTURE_PINCH_STEP 0x0800    // Scale change (16.16) reported again, 1/32
+#define GESTURE_ROTATE_STEP 0x0200   // Angle change reported again, about 2.8 degrees
+
+// Gesture_Event types
+#define GESTURE_LONG_PRESS 1
+#define GESTURE_SWIPE 2 // DX, DY hold the distance covered
+#define GESTURE_PINCH 3
+#define GESTURE_ROTATE 4
+
+  typedef struct
+  {
+    uint32_t Time;   // HAL_TimeUs() of the sample the gesture was recognized in
+    uint8_t Type;    // GESTURE_*
+    uint8_t Tag;     // Tag under the (first) contact
+    int16_t X;       // Position of the contact, or the center of two
+    int16_t Y;
+    int16_t DX;      // Swipe distance
+    int16_t DY;
+    int32_t Value;   // Pinch scale or rotation angle
+  } Gesture_Event;
+
+  typedef struct
+  {
+    uint32_t Id;    // Stays the same while the finger stays on the panel
+    uint32_t Start; // HAL_TimeUs() of the touch down
+    int16_t X;
+    int16_t Y;
+    int16_t StartX;
+    int16_t StartY;
+    uint8_t Tag;
+  } Gesture_Contact;
+
+  // Switch the touch engine to extended mode and forget all contacts
+  void EVE_EXPORT Gestures_Init(void);
+
+  // Back to compatibility mode, single touch
+  void EVE_EXPORT Gestures_Stop(void);
+
+  // Read all contacts in one burst, track them and queue the gestures found.  Returns the number
+  // of contacts on the panel.
+  uint32_t EVE_EXPORT Gestures_Sample(void);
+
+  // The contacts of the last sample, returns their number
+  uint32_t EVE_EXPORT Gestures_Contacts(Gesture_Contact *contacts);
+
+  // Take the oldest gesture from the queue, false if it is empty
+  bool EVE_EXPORT Gestures_Get(Gesture_Event *event);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
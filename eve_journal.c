@@ -0,0 +1,617 @@
+// Command stream journal - see eve_journal.h
+
+#include "eve_journal.h"
+#include "eve.h"
+#include "eve_upload.h"
+#include "hw_api.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define Log printf
+
+#define SETUP_WORDS 4 // The longest setup command, CMD_SETFONT2 and CMD_SETBITMAP
+#define NO_OPTIONS 0xFF
+
+// What follows the arguments of a command
+#define TAIL_NONE 0
+#define TAIL_STRING 1 // A zero terminated string, with OPT_FORMAT followed by its arguments
+#define TAIL_DATA 2   // Data of as many bytes as argument TailArg says
+#define TAIL_STREAM 3 // Data of unknown length in the next CoProWrCmdBuf block, unless argument
+                      // TailArg has OPT_MEDIAFIFO or OPT_FLASH
+
+// What the next word of the stream is
+#define PARSE_COMMAND 0 // A display list instruction or a coprocessor command
+#define PARSE_ARGS 1
+#define PARSE_STRING 2
+#define PARSE_DATA 3  // Words of data (or OPT_FORMAT arguments) still to come
+#define PARSE_BLOCK 4 // A CoProWrCmdBuf block with the data
+#define PARSE_LOST 5  // Unknown, until the next CMD_DLSTART
+
+typedef struct
+{
+  bool Known;
+  uint8_t Args; // Argument words
+  uint8_t Tail;
+  uint8_t TailArg;
+} Journal_Command;
+
+#define COMMAND(cmd, args, tail, tailArg) [(cmd)&0xFF] = {true, args, tail, tailArg}
+
+// The coprocessor commands of eve.h and their arguments, FT81x / BT81x Series Programmers Guides
+static const Journal_Command Commands[0x60] = {
+    COMMAND(CMD_DLSTART, 0, TAIL_NONE, 0),
+    COMMAND(CMD_SWAP, 0, TAIL_NONE, 0),
+    COMMAND(CMD_INTERRUPT, 1, TAIL_NONE, 0),
+    COMMAND(CMD_BGCOLOR, 1, TAIL_NONE, 0),
+    COMMAND(CMD_FGCOLOR, 1, TAIL_NONE, 0),
+    COMMAND(CMD_GRADIENT, 4, TAIL_NONE, 0),
+    COMMAND(CMD_TEXT, 2, TAIL_STRING, 0),
+    COMMAND(CMD_BUTTON, 3, TAIL_STRING, 0),
+    COMMAND(CMD_KEYS, 3, TAIL_STRING, 0),
+    COMMAND(CMD_PROGRESS, 4, TAIL_NONE, 0),
+    COMMAND(CMD_SLIDER, 4, TAIL_NONE, 0),
+    COMMAND(CMD_SCROLLBAR, 4, TAIL_NONE, 0),
+    COMMAND(CMD_TOGGLE, 3, TAIL_STRING, 0),
+    COMMAND(CMD_GAUGE, 4, TAIL_NONE, 0),
+    COMMAND(CMD_CLOCK, 4, TAIL_NONE, 0),
+    COMMAND(CMD_CALIBRATE, 1, TAIL_NONE, 0),
+    COMMAND(CMD_SPINNER, 2, TAIL_NONE, 0),
+    COMMAND(CMD_STOP, 0, TAIL_NONE, 0),
+    COMMAND(CMD_MEMCRC, 3, TAIL_NONE, 0),
+    COMMAND(CMD_REGREAD, 2, TAIL_NONE, 0),
+    COMMAND(CMD_MEMWRITE, 2, TAIL_DATA, 1),
+    COMMAND(CMD_MEMSET, 3, TAIL_NONE, 0),
+    COMMAND(CMD_MEMZERO, 2, TAIL_NONE, 0),
+    COMMAND(CMD_MEMCPY, 3, TAIL_NONE, 0),
+    COMMAND(CMD_APPEND, 2, TAIL_NONE, 0),
+    COMMAND(CMD_SNAPSHOT, 1, TAIL_NONE, 0),
+    COMMAND(CMD_INFLATE, 1, TAIL_STREAM, NO_OPTIONS),
+    COMMAND(CMD_GETPTR, 1, TAIL_NONE, 0),
+    COMMAND(CMD_LOADIMAGE, 2, TAIL_STREAM, 1),
+    COMMAND(CMD_GETPROPS, 3, TAIL_NONE, 0),
+    COMMAND(CMD_LOADIDENTITY, 0, TAIL_NONE, 0),
+    COMMAND(CMD_TRANSLATE, 2, TAIL_NONE, 0),
+    COMMAND(CMD_SCALE, 2, TAIL_NONE, 0),
+    COMMAND(CMD_ROTATE, 1, TAIL_NONE, 0),
+    COMMAND(CMD_SETMATRIX, 0, TAIL_NONE, 0),
+    COMMAND(CMD_SETFONT, 2, TAIL_NONE, 0),
+    COMMAND(CMD_TRACK, 3, TAIL_NONE, 0),
+    COMMAND(CMD_DIAL, 3, TAIL_NONE, 0),
+    COMMAND(CMD_NUMBER, 3, TAIL_NONE, 0),
+    COMMAND(CMD_SCREENSAVER, 0, TAIL_NONE, 0),
+    COMMAND(CMD_SKETCH, 4, TAIL_NONE, 0),
+    COMMAND(CMD_LOGO, 0, TAIL_NONE, 0),
+    COMMAND(CMD_COLDSTART, 0, TAIL_NONE, 0),
+    COMMAND(CMD_GETMATRIX, 6, TAIL_NONE, 0),
+    COMMAND(CMD_GRADCOLOR, 1, TAIL_NONE, 0),
+    COMMAND(CMD_SETROTATE, 1, TAIL_NONE, 0),
+    COMMAND(CMD_MEDIAFIFO, 2, TAIL_NONE, 0),
+    COMMAND(CMD_PLAYVIDEO, 1, TAIL_STREAM, 0),
+    COMMAND(CMD_SETFONT2, 3, TAIL_NONE, 0),
+    COMMAND(CMD_ROMFONT, 2, TAIL_NONE, 0),
+    COMMAND(CMD_VIDEOSTART, 0, TAIL_NONE, 0),
+    COMMAND(CMD_VIDEOFRAME, 2, TAIL_NONE, 0),
+    COMMAND(CMD_SETBITMAP, 3, TAIL_NONE, 0),
+    COMMAND(CMD_FLASHERASE, 0, TAIL_NONE, 0),
+    COMMAND(CMD_FLASHWRITE, 2, TAIL_DATA, 1),
+    COMMAND(CMD_FLASHREAD, 3, TAIL_NONE, 0),
+    COMMAND(CMD_FLASHUPDATE, 3, TAIL_NONE, 0),
+    COMMAND(CMD_FLASHDETACH, 0, TAIL_NONE, 0),
+    COMMAND(CMD_FLASHATTACH, 0, TAIL_NONE, 0),
+    COMMAND(CMD_FLASHFAST, 1, TAIL_NONE, 0),
+    COMMAND(CMD_FLASHSPIDESEL, 0, TAIL_NONE, 0),
+    COMMAND(CMD_FLASHSPITX, 1, TAIL_DATA, 0),
+    COMMAND(CMD_FLASHSPIRX, 2, TAIL_NONE, 0),
+    COMMAND(CMD_FLASHSOURCE, 1, TAIL_NONE, 0),
+    COMMAND(CMD_CLEARCACHE, 0, TAIL_NONE, 0),
+    COMMAND(CMD_INFLATE2, 2, TAIL_STREAM, 1),
+    COMMAND(CMD_ANIMSTART, 3, TAIL_NONE, 0),
+    COMMAND(CMD_ANIMSTOP, 1, TAIL_NONE, 0),
+    COMMAND(CMD_ANIMXY, 2, TAIL_NONE, 0),
+    COMMAND(CMD_ANIMDRAW, 1, TAIL_NONE, 0),
+    COMMAND(CMD_FLASHAPPENDF, 2, TAIL_NONE, 0),
+    COMMAND(CMD_ANIMFRAME, 3, TAIL_NONE, 0),
+    COMMAND(CMD_VIDEOSTARTF, 0, TAIL_NONE, 0),
+};
+
+typedef struct
+{
+  uint32_t *Words;
+  uint32_t Count;
+  bool Complete; // Up to CMD_SWAP and not cut short
+} Journal_Frame;
+
+typedef struct
+{
+  uint32_t Words[SETUP_WORDS];
+  uint32_t Count;
+  uint32_t Size;
+} Journal_Setup;
+
+typedef struct
+{
+  uint32_t Address;
+  const uint8_t *Data;
+  uint32_t Size;
+} Journal_Blob;
+
+// Where in the stream the journal is - which words are commands and which are arguments
+typedef struct
+{
+  uint8_t Want; // PARSE_
+  const Journal_Command *Command;
+  uint32_t Seen;    // Arguments of the command so far
+  uint32_t Args[4]; // The first of them
+  uint32_t Left;    // Words for PARSE_DATA
+  bool Format;      // The string takes OPT_FORMAT arguments
+  bool InSpec;      // In a conversion of the format string
+  uint32_t SpecLength;
+} Journal_Parser;
+
+typedef struct
+{
+  bool Running;
+  bool Replaying; // Our own words, not to be recorded
+  EVE_Context *Context;
+  Journal_Parser Parser;
+
+  Journal_Frame *Frames;
+  uint32_t FrameCount;
+  uint32_t FrameWords; // Room of each frame
+  uint32_t Newest;     // The last complete frame
+  uint32_t Recording;  // The frame between CMD_DLSTART and CMD_SWAP
+  bool InFrame;
+  bool Overflow;
+
+  Journal_Setup Setup[JOURNAL_SETUP_MAX];
+  uint32_t SetupCount;
+  Journal_Setup Pending; // The setup command coming in, Size 0 when there is none
+
+  Journal_Blob Uploads[JOURNAL_UPLOADS_MAX];
+  uint32_t UploadCount;
+
+  uint8_t *Replay; // Setup and one frame, for the burst
+
+  Journal_Stats Stats;
+} Journal_State;
+
+static Journal_State Journal;
+
+static void Put32(uint8_t *buff, uint32_t value)
+{
+  buff[0] = value;
+  buff[1] = value >> 8;
+  buff[2] = value >> 16;
+  buff[3] = value >> 24;
+}
+
+// Words of the setup commands, 0 for everything else
+static uint32_t SetupSize(uint32_t cmd)
+{
+  switch (cmd)
+  {
+  case CMD_SETFONT:
+  case CMD_ROMFONT:
+    return 3;
+  case CMD_SETFONT2:
+  case CMD_SETBITMAP:
+    return 4;
+  case CMD_SETROTATE:
+    return 2;
+  default:
+    return 0;
+  }
+}
+
+static bool IsFont(uint32_t cmd)
+{
+  return (cmd == CMD_SETFONT) || (cmd == CMD_SETFONT2) || (cmd == CMD_ROMFONT);
+}
+
+// Whether b does what a did, so a is no longer needed
+static bool Replaces(const Journal_Setup *a, const Journal_Setup *b)
+{
+  if (IsFont(a->Words[0]) && IsFont(b->Words[0]))
+    return a->Words[1] == b->Words[1]; // The same font handle
+  if (a->Words[0] != b->Words[0])
+    return false;
+  if (a->Words[0] == CMD_SETBITMAP)
+    return a->Words[1] == b->Words[1]; // The same address
+  return true;
+}
+
+static void AddSetup(const Journal_Setup *setup)
+{
+  uint32_t i;
+
+  for (i = 0; i < Journal.SetupCount; i++)
+  {
+    if (Replaces(&Journal.Setup[i], setup))
+    {
+      Journal.Setup[i] = *setup;
+      return;
+    }
+  }
+  if (Journal.SetupCount < JOURNAL_SETUP_MAX)
+    Journal.Setup[Journal.SetupCount++] = *setup;
+  else
+    Journal.Stats.SetupDropped++;
+}
+
+// The options of a command with a string, for OPT_FORMAT
+static uint32_t StringOptions(const Journal_Parser *parser)
+{
+  if (parser->Command == &Commands[CMD_TEXT & 0xFF])
+    return parser->Args[1] >> 16;
+  if (parser->Command == &Commands[CMD_BUTTON & 0xFF])
+    return parser->Args[2] >> 16;
+  if (parser->Command == &Commands[CMD_TOGGLE & 0xFF])
+    return parser->Args[2] & 0xFFFF;
+  return 0; // CMD_KEYS does not format
+}
+
+// What comes once the arguments are in
+static void AfterArgs(Journal_Parser *parser)
+{
+  const Journal_Command *Command = parser->Command;
+
+  parser->Want = PARSE_COMMAND;
+  switch (Command->Tail)
+  {
+  case TAIL_STRING:
+    parser->Want = PARSE_STRING;
+    parser->Format = (StringOptions(parser) & OPT_FORMAT) != 0;
+    parser->InSpec = false;
+    parser->Left = 0;
+    break;
+  case TAIL_DATA:
+    parser->Left = (parser->Args[Command->TailArg] + 3) / 4;
+    if (parser->Left)
+      parser->Want = PARSE_DATA;
+    break;
+  case TAIL_STREAM:
+    if ((Command->TailArg == NO_OPTIONS) ||
+        !(parser->Args[Command->TailArg] & (OPT_MEDIAFIFO | OPT_FLASH)))
+      parser->Want = PARSE_BLOCK;
+    break;
+  }
+}
+
+// One character of a format string, counting the arguments it takes
+static void FormatChar(Journal_Parser *parser, uint8_t c)
+{
+  if (!parser->InSpec)
+  {
+    parser->InSpec = (c == '%');
+    parser->SpecLength = 0;
+  }
+  else if ((c == '%') && !parser->SpecLength)
+    parser->InSpec = false; // %%
+  else if (c == '*')
+  {
+    parser->Left++; // Width or precision as an argument
+    parser->SpecLength++;
+  }
+  else if (strchr("-+ #0123456789.lh", c))
+    parser->SpecLength++;
+  else
+  {
+    parser->Left++;
+    parser->InSpec = false;
+  }
+}
+
+// Take the next word of the stream, returns whether it starts a command (or is a display list
+// instruction) rather than being part of the one before
+static bool Parse(uint32_t data)
+{
+  Journal_Parser *Parser = &Journal.Parser;
+  uint32_t i;
+
+  switch (Parser->Want)
+  {
+  case PARSE_LOST:
+    if (data != CMD_DLSTART)
+      return false;
+    // A CMD_DLSTART, as good a guess for a command as there is
+    // fall through
+  case PARSE_COMMAND:
+    Parser->Want = PARSE_COMMAND;
+    if ((data >> 8) != 0xFFFFFF)
+      return true; // Display list instruction, no arguments
+    if (((data & 0xFF) >= sizeof(Commands) / sizeof(Commands[0])) || !Commands[data & 0xFF].Known)
+    {
+      Log("Journal: unknown command 0x%08x, lost track until the next CMD_DLSTART\n",
+          (unsigned)data);
+      Parser->Want = PARSE_LOST;
+      Journal.Stats.Unparsed++;
+      return true;
+    }
+    Parser->Command = &Commands[data & 0xFF];
+    Parser->Seen = 0;
+    if (Parser->Command->Args)
+      Parser->Want = PARSE_ARGS;
+    else
+      AfterArgs(Parser);
+    return true;
+  case PARSE_ARGS:
+    if (Parser->Seen < 4)
+      Parser->Args[Parser->Seen] = data;
+    if (++Parser->Seen == Parser->Command->Args)
+      AfterArgs(Parser);
+    return false;
+  case PARSE_STRING:
+    for (i = 0; i < 4; i++, data >>= 8)
+    {
+      if (!(data & 0xFF))
+      {
+        Parser->Want = Parser->Left ? PARSE_DATA : PARSE_COMMAND;
+        break;
+      }
+      if (Parser->Format)
+        FormatChar(Parser, data & 0xFF);
+    }
+    return false;
+  case PARSE_DATA:
+    if (!--Parser->Left)
+      Parser->Want = PARSE_COMMAND;
+    return false;
+  default: // PARSE_BLOCK - data of unknown length word by word, no telling where it ends
+    Log("Journal: data without length, lost track until the next CMD_DLSTART\n");
+    Parser->Want = PARSE_LOST;
+    Journal.Stats.Unparsed++;
+    return false;
+  }
+}
+
+// Keep a word in the frame being recorded
+static void Keep(uint32_t data)
+{
+  Journal_Frame *Frame = &Journal.Frames[Journal.Recording];
+
+  if (Frame->Count < Journal.FrameWords)
+    Frame->Words[Frame->Count++] = data;
+  else
+    Journal.Overflow = true;
+}
+
+static void Record(uint32_t data)
+{
+  Journal_Frame *Frame;
+  bool Command;
+
+  if (Journal.Replaying)
+    return;
+  Command = Parse(data);
+  if (Journal.Parser.Want == PARSE_LOST)
+  {
+    // Commands and arguments can no longer be told apart, drop what was coming in
+    Journal.InFrame = false;
+    Journal.Pending.Size = 0;
+    return;
+  }
+
+  if (Command && !Journal.InFrame && (data == CMD_DLSTART))
+  {
+    // Record over the oldest frame, never over the newest complete one
+    Journal.Recording = (Journal.Newest + 1) % Journal.FrameCount;
+    Frame = &Journal.Frames[Journal.Recording];
+    Frame->Count = 0;
+    Frame->Complete = false;
+    Journal.InFrame = true;
+    Journal.Overflow = false;
+    Journal.Pending.Size = 0;
+  }
+
+  if (Journal.InFrame)
+  {
+    Keep(data);
+    if (Command && (data == CMD_SWAP))
+    {
+      Journal.InFrame = false;
+      if (Journal.Overflow)
+      {
+        Journal.Stats.Overflows++;
+        return;
+      }
+      Frame = &Journal.Frames[Journal.Recording];
+      Frame->Complete = true;
+      Journal.Newest = Journal.Recording;
+      Journal.Stats.Frames++;
+    }
+    return;
+  }
+
+  if (Command)
+  {
+    Journal.Pending.Size = SetupSize(data);
+    Journal.Pending.Count = 0;
+  }
+  if (Journal.Pending.Size)
+  {
+    Journal.Pending.Words[Journal.Pending.Count++] = data;
+    if (Journal.Pending.Count == Journal.Pending.Size)
+    {
+      AddSetup(&Journal.Pending);
+      Journal.Pending.Size = 0;
+    }
+  }
+}
+
+// A block of CoProWrCmdBuf - commands, or the data of the command before
+static void RecordBlock(const uint8_t *buff, uint32_t count)
+{
+  uint32_t i, Word;
+  bool Data;
+
+  if (Journal.Replaying)
+    return;
+  Data = Journal.Parser.Want == PARSE_BLOCK;
+  if (Data)
+    Journal.Parser.Want = PARSE_COMMAND;
+  for (i = 0; i < count; i += 4)
+  {
+    // CoProWrCmdBuf sends whole words, the last one padded
+    Word = buff[i];
+    Word |= (i + 1 < count) ? (uint32_t)buff[i + 1] << 8 : 0;
+    Word |= (i + 2 < count) ? (uint32_t)buff[i + 2] << 16 : 0;
+    Word |= (i + 3 < count) ? (uint32_t)buff[i + 3] << 24 : 0;
+    if (!Data)
+      Record(Word);
+    else if (Journal.InFrame)
+      Keep(Word);
+  }
+}
+
+static void Free(void)
+{
+  uint32_t i;
+
+  for (i = 0; Journal.Frames && (i < Journal.FrameCount); i++)
+    free(Journal.Frames[i].Words);
+  free(Journal.Frames);
+  free(Journal.Replay);
+  Journal.Frames = NULL;
+  Journal.Replay = NULL;
+}
+
+bool Journal_Start(uint32_t frames, uint32_t frameSize)
+{
+  uint32_t i;
+
+  Journal_Stop();
+  memset(&Journal, 0, sizeof(Journal));
+  Journal.FrameCount = frames ? frames : JOURNAL_FRAMES;
+  if (Journal.FrameCount < 2)
+    Journal.FrameCount = 2;
+  Journal.FrameWords = (frameSize ? frameSize : JOURNAL_FRAME_SIZE) / 4;
+  Journal.Newest = Journal.FrameCount - 1;
+
+  Journal.Frames = (Journal_Frame *)calloc(Journal.FrameCount, sizeof(Journal_Frame));
+  Journal.Replay = (uint8_t *)malloc((JOURNAL_SETUP_MAX * SETUP_WORDS + Journal.FrameWords) * 4);
+  for (i = 0; Journal.Frames && (i < Journal.FrameCount); i++)
+  {
+    Journal.Frames[i].Words = (uint32_t *)malloc(Journal.FrameWords * 4);
+    if (!Journal.Frames[i].Words)
+      break;
+  }
+  if (!Journal.Frames || !Journal.Replay || (i < Journal.FrameCount))
+  {
+    Log("Journal: out of memory\n");
+    Free();
+    return false;
+  }
+
+  Journal.Context = EVE_GetContext();
+  Journal.Running = true;
+  EVE_SetCmdHook(Record, RecordBlock);
+  return true;
+}
+
+void Journal_Stop(void)
+{
+  if (!Journal.Running)
+    return;
+  // Of the context it was started on, which may not be ours
+  Journal.Context->CmdHook = NULL;
+  Journal.Context->BlockHook = NULL;
+  Free();
+  Journal.Running = false;
+}
+
+uint32_t Journal_Upload(uint32_t Add, const uint8_t *buff, uint32_t count)
+{
+  Journal_Blob Blob = {Add, buff, count};
+  uint32_t i;
+
+  if (Journal.Running)
+  {
+    for (i = 0; (i < Journal.UploadCount) && (Journal.Uploads[i].Address != Add); i++)
+      ;
+    if (i < JOURNAL_UPLOADS_MAX)
+    {
+      Journal.Uploads[i] = Blob;
+      if (i == Journal.UploadCount)
+        Journal.UploadCount++;
+    }
+    else
+      Log("Journal: too many uploads, 0x%06x is not kept\n", (unsigned)Add);
+  }
+  return UploadBlockRAM(Add, buff, count);
+}
+
+// The setup and a frame in one block for CoProWrCmdBuf, returns its size in bytes
+static uint32_t Assemble(const Journal_Frame *frame)
+{
+  uint8_t *Out = Journal.Replay;
+  uint32_t i, j;
+
+  for (i = 0; i < Journal.SetupCount; i++)
+    for (j = 0; j < Journal.Setup[i].Size; j++, Out += 4)
+      Put32(Out, Journal.Setup[i].Words[j]);
+  for (i = 0; i < frame->Count; i++, Out += 4)
+    Put32(Out, frame->Words[i]);
+  return (uint32_t)(Out - Journal.Replay);
+}
+
+bool Journal_Replay(bool ramLost)
+{
+  uint32_t Start = HAL_TimeUs(), Back, Index, Size, i;
+  int Result;
+
+  if (!Journal.Running)
+    return false;
+  Journal.InFrame = false; // What was being recorded never made it
+  Journal.Pending.Size = 0;
+  Journal.Parser.Want = PARSE_COMMAND; // The FIFO starts afresh as well
+
+  if (ramLost)
+    for (i = 0; i < Journal.UploadCount; i++)
+      UploadBlockRAM(Journal.Uploads[i].Address, Journal.Uploads[i].Data, Journal.Uploads[i].Size);
+
+  for (Back = 0; Back < Journal.FrameCount; Back++)
+  {
+    Index = (Journal.Newest + Journal.FrameCount - Back) % Journal.FrameCount;
+    if (!Journal.Frames[Index].Complete)
+      continue;
+    Size = Assemble(&Journal.Frames[Index]);
+    Journal.Replaying = true;
+    CoProWrCmdBuf(Journal.Replay, Size);
+    Journal.Replaying = false;
+    Result = CoProFIFO_WaitEmpty();
+    if (Result == COPRO_OK)
+    {
+      Journal.Newest = Index;
+      Journal.Stats.Replays++;
+      Journal.Stats.ReplayBytes = Size;
+      Journal.Stats.ReplayUs = HAL_TimeUs() - Start;
+      return true;
+    }
+    Journal.Frames[Index].Complete = false; // It faults, don't try it again
+    if (Result == COPRO_STUCK)
+      break;
+  }
+  Journal.Stats.Failed++;
+  return false;
+}
+
+int Journal_Reconnect(uint32_t timeoutUs)
+{
+  int Result = EVE_Reconnect(timeoutUs);
+
+  if (Result && !Journal_Replay(Result == RECONNECT_COLD))
+    Log("Journal: reconnected, but the screen could not be restored\n");
+  return Result;
+}
+
+void Journal_GetStats(Journal_Stats *stats)
+{
+  *stats = Journal.Stats;
+}
+
+void Journal_ResetStats(void)
+{
+  memset(&Journal.Stats, 0, sizeof(Journal.Stats));
+}
@@ -0,0 +1,90 @@
+#ifndef __EVE_JOURNAL_H
+#define __EVE_JOURNAL_H
+
+// Command stream journal
+//
+// A coprocessor fault (see CoPro_Recover) empties the FIFO, and a bridge that went away leaves an
+// EVE that has to be reset; either way the screen is gone and the application would have to
+// build it up again.  While the journal runs it keeps on the host what it takes to bring the
+// screen back:
+//
+//  - the last frames, every word queued from CMD_DLSTART up to CMD_SWAP - with Send_CMD, eve.hpp
+//    or eve_batch.h, including the data of uploads through the FIFO (CMD_INFLATE and the like)
+//  - the setup the coprocessor forgets in a reset, CMD_SETFONT, CMD_SETFONT2, CMD_ROMFONT,
+//    CMD_SETBITMAP and CMD_SETROTATE sent outside of a frame, only the latest one per font
+//    handle, bitmap address or rotation
+//  - uploads into RAM_G made with Journal_Upload, by reference - the journal keeps a pointer to
+//    the data, not a copy, so it has to stay valid
+//
+// Journal_Replay() sends the setup and the newest frame to the coprocessor as one burst, which
+// brings the screen back within a single frame time.  Should that frame fault again (it may well
+// be the one that caused the fault) the one before it is tried, and so on.
+//
+// When the bridge goes away instead, Journal_Reconnect() opens it again and replays what is
+// needed - after a warm attach the frame, after EVE had to be reset the uploads as well.
+//
+//   Journal_Start(JOURNAL_FRAMES, JOURNAL_FRAME_SIZE);
+//   ...
+//   switch (CoProFIFO_WaitEmpty())
+//   {
+//   case COPRO_RECOVERED:
+//     Journal_Replay(false);
+//     break;
+//   case COPRO_LOST:
+//     Journal_Reconnect(1000000);
+//     break;
+//   }
+//
+// Frames and setup are told apart by the command words.  The journal counts the arguments of each
+// command (and the string, format arguments or data after it) to know which words are commands, so
+// an argument that reads as CMD_SWAP does not end a frame.  A command it does not know, or data of
+// unknown length sent word by word, loses track: the frame being recorded is dropped, counted in
+// Unparsed, and recording picks up again at the next CMD_DLSTART.
+// The journal follows the commands of the context that was current at Journal_Start.
+
+#include "eve.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define JOURNAL_FRAMES 2         // Default number of frames kept, at least 2
+#define JOURNAL_FRAME_SIZE 16384 // Default bytes kept per frame, larger frames are not kept
+#define JOURNAL_SETUP_MAX 64     // Setup commands kept
+#define JOURNAL_UPLOADS_MAX 32   // Uploads kept
+
+  typedef struct
+  {
+    uint32_t Frames;       // Frames kept
+    uint32_t Overflows;    // Frames too large for JOURNAL_FRAME_SIZE
+    uint32_t SetupDropped; // Setup commands beyond JOURNAL_SETUP_MAX
+    uint32_t Unparsed;     // Times the journal lost track of the commands, see above
+    uint32_t Replays;      // Successful replays
+    uint32_t Failed;       // Replays that found no frame the coprocessor would take
+    uint32_t ReplayBytes;  // Command bytes of the last replay
+    uint32_t ReplayUs;     // Time the last replay took, uploads included
+  } Journal_Stats;
+
+  // Start keeping frames of up to frameSize bytes, 0 for the defaults
+  bool EVE_EXPORT Journal_Start(uint32_t frames, uint32_t frameSize);
+  void EVE_EXPORT Journal_Stop(void);
+
+  // UploadBlockRAM, remembering where the data went for a replay with ramLost
+  uint32_t EVE_EXPORT Journal_Upload(uint32_t Add, const uint8_t *buff, uint32_t count);
+
+  // Bring the screen back.  ramLost after EVE was reset, which redoes the uploads first.
+  // Returns false if none of the frames kept came through without a fault.
+  bool EVE_EXPORT Journal_Replay(bool ramLost);
+
+  // EVE_Reconnect and the replay that goes with it, returns as EVE_Reconnect
+  int EVE_EXPORT Journal_Reconnect(uint32_t timeoutUs);
+
+  void EVE_EXPORT Journal_GetStats(Journal_Stats *stats);
+  void EVE_EXPORT Journal_ResetStats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
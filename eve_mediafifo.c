@@ -0,0 +1,196 @@
+// Media FIFO streaming - see eve_mediafifo.h
+
+#include "eve_mediafifo.h"
+#include "eve.h"
+#include "hw_api.h"
+#include <stdint.h>
+#include <string.h>
+
+typedef struct
+{
+  uint32_t Address;        // Start of the ring in RAM_G
+  uint32_t Size;           // Size of the ring, 0 when no media FIFO is set up
+  uint32_t WriteLocation;  // Our write offset into the ring - mirrors REG_MEDIAFIFO_WRITE
+  const uint8_t *Pending;  // Data of a load started with MediaFifo_LoadImageStart
+  uint32_t PendingCount;   // Bytes of it not yet written
+  uint16_t PendingCmdDone; // Value of REG_CMD_READ once the coprocessor has finished the load
+  bool Busy;
+  bool Failed;     // The coprocessor faulted (or the bridge went away) during the last load
+  uint32_t Faults; // EVE_Fault.Faults when the ring was set up
+} MediaFifo_State;
+
+static MediaFifo_State MediaFifo;
+
+// The coprocessor reset of CoPro_Recover forgets the ring, so forget it here as well.  A load
+// that was running then has failed.
+static void Forget(void)
+{
+  if (!MediaFifo.Size || (EVE_GetContext()->Fault.Faults == MediaFifo.Faults))
+    return;
+  if (MediaFifo.Busy)
+    MediaFifo.Failed = true;
+  MediaFifo.Size = 0;
+  MediaFifo.Busy = false;
+}
+
+// Whether the coprocessor will never make room again - it faulted, see CoPro_Recover, or the
+// bridge is gone.  Only asked when the ring is full, so it costs nothing while data flows.
+static bool Stalled(void)
+{
+  return (rd16(REG_CMD_READ + RAM_REG) == 0xFFF) || EVE_Lost();
+}
+
+bool MediaFifo_Init(uint32_t address, uint32_t size)
+{
+  if ((address & 3) || (size & 3) || (size < 8))
+    return false;
+
+  Cmd_MediaFifo(address, size);
+  UpdateFIFO();
+  Wait4CoProFIFOEmpty();
+
+  MediaFifo.Address = address;
+  MediaFifo.Size = size;
+  MediaFifo.WriteLocation = rd32(REG_MEDIAFIFO_WRITE + RAM_REG);
+  MediaFifo.Busy = false;
+  MediaFifo.Faults = EVE_GetContext()->Fault.Faults;
+  return true;
+}
+
+bool MediaFifo_Active(void)
+{
+  Forget();
+  return MediaFifo.Size != 0;
+}
+
+void MediaFifo_Close(void)
+{
+  MediaFifo.Size = 0;
+  MediaFifo.Busy = false;
+}
+
+bool MediaFifo_Busy(void)
+{
+  Forget();
+  return MediaFifo.Busy;
+}
+
+uint32_t MediaFifo_FreeSpace(void)
+{
+  uint32_t ReadLocation = rd32(REG_MEDIAFIFO_READ + RAM_REG);
+
+  // Same rule as the command FIFO - one word stays unused so full and empty can be told apart
+  return (ReadLocation + MediaFifo.Size - MediaFifo.WriteLocation - 4) % MediaFifo.Size;
+}
+
+uint32_t MediaFifo_Write(const uint8_t *buff, uint32_t count)
+{
+  uint32_t Room, TransferSize, FirstPart;
+  uint8_t Tail[4] = {0, 0, 0, 0};
+
+  Forget();
+  if (!MediaFifo.Size || !count)
+    return 0;
+
+  Room = MediaFifo_FreeSpace();
+  if (Room < 4)
+    return 0;
+
+  if (count < 4)
+  {
+    // The end of a stream - pad it up to a whole word
+    memcpy(Tail, buff, count);
+    buff = Tail;
+    TransferSize = 4;
+  }
+  else
+  {
+    TransferSize = (count > Room) ? Room : count;
+    TransferSize &= ~3;
+  }
+
+  // The ring wraps, so a transfer running over its end continues at the start
+  FirstPart = MediaFifo.Size - MediaFifo.WriteLocation;
+  if (FirstPart > TransferSize)
+    FirstPart = TransferSize;
+  wrN(MediaFifo.Address + MediaFifo.WriteLocation, buff, FirstPart);
+  if (TransferSize > FirstPart)
+    wrN(MediaFifo.Address, buff + FirstPart, TransferSize - FirstPart);
+
+  MediaFifo.WriteLocation = (MediaFifo.WriteLocation + TransferSize) % MediaFifo.Size;
+  wr32(REG_MEDIAFIFO_WRITE + RAM_REG, MediaFifo.WriteLocation); // Publish the new data
+
+  return (count < 4) ? count : TransferSize;
+}
+
+bool MediaFifo_WriteAll(const uint8_t *buff, uint32_t count)
+{
+  uint32_t Written;
+
+  while (count)
+  {
+    Written = MediaFifo_Write(buff, count);
+    if (!Written && Stalled())
+      return false;
+    buff += Written;
+    count -= Written;
+  }
+  return true;
+}
+
+bool MediaFifo_LoadImage(uint32_t ptr, uint32_t options, const uint8_t *buff, uint32_t count)
+{
+  if (!MediaFifo_LoadImageStart(ptr, options, buff, count))
+    return false;
+  while (MediaFifo_Pump())
+    ;
+  return !MediaFifo.Failed;
+}
+
+bool MediaFifo_LoadImageStart(uint32_t ptr, uint32_t options, const uint8_t *buff, uint32_t count)
+{
+  Forget();
+  if (!MediaFifo.Size || MediaFifo.Busy)
+    return false;
+
+  Cmd_LoadImage(ptr, options | OPT_MEDIAFIFO);
+  UpdateFIFO(); // The command waits in the coprocessor for the data to arrive
+
+  MediaFifo.Pending = buff;
+  MediaFifo.PendingCount = count;
+  MediaFifo.PendingCmdDone = FifoWriteLocation;
+  MediaFifo.Busy = true;
+  MediaFifo.Failed = false;
+  MediaFifo_Pump(); // Get the first part going right away
+  return true;
+}
+
+bool MediaFifo_Pump(void)
+{
+  uint32_t Written;
+
+  Forget();
+  if (!MediaFifo.Busy)
+    return false;
+
+  if (MediaFifo.PendingCount)
+  {
+    Written = MediaFifo_Write(MediaFifo.Pending, MediaFifo.PendingCount);
+    MediaFifo.Pending += Written;
+    MediaFifo.PendingCount -= Written;
+    if (Written || !Stalled())
+      return true;
+  }
+  else if (!Stalled())
+  {
+    // All data handed over - the load is done once the coprocessor has moved past the command
+    if (CoProFIFO_Passed(MediaFifo.PendingCmdDone))
+      MediaFifo.Busy = false;
+    return MediaFifo.Busy;
+  }
+
+  // The load will not finish, give up so the fault can be recovered from
+  MediaFifo.Busy = false;
+  MediaFifo.Failed = true;
+  return false;
+}
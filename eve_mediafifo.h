@@ -0,0 +1,73 @@
+#ifndef __EVE_MEDIAFIFO_H
+#define __EVE_MEDIAFIFO_H
+
+// Media FIFO streaming
+//
+// Pushing a big JPEG/PNG through the 4K command FIFO ties up the FIFO for the whole load.  The
+// media FIFO is a ring buffer in RAM_G which the coprocessor reads streamed data from (commands
+// with OPT_MEDIAFIFO).  The host fills it with burst writes and publishes new data through
+// REG_MEDIAFIFO_WRITE, while REG_MEDIAFIFO_READ tells how far EVE has come.
+//
+// Loads can run blocking (MediaFifo_LoadImage) or be started and then pumped from the normal
+// main loop (MediaFifo_LoadImageStart / MediaFifo_Pump), so the host keeps handling touch and
+// everything else while an image streams in.
+
+#include "eve.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define MEDIAFIFO_DEFAULT_SIZE (64 * 1024UL)
+// Right below 0xF5800, where the PNG decoder of CMD_LOADIMAGE keeps its scratch data up to the
+// end of RAM_G - a ring in there would be overwritten while the image it holds is decoded
+#define MEDIAFIFO_DEFAULT_ADDRESS (RAM_G + 0xF5800UL - MEDIAFIFO_DEFAULT_SIZE)
+
+  // Set up the media FIFO.  Address and size must be multiples of 4.  A coprocessor fault takes
+  // the ring with it (see CoPro_Recover), after one it has to be set up again.
+  bool EVE_EXPORT MediaFifo_Init(uint32_t address, uint32_t size);
+  bool EVE_EXPORT MediaFifo_Active(void);
+
+  // Give up the ring.  The coprocessor keeps its setting, so the RAM_G of the ring must not be
+  // reused while a command with OPT_MEDIAFIFO could still be running.
+  void EVE_EXPORT MediaFifo_Close(void);
+
+  // Whether a load of MediaFifo_LoadImageStart is still running, the ring is taken until it ends
+  bool EVE_EXPORT MediaFifo_Busy(void);
+
+  // Number of bytes which can be written without overwriting unread data
+  uint32_t EVE_EXPORT MediaFifo_FreeSpace(void);
+
+  // Write as much of the data as currently fits and return the number of bytes taken.  Data is
+  // written in whole 32 bit words; a final piece of less than 4 bytes is padded with zeros.
+  uint32_t EVE_EXPORT MediaFifo_Write(const uint8_t *buff, uint32_t count);
+
+  // Write all the data, waiting for EVE to make room as needed.  Returns false if the
+  // coprocessor faulted or the bridge went away before all of it was taken; recover with
+  // CoProFIFO_WaitEmpty() then.
+  bool EVE_EXPORT MediaFifo_WriteAll(const uint8_t *buff, uint32_t count);
+
+  // Load a JPEG/PNG image through the media FIFO and wait until it is decoded.  Returns false
+  // as MediaFifo_WriteAll does.
+  bool EVE_EXPORT MediaFifo_LoadImage(uint32_t ptr,
+                                      uint32_t options,
+                                      const uint8_t *buff,
+                                      uint32_t count);
+
+  // Start loading an image through the media FIFO without waiting.  The data must stay valid
+  // until MediaFifo_Pump() reports the load as finished.
+  bool EVE_EXPORT MediaFifo_LoadImageStart(uint32_t ptr,
+                                           uint32_t options,
+                                           const uint8_t *buff,
+                                           uint32_t count);
+
+  // Feed the pending load with as much data as fits.  Returns true while the load is in progress,
+  // false once it is done or has given up on a coprocessor fault.
+  bool EVE_EXPORT MediaFifo_Pump(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,211 @@
+// Operating system helpers for the host side modules - see eve_os.h
+
+#include "eve_os.h"
+#include <stdlib.h>
+
+#if !defined(_WIN32)
+#include <time.h>
+#include <unistd.h>
+#endif
+
+typedef struct
+{
+  OS_ThreadFunc Func;
+  void *Arg;
+} ThreadStart;
+
+#if defined(_WIN32)
+static DWORD WINAPI ThreadEntry(LPVOID param)
+#else
+static void *ThreadEntry(void *param)
+#endif
+{
+  ThreadStart Start = *(ThreadStart *)param;
+
+  free(param);
+  Start.Func(Start.Arg);
+  return 0;
+}
+
+bool OS_ThreadStart(OS_Thread *thread, OS_ThreadFunc func, void *arg)
+{
+  ThreadStart *Start = (ThreadStart *)malloc(sizeof(ThreadStart));
+
+  if (!Start)
+    return false;
+  Start->Func = func;
+  Start->Arg = arg;
+
+#if defined(_WIN32)
+  *thread = CreateThread(NULL, 0, ThreadEntry, Start, 0, NULL);
+  if (*thread)
+    return true;
+#else
+  if (pthread_create(thread, NULL, ThreadEntry, Start) == 0)
+    return true;
+#endif
+  free(Start);
+  return false;
+}
+
+void OS_ThreadJoin(OS_Thread *thread)
+{
+#if defined(_WIN32)
+  WaitForSingleObject(*thread, INFINITE);
+  CloseHandle(*thread);
+#else
+  pthread_join(*thread, NULL);
+#endif
+}
+
+OS_ThreadId OS_ThreadSelf(void)
+{
+#if defined(_WIN32)
+  return GetCurrentThreadId();
+#else
+  return pthread_self();
+#endif
+}
+
+bool OS_ThreadIsSelf(OS_ThreadId id)
+{
+#if defined(_WIN32)
+  return id == GetCurrentThreadId();
+#else
+  return pthread_equal(id, pthread_self()) != 0;
+#endif
+}
+
+void OS_MutexInit(OS_Mutex *mutex)
+{
+#if defined(_WIN32)
+  InitializeCriticalSection(mutex);
+#else
+  pthread_mutex_init(mutex, NULL);
+#endif
+}
+
+void OS_MutexDestroy(OS_Mutex *mutex)
+{
+#if defined(_WIN32)
+  DeleteCriticalSection(mutex);
+#else
+  pthread_mutex_destroy(mutex);
+#endif
+}
+
+void OS_MutexLock(OS_Mutex *mutex)
+{
+#if defined(_WIN32)
+  EnterCriticalSection(mutex);
+#else
+  pthread_mutex_lock(mutex);
+#endif
+}
+
+void OS_MutexUnlock(OS_Mutex *mutex)
+{
+#if defined(_WIN32)
+  LeaveCriticalSection(mutex);
+#else
+  pthread_mutex_unlock(mutex);
+#endif
+}
+
+void OS_CondInit(OS_Cond *cond)
+{
+#if defined(_WIN32)
+  InitializeConditionVariable(cond);
+#else
+  pthread_cond_init(cond, NULL);
+#endif
+}
+
+void OS_CondDestroy(OS_Cond *cond)
+{
+#if !defined(_WIN32) // Windows condition variables need no cleanup
+  pthread_cond_destroy(cond);
+#endif
+}
+
+void OS_CondWait(OS_Cond *cond, OS_Mutex *mutex)
+{
+#if defined(_WIN32)
+  SleepConditionVariableCS(cond, mutex, INFINITE);
+#else
+  pthread_cond_wait(cond, mutex);
+#endif
+}
+
+void OS_CondBroadcast(OS_Cond *cond)
+{
+#if defined(_WIN32)
+  WakeAllConditionVariable(cond);
+#else
+  pthread_cond_broadcast(cond);
+#endif
+}
+
+uint32_t OS_AtomicLoad(const volatile uint32_t *value)
+{
+#if defined(_WIN32)
+  return (uint32_t)InterlockedCompareExchange((volatile LONG *)value, 0, 0);
+#else
+  return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+#endif
+}
+
+void OS_AtomicStore(volatile uint32_t *value, uint32_t newValue)
+{
+#if defined(_WIN32)
+  InterlockedExchange((volatile LONG *)value, (LONG)newValue);
+#else
+  __atomic_store_n(value, newValue, __ATOMIC_RELEASE);
+#endif
+}
+
+uint32_t OS_AtomicAdd(volatile uint32_t *value, int32_t delta)
+{
+#if defined(_WIN32)
+  return (uint32_t)(InterlockedExchangeAdd((volatile LONG *)value, delta) + delta);
+#else
+  return __atomic_add_fetch(value, (uint32_t)delta, __ATOMIC_SEQ_CST);
+#endif
+}
+
+bool OS_AtomicCompareExchange(volatile uint32_t *value, uint32_t expected, uint32_t newValue)
+{
+#if defined(_WIN32)
+  return (uint32_t)InterlockedCompareExchange(
+             (volatile LONG *)value, (LONG)newValue, (LONG)expected) == expected;
+#else
+  return __atomic_compare_exchange_n(
+      value, &expected, newValue, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#endif
+}
+
+uint64_t OS_TimeUs(void)
+{
+#if defined(_WIN32)
+  LARGE_INTEGER Frequency, Counter;
+
+  QueryPerformanceFrequency(&Frequency);
+  QueryPerformanceCounter(&Counter);
+  return (uint64_t)(Counter.QuadPart / Frequency.QuadPart) * 1000000 +
+         (uint64_t)(Counter.QuadPart % Frequency.QuadPart) * 1000000 / Frequency.QuadPart;
+#else
+  struct timespec Now;
+
+  clock_gettime(CLOCK_MONOTONIC, &Now);
+  return (uint64_t)Now.tv_sec * 1000000 + Now.tv_nsec / 1000;
+#endif
+}
+
+void OS_SleepUs(uint32_t microSeconds)
+{
+#if defined(_WIN32)
+  Sleep((microSeconds + 999) / 1000);
+#else
+  usleep(microSeconds);
+#endif
+}
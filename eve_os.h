@@ -0,0 +1,69 @@
+#ifndef __EVE_OS_H
+#define __EVE_OS_H
+
+// Operating system helpers for the host side modules
+//
+// Threads, locks and a monotonic clock for the parts of the library that only make sense on a
+// host PC talking to EVE through a USB bridge (video streaming and the like).  The core library
+// in eve.c does not use any of this, so it stays usable on bare metal.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#if defined(_WIN32)
+  typedef HANDLE OS_Thread;
+  typedef DWORD OS_ThreadId;
+  typedef CRITICAL_SECTION OS_Mutex;
+  typedef CONDITION_VARIABLE OS_Cond;
+#else
+  typedef pthread_t OS_Thread;
+  typedef pthread_t OS_ThreadId;
+  typedef pthread_mutex_t OS_Mutex;
+  typedef pthread_cond_t OS_Cond;
+#endif
+
+  typedef void (*OS_ThreadFunc)(void *arg);
+
+  bool OS_ThreadStart(OS_Thread *thread, OS_ThreadFunc func, void *arg);
+  void OS_ThreadJoin(OS_Thread *thread);
+  OS_ThreadId OS_ThreadSelf(void);
+  bool OS_ThreadIsSelf(OS_ThreadId id);
+
+  void OS_MutexInit(OS_Mutex *mutex);
+  void OS_MutexDestroy(OS_Mutex *mutex);
+  void OS_MutexLock(OS_Mutex *mutex);
+  void OS_MutexUnlock(OS_Mutex *mutex);
+
+  void OS_CondInit(OS_Cond *cond);
+  void OS_CondDestroy(OS_Cond *cond);
+  void OS_CondWait(OS_Cond *cond, OS_Mutex *mutex);
+  void OS_CondBroadcast(OS_Cond *cond);
+
+  // Loads that see everything stored before the matching OS_AtomicStore, for data handed from
+  // one thread to another without a lock
+  uint32_t OS_AtomicLoad(const volatile uint32_t *value);
+  void OS_AtomicStore(volatile uint32_t *value, uint32_t newValue);
+  // Full barriers, these return the new value and whether value was expected and got replaced
+  uint32_t OS_AtomicAdd(volatile uint32_t *value, int32_t delta);
+  bool OS_AtomicCompareExchange(volatile uint32_t *value, uint32_t expected, uint32_t newValue);
+
+  // Monotonic time in microseconds, the starting point is arbitrary
+  uint64_t OS_TimeUs(void);
+  void OS_SleepUs(uint32_t microSeconds);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,191 @@
+// Touch sampling on a thread of its own - see eve_sampler.h
+
+#include "eve_sampler.h"
+#include "eve.h"
+#include "eve_bus.h"
+#include "eve_os.h"
+#include "hw_api.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define Log printf
+
+#define TOUCH_NONE 0x80008000UL // REG_TOUCH_SCREEN_XY while the panel is not touched
+#define TOUCH_BURST (REG_TOUCH_TAG + 4 - REG_TOUCH_SCREEN_XY) // SCREEN_XY, TAG_XY, TAG
+
+typedef struct
+{
+  OS_Thread Thread;
+  EVE_Context *Context; // Of the thread that started sampling
+  volatile uint32_t Running;
+  uint32_t ActiveUs;
+  uint32_t IdleUs;
+
+  // The queue - Tail is only written by the sampler, Head only by Sampler_Get
+  Sampler_Event Queue[SAMPLER_QUEUE_SIZE];
+  volatile uint32_t Head;
+  volatile uint32_t Tail;
+
+  // Touch as seen by the sampler thread
+  bool Pressed;
+  uint8_t Tag;
+  int16_t X;
+  int16_t Y;
+
+  Sampler_Stats Stats; // Samples to BusWaitMax by the sampler, the rest by Sampler_Get
+} Sampler_State;
+
+static Sampler_State Sampler;
+
+static uint32_t Get32(const uint8_t *buff)
+{
+  return buff[0] | ((uint32_t)buff[1] << 8) | ((uint32_t)buff[2] << 16) |
+         ((uint32_t)buff[3] << 24);
+}
+
+static void Queue(uint8_t type, uint32_t time)
+{
+  uint32_t Tail = Sampler.Tail;
+  Sampler_Event *Event;
+
+  if (Tail - OS_AtomicLoad(&Sampler.Head) == SAMPLER_QUEUE_SIZE)
+  {
+    Sampler.Stats.Dropped++; // Full - only the consumer may take the oldest, so the new one goes
+    return;
+  }
+  Event = &Sampler.Queue[Tail % SAMPLER_QUEUE_SIZE];
+  Event->Time = time;
+  Event->Latency = 0;
+  Event->Type = type;
+  Event->Tag = Sampler.Tag;
+  Event->X = Sampler.X;
+  Event->Y = Sampler.Y;
+  OS_AtomicStore(&Sampler.Tail, Tail + 1);
+  Sampler.Stats.Events++;
+}
+
+// Read the touch registers in one burst and queue what changed, returns whether it is touched
+static bool Sample(void)
+{
+  uint8_t Regs[TOUCH_BURST];
+  uint32_t Start = HAL_TimeUs(), Time, XY;
+  uint8_t Tag;
+  bool Pressed;
+  int16_t X, Y;
+
+  Bus_Lock(true);
+  Time = HAL_TimeUs();
+  rdN(REG_TOUCH_SCREEN_XY + RAM_REG, Regs, TOUCH_BURST);
+  Bus_Unlock();
+  if (Time - Start > Sampler.Stats.BusWaitMax)
+    Sampler.Stats.BusWaitMax = Time - Start;
+  Sampler.Stats.Samples++;
+
+  XY = Get32(Regs);
+  Tag = Regs[REG_TOUCH_TAG - REG_TOUCH_SCREEN_XY];
+  Pressed = XY != TOUCH_NONE;
+  X = (int16_t)(XY >> 16);
+  Y = (int16_t)(XY & 0xFFFF);
+
+  if (Pressed && !Sampler.Pressed)
+  {
+    Sampler.X = X;
+    Sampler.Y = Y;
+    Sampler.Tag = Tag;
+    Queue(EVENT_DOWN, Time);
+  }
+  else if (Pressed && ((X != Sampler.X) || (Y != Sampler.Y)))
+  {
+    Sampler.X = X;
+    Sampler.Y = Y;
+    Queue(EVENT_MOVE, Time);
+  }
+  if (Pressed && (Tag != Sampler.Tag))
+  {
+    Sampler.Tag = Tag;
+    Queue(EVENT_TAG, Time);
+  }
+  if (!Pressed && Sampler.Pressed)
+  {
+    Queue(EVENT_UP, Time);
+    Sampler.Tag = 0;
+  }
+  Sampler.Pressed = Pressed;
+  return Pressed;
+}
+
+static void SamplerThread(void *arg)
+{
+  uint32_t Interval = Sampler.IdleUs, Start, Elapsed;
+
+  (void)arg;
+  EVE_SetContext(Sampler.Context);
+  while (OS_AtomicLoad(&Sampler.Running))
+  {
+    Start = HAL_TimeUs();
+    if (Sample())
+      Interval = Sampler.ActiveUs;
+    else if (Interval < Sampler.IdleUs)
+      Interval = (Interval * 2 < Sampler.IdleUs) ? Interval * 2 : Sampler.IdleUs;
+
+    Elapsed = HAL_TimeUs() - Start;
+    if (Elapsed < Interval)
+      OS_SleepUs(Interval - Elapsed);
+  }
+}
+
+bool Sampler_Start(uint32_t activeUs, uint32_t idleUs)
+{
+  if (OS_AtomicLoad(&Sampler.Running))
+    return true;
+  memset(&Sampler, 0, sizeof(Sampler));
+  Sampler.ActiveUs = activeUs ? activeUs : SAMPLER_ACTIVE_US;
+  Sampler.IdleUs = (idleUs > Sampler.ActiveUs) ? idleUs : Sampler.ActiveUs;
+  Sampler.Context = EVE_GetContext();
+
+  Bus_Init();
+  OS_AtomicStore(&Sampler.Running, 1);
+  if (!OS_ThreadStart(&Sampler.Thread, SamplerThread, NULL))
+  {
+    Log("Sampler: could not start the thread\n");
+    OS_AtomicStore(&Sampler.Running, 0);
+    return false;
+  }
+  return true;
+}
+
+void Sampler_Stop(void)
+{
+  if (!OS_AtomicLoad(&Sampler.Running))
+    return;
+  OS_AtomicStore(&Sampler.Running, 0);
+  OS_ThreadJoin(&Sampler.Thread);
+}
+
+bool Sampler_Get(Sampler_Event *event)
+{
+  uint32_t Head = Sampler.Head;
+
+  if (Head == OS_AtomicLoad(&Sampler.Tail))
+    return false;
+  *event = Sampler.Queue[Head % SAMPLER_QUEUE_SIZE];
+  OS_AtomicStore(&Sampler.Head, Head + 1);
+
+  event->Latency = HAL_TimeUs() - event->Time;
+  Sampler.Stats.Delivered++;
+  Sampler.Stats.LatencySum += event->Latency;
+  if (event->Latency > Sampler.Stats.LatencyMax)
+    Sampler.Stats.LatencyMax = event->Latency;
+  return true;
+}
+
+void Sampler_GetStats(Sampler_Stats *stats)
+{
+  *stats = Sampler.Stats;
+}
+
+void Sampler_ResetStats(void)
+{
+  memset(&Sampler.Stats, 0, sizeof(Sampler.Stats));
+}
@@ -0,0 +1,78 @@
+#ifndef __EVE_SAMPLER_H
+#define __EVE_SAMPLER_H
+
+// Touch sampling on a thread of its own
+//
+// When touch is polled from the render loop, a long upload (CoProWrCmdBuf of an image, say)
+// holds the touch reads back until it is done.  Sampler_Start() runs the touch reads on a thread
+// of their own instead.  It shares the bridge with the renderer through the bus arbiter
+// (eve_bus.h) and locks with priority, so a sample waits for at most one transaction of the
+// upload - wrN and CoProWrCmdBuf split large blocks into transactions of at most 8K.
+//
+// The rate adapts to the panel: while it is touched the touch registers are read every
+// activeUs, once it is released the interval doubles with every sample until it reaches idleUs.
+// The changes found go into a single producer / single consumer queue without locks, to be taken
+// with Sampler_Get() from one thread, normally the render loop.  Sampler_Get() stamps each event
+// with the time from the sample to its delivery, and the statistics keep the worst case, which
+// shows how well touch keeps up under the upload load of the application.
+//
+//   Sampler_Start(SAMPLER_ACTIVE_US, SAMPLER_IDLE_US);
+//   while (1)
+//   {
+//     Sampler_Event Event;
+//     while (Sampler_Get(&Event))
+//       Handle(&Event);
+//     ... draw and upload ...
+//   }
+
+#include "eve.h"
+#include "eve_events.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define SAMPLER_QUEUE_SIZE 128 // Events waiting for Sampler_Get, a power of 2
+#define SAMPLER_ACTIVE_US 2000 // Default interval while the panel is touched
+#define SAMPLER_IDLE_US 20000  // Default interval once it has been released for a while
+
+  // Types are the EVENT_* of eve_events.h
+  typedef struct
+  {
+    uint32_t Time;    // HAL_TimeUs() of the sample
+    uint32_t Latency; // Microseconds from the sample to Sampler_Get
+    uint8_t Type;
+    uint8_t Tag;
+    int16_t X;
+    int16_t Y;
+  } Sampler_Event;
+
+  typedef struct
+  {
+    uint32_t Samples;    // Touch register bursts read
+    uint32_t Events;     // Events queued
+    uint32_t Dropped;    // Events lost because the queue was full
+    uint32_t Delivered;  // Events taken with Sampler_Get
+    uint32_t BusWaitMax; // Longest wait for the bus before a sample, microseconds
+    uint32_t LatencyMax; // Longest time from a sample to Sampler_Get
+    uint64_t LatencySum; // For the average latency, divide by Delivered
+  } Sampler_Stats;
+
+  // Install the bus arbiter and start sampling, false if the thread could not be started
+  bool EVE_EXPORT Sampler_Start(uint32_t activeUs, uint32_t idleUs);
+
+  // Stop sampling and wait for the thread to end, the arbiter stays installed
+  void EVE_EXPORT Sampler_Stop(void);
+
+  // Take the oldest event, false if there is none
+  bool EVE_EXPORT Sampler_Get(Sampler_Event *event);
+
+  void EVE_EXPORT Sampler_GetStats(Sampler_Stats *stats);
+  void EVE_EXPORT Sampler_ResetStats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
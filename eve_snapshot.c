@@ -0,0 +1,308 @@
+// Persistent device state - see eve_snapshot.h
+
+#include "eve_snapshot.h"
+#include "eve.h"
+#include "eve_flash.h"
+#include "eve_upload.h"
+#include "hw_api.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define Log printf
+
+#define SNAPSHOT_HEADER_SIZE 16
+#define SNAPSHOT_TOUCH_SIZE 24                          // REG_TOUCH_TRANSFORM_A - F
+#define SNAPSHOT_PANEL_SIZE (REG_PCLK + 4 - REG_HCYCLE) // REG_HCYCLE - REG_PCLK
+#define SNAPSHOT_READ_SIZE 0x10000UL // MPSSE bridges transfer at most 64K per command
+#define SNAPSHOT_RAM_G_END (RAM_G + 0x100000UL)
+
+// Regions checked per coprocessor round trip.  Each CMD_MEMCRC takes 16 bytes and the CRCs are
+// read back from the command FIFO, so a batch has to fit in it with room to spare.
+#define SNAPSHOT_CRC_BATCH 128
+#define SNAPSHOT_CRC_CMD_SIZE 16
+
+typedef struct
+{
+  uint32_t Address;
+  uint32_t Size;
+} Snapshot_Region;
+
+typedef struct
+{
+  uint32_t Words[SNAPSHOT_MAX_HANDLE_WORDS];
+  uint32_t Count;
+} Snapshot_Handle;
+
+typedef struct
+{
+  Snapshot_Region Regions[SNAPSHOT_MAX_REGIONS];
+  uint32_t RegionCount;
+  Snapshot_Handle Handles[SNAPSHOT_MAX_HANDLES];
+} Snapshot_State;
+
+static Snapshot_State Snapshot;
+
+static void Put32(uint8_t *buff, uint32_t value)
+{
+  buff[0] = (uint8_t)value;
+  buff[1] = (uint8_t)(value >> 8);
+  buff[2] = (uint8_t)(value >> 16);
+  buff[3] = (uint8_t)(value >> 24);
+}
+
+static uint32_t Get32(const uint8_t *buff)
+{
+  return buff[0] | ((uint32_t)buff[1] << 8) | ((uint32_t)buff[2] << 16) |
+         ((uint32_t)buff[3] << 24);
+}
+
+bool Snapshot_AddRegion(uint32_t address, uint32_t size)
+{
+  // Not address + size, which wraps around for a size read from a broken file
+  if ((Snapshot.RegionCount >= SNAPSHOT_MAX_REGIONS) || !size ||
+      (size > SNAPSHOT_RAM_G_END) || (address > SNAPSHOT_RAM_G_END - size))
+    return false;
+  Snapshot.Regions[Snapshot.RegionCount].Address = address;
+  Snapshot.Regions[Snapshot.RegionCount].Size = size;
+  Snapshot.RegionCount++;
+  return true;
+}
+
+bool Snapshot_SetHandle(uint32_t handle, const uint32_t *words, uint32_t count)
+{
+  if ((handle >= SNAPSHOT_MAX_HANDLES) || (count > SNAPSHOT_MAX_HANDLE_WORDS))
+    return false;
+  memcpy(Snapshot.Handles[handle].Words, words, count * 4);
+  Snapshot.Handles[handle].Count = count;
+  return true;
+}
+
+void Snapshot_Clear(void)
+{
+  memset(&Snapshot, 0, sizeof(Snapshot));
+}
+
+static bool WriteWord(FILE *File, uint32_t value)
+{
+  uint8_t Word[4];
+
+  Put32(Word, value);
+  return fwrite(Word, 4, 1, File) == 1;
+}
+
+bool Snapshot_Save(const char *fileName)
+{
+  uint8_t Regs[SNAPSHOT_TOUCH_SIZE + SNAPSHOT_PANEL_SIZE];
+  uint32_t Handles = 0, Index, Word, Done, Size;
+  const Snapshot_Region *Region;
+  uint8_t *Data;
+  bool Result;
+  FILE *File;
+
+  for (Index = 0; Index < SNAPSHOT_MAX_HANDLES; Index++)
+    Handles += Snapshot.Handles[Index].Count ? 1 : 0;
+  File = fopen(fileName, "wb");
+  if (!File)
+    return false;
+
+  Result = WriteWord(File, SNAPSHOT_MAGIC) && WriteWord(File, SNAPSHOT_VERSION) &&
+           WriteWord(File, Handles) && WriteWord(File, Snapshot.RegionCount);
+
+  rdN(REG_TOUCH_TRANSFORM_A + RAM_REG, Regs, SNAPSHOT_TOUCH_SIZE);
+  rdN(REG_HCYCLE + RAM_REG, Regs + SNAPSHOT_TOUCH_SIZE, SNAPSHOT_PANEL_SIZE);
+  Result = Result && (fwrite(Regs, sizeof(Regs), 1, File) == 1);
+
+  for (Index = 0; Result && (Index < SNAPSHOT_MAX_HANDLES); Index++)
+  {
+    if (!Snapshot.Handles[Index].Count)
+      continue;
+    Result = WriteWord(File, Index) && WriteWord(File, Snapshot.Handles[Index].Count);
+    for (Word = 0; Result && (Word < Snapshot.Handles[Index].Count); Word++)
+      Result = WriteWord(File, Snapshot.Handles[Index].Words[Word]);
+  }
+
+  for (Index = 0; Result && (Index < Snapshot.RegionCount); Index++)
+  {
+    Region = &Snapshot.Regions[Index];
+    Data = (uint8_t *)malloc(Region->Size);
+    if (!Data)
+    {
+      Result = false;
+      break;
+    }
+    for (Done = 0; Done < Region->Size; Done += Size)
+    {
+      Size = Region->Size - Done;
+      if (Size > SNAPSHOT_READ_SIZE)
+        Size = SNAPSHOT_READ_SIZE;
+      rdN(Region->Address + Done, Data + Done, Size);
+    }
+    Result = WriteWord(File, Region->Address) && WriteWord(File, Region->Size) &&
+             WriteWord(File, Flash_Crc32(0, Data, Region->Size)) &&
+             (fwrite(Data, Region->Size, 1, File) == 1);
+    free(Data);
+  }
+  return (fclose(File) == 0) && Result;
+}
+
+// Let EVE checksum the regions, a batch of CMD_MEMCRC per round trip
+static void DeviceCrcs(const Snapshot_Region *regions, uint32_t count, uint32_t *crcs)
+{
+  uint8_t Cmds[SNAPSHOT_CRC_BATCH * SNAPSHOT_CRC_CMD_SIZE];
+  uint8_t Fifo[FT_CMD_FIFO_SIZE];
+  uint32_t Done = 0, Batch, Index;
+  uint8_t *Cmd;
+  uint16_t Start;
+
+  while (Done < count)
+  {
+    Batch = count - Done;
+    if (Batch > SNAPSHOT_CRC_BATCH)
+      Batch = SNAPSHOT_CRC_BATCH;
+    for (Index = 0; Index < Batch; Index++)
+    {
+      Cmd = Cmds + Index * SNAPSHOT_CRC_CMD_SIZE;
+      Put32(Cmd, CMD_MEMCRC);
+      Put32(Cmd + 4, regions[Done + Index].Address);
+      Put32(Cmd + 8, regions[Done + Index].Size);
+      Put32(Cmd + 12, 0); // Replaced by the result
+    }
+    Start = FifoWriteLocation;
+    CoProWrCmdBuf(Cmds, Batch * SNAPSHOT_CRC_CMD_SIZE);
+    Wait4CoProFIFOEmpty();
+
+    rdN(RAM_CMD, Fifo, FT_CMD_FIFO_SIZE);
+    for (Index = 0; Index < Batch; Index++)
+      crcs[Done + Index] = Get32(
+          Fifo + (Start + Index * SNAPSHOT_CRC_CMD_SIZE + SNAPSHOT_CRC_CMD_SIZE - 4) %
+                     FT_CMD_FIFO_SIZE);
+    Done += Batch;
+  }
+}
+
+// Check the file and pick up its handles and regions.  data points at the CRC of each region,
+// followed by its content.
+static bool ParseSnapshot(const uint8_t *file, uint32_t size, const uint8_t **data)
+{
+  uint32_t Handles, Regions, Offset, Index, Handle, Count, Word;
+
+  if ((size < SNAPSHOT_HEADER_SIZE + SNAPSHOT_TOUCH_SIZE + SNAPSHOT_PANEL_SIZE) ||
+      (Get32(file) != SNAPSHOT_MAGIC) || (Get32(file + 4) != SNAPSHOT_VERSION))
+    return false;
+  Handles = Get32(file + 8);
+  Regions = Get32(file + 12);
+  if ((Handles > SNAPSHOT_MAX_HANDLES) || (Regions > SNAPSHOT_MAX_REGIONS))
+    return false;
+
+  Snapshot_Clear();
+  Offset = SNAPSHOT_HEADER_SIZE + SNAPSHOT_TOUCH_SIZE + SNAPSHOT_PANEL_SIZE;
+  for (Index = 0; Index < Handles; Index++)
+  {
+    if (Offset + 8 > size)
+      return false;
+    Handle = Get32(file + Offset);
+    Count = Get32(file + Offset + 4);
+    Offset += 8;
+    if ((Handle >= SNAPSHOT_MAX_HANDLES) || (Count > SNAPSHOT_MAX_HANDLE_WORDS) ||
+        (Count * 4 > size - Offset))
+      return false;
+    for (Word = 0; Word < Count; Word++)
+      Snapshot.Handles[Handle].Words[Word] = Get32(file + Offset + Word * 4);
+    Snapshot.Handles[Handle].Count = Count;
+    Offset += Count * 4;
+  }
+  for (Index = 0; Index < Regions; Index++)
+  {
+    if (Offset + 12 > size)
+      return false;
+    if (!Snapshot_AddRegion(Get32(file + Offset), Get32(file + Offset + 4)) ||
+        (Get32(file + Offset + 4) > size - Offset - 12))
+      return false;
+    data[Index] = file + Offset + 8;
+    Offset += 12 + Snapshot.Regions[Index].Size;
+  }
+  return true;
+}
+
+bool Snapshot_Restore(const char *fileName, Snapshot_Stats *stats)
+{
+  const uint8_t *Data[SNAPSHOT_MAX_REGIONS];
+  uint32_t Crcs[SNAPSHOT_MAX_REGIONS];
+  Snapshot_Stats Stats = {0, 0, 0, 0};
+  const uint8_t *Regs;
+  const Snapshot_Region *Region;
+  uint32_t Size, Index, Word;
+  uint8_t *File = NULL;
+  bool Result = false;
+  FILE *Input;
+  long Length;
+
+  Input = fopen(fileName, "rb");
+  if (!Input)
+    return false;
+  if ((fseek(Input, 0, SEEK_END) == 0) && ((Length = ftell(Input)) > 0) &&
+      (fseek(Input, 0, SEEK_SET) == 0))
+  {
+    Size = (uint32_t)Length;
+    File = (uint8_t *)malloc(Size);
+    if (File && (fread(File, Size, 1, Input) != 1))
+    {
+      free(File);
+      File = NULL;
+    }
+  }
+  fclose(Input);
+  if (!File)
+    return false;
+  if (!ParseSnapshot(File, Size, Data))
+  {
+    Log("Snapshot: %s is not a valid snapshot\n", fileName);
+    goto done;
+  }
+
+  // Calibration and panel, leaving out REG_DLSWAP in the middle of the panel registers
+  Regs = File + SNAPSHOT_HEADER_SIZE;
+  wrN(REG_TOUCH_TRANSFORM_A + RAM_REG, Regs, SNAPSHOT_TOUCH_SIZE);
+  Regs += SNAPSHOT_TOUCH_SIZE;
+  wrN(REG_HCYCLE + RAM_REG, Regs, REG_DLSWAP - REG_HCYCLE);
+  wrN(REG_ROTATE + RAM_REG, Regs + REG_ROTATE - REG_HCYCLE, REG_PCLK + 4 - REG_ROTATE);
+  Stats.BytesSent = SNAPSHOT_TOUCH_SIZE + SNAPSHOT_PANEL_SIZE - 4;
+
+  // Only the regions EVE does not hold any more go over the wire again
+  DeviceCrcs(Snapshot.Regions, Snapshot.RegionCount, Crcs);
+  Stats.Regions = Snapshot.RegionCount;
+  for (Index = 0; Index < Snapshot.RegionCount; Index++)
+  {
+    Region = &Snapshot.Regions[Index];
+    if (Crcs[Index] == Get32(Data[Index]))
+    {
+      Stats.Skipped++;
+      continue;
+    }
+    UploadBlockRAM(Region->Address, Data[Index] + 4, Region->Size);
+    Stats.Uploaded++;
+    Stats.BytesSent += Region->Size;
+  }
+
+  // Bitmap handles, once their data is in place
+  Send_CMD(CMD_DLSTART);
+  Send_CMD(CLEAR(1, 1, 1));
+  for (Index = 0; Index < SNAPSHOT_MAX_HANDLES; Index++)
+  {
+    for (Word = 0; Word < Snapshot.Handles[Index].Count; Word++)
+      Send_CMD(Snapshot.Handles[Index].Words[Word]);
+  }
+  Send_CMD(DISPLAY());
+  Send_CMD(CMD_SWAP);
+  UpdateFIFO();
+  Wait4CoProFIFOEmpty();
+  Result = true;
+
+done:
+  free(File);
+  if (stats)
+    *stats = Stats;
+  return Result;
+}
@@ -0,0 +1,68 @@
+#ifndef __EVE_SNAPSHOT_H
+#define __EVE_SNAPSHOT_H
+
+// Persistent device state
+//
+// After a reset or a brown-out EVE has forgotten everything the application set up: the touch
+// calibration, fonts and bitmaps in RAM_G and the bitmap handles pointing at them.  Redoing all of
+// that - calibrating by hand, converting and uploading assets again - is slow.  A snapshot keeps
+// it in a host file instead:
+//   - the touch transform (REG_TOUCH_TRANSFORM_A - F), i.e. the calibration
+//   - the panel registers REG_HCYCLE - REG_PCLK
+//   - the commands that set up each bitmap handle, as registered with Snapshot_SetHandle
+//   - the RAM_G regions registered with Snapshot_AddRegion, with a CRC-32 each
+// Snapshot_Restore() writes the registers back in bursts, lets EVE checksum all regions with
+// CMD_MEMCRC in batches and only uploads the regions whose content differs (compressed where that
+// pays off, see eve_upload.h).  Last, the bitmap handles are set up again in a display list of
+// their own.  Call it after EVE_Init.
+//
+// File layout, all values little endian 32 bit:
+//   header:   Magic, Version, number of handles, number of regions
+//   registers REG_TOUCH_TRANSFORM_A - F, then REG_HCYCLE - REG_PCLK
+//   handles:  handle, word count, words
+//   regions:  address, size, CRC-32, data
+
+#include "eve.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define SNAPSHOT_MAGIC 0x50414E53UL // "SNAP"
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_MAX_REGIONS 32
+#define SNAPSHOT_MAX_HANDLES 32      // Bitmap handles 0 - 31
+#define SNAPSHOT_MAX_HANDLE_WORDS 16 // Commands setting up one handle
+
+  typedef struct
+  {
+    uint32_t Regions;   // RAM_G regions in the snapshot
+    uint32_t Skipped;   // Regions whose CRC already matched
+    uint32_t Uploaded;  // Regions sent again
+    uint32_t BytesSent; // Register and region bytes written
+  } Snapshot_Stats;
+
+  // Include size bytes of RAM_G at address in snapshots
+  bool EVE_EXPORT Snapshot_AddRegion(uint32_t address, uint32_t size);
+
+  // Record the commands setting up a bitmap handle - display list commands (BITMAP_HANDLE,
+  // BITMAP_SOURCE, BITMAP_LAYOUT, ...) or coprocessor commands with their parameters
+  // (CMD_SETBITMAP, CMD_SETFONT2).  A count of 0 removes the handle.
+  bool EVE_EXPORT Snapshot_SetHandle(uint32_t handle, const uint32_t *words, uint32_t count);
+
+  // Forget all regions and handles
+  void EVE_EXPORT Snapshot_Clear(void);
+
+  // Read the device state back and write it to a host file
+  bool EVE_EXPORT Snapshot_Save(const char *fileName);
+
+  // Bring the device back to the state in a snapshot file.  The regions and handles of the file
+  // replace the registered ones, so a later Snapshot_Save writes the same set.  stats may be NULL.
+  bool EVE_EXPORT Snapshot_Restore(const char *fileName, Snapshot_Stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
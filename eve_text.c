@@ -0,0 +1,314 @@
+// Host side text metrics and layout - see eve_text.h
+
+#include "eve_text.h"
+#include "eve.h"
+#include "eve_xfont.h"
+#include "hw_api.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define Log printf
+
+#define ROM_FONTS 16          // Legacy fonts 16 - 31 in the ROM font table
+#define LEGACY_FONT_SIZE 148  // 128 widths, format, stride, width, height, data pointer
+#define XFONT_HEADER 40       // Fixed part of the xfont header, gptr[] follows
+
+typedef struct
+{
+  uint8_t *Widths; // Width of every character in pixels
+  uint32_t Count;
+  uint16_t Height;
+  bool Extended;   // xfont - strings are UTF-8
+} Text_Font;
+
+typedef struct
+{
+  Text_Font Fonts[TEXT_MAX_FONTS];
+} Text_State;
+
+static Text_State Text;
+
+static uint32_t Get32(const uint8_t *buff)
+{
+  return buff[0] | ((uint32_t)buff[1] << 8) | ((uint32_t)buff[2] << 16) |
+         ((uint32_t)buff[3] << 24);
+}
+
+static bool SetFont(uint32_t handle, const uint8_t *font, uint32_t size)
+{
+  Text_Font *Font;
+  uint32_t Pages, Page, Count, Table, Index;
+
+  if (handle >= TEXT_MAX_FONTS)
+    return false;
+  Font = &Text.Fonts[handle];
+  free(Font->Widths);
+  memset(Font, 0, sizeof(*Font));
+
+  if ((size >= XFONT_HEADER) && (Get32(font) == XFONT_SIGNATURE))
+  {
+    Count = Get32(font + 36);
+    Pages = (Count + 127) / 128;
+    if (size < XFONT_HEADER + Pages * 8)
+      return false;
+    Font->Widths = (uint8_t *)calloc(Count ? Count : 1, 1);
+    if (!Font->Widths)
+      return false;
+    for (Page = 0; Page < Pages; Page++)
+    {
+      Table = Get32(font + XFONT_HEADER + (Pages + Page) * 4); // wptr[Page]
+      for (Index = Page * 128; (Index < Count) && (Index < Page * 128 + 128); Index++)
+      {
+        if (Table + Index % 128 < size)
+          Font->Widths[Index] = font[Table + Index % 128];
+      }
+    }
+    Font->Count = Count;
+    Font->Height = (uint16_t)Get32(font + 28); // pixel_height
+    Font->Extended = true;
+    return true;
+  }
+
+  if (size < LEGACY_FONT_SIZE)
+    return false;
+  Font->Widths = (uint8_t *)malloc(128);
+  if (!Font->Widths)
+    return false;
+  memcpy(Font->Widths, font, 128);
+  Font->Count = 128;
+  Font->Height = (uint16_t)Get32(font + 140);
+  return true;
+}
+
+bool Text_Init(void)
+{
+  uint8_t Table[ROM_FONTS * LEGACY_FONT_SIZE];
+  uint32_t Index;
+
+  rdN(rd32(ROM_FONTROOT), Table, sizeof(Table));
+  for (Index = 0; Index < ROM_FONTS; Index++)
+  {
+    if (!SetFont(16 + Index, Table + Index * LEGACY_FONT_SIZE, LEGACY_FONT_SIZE))
+      return false;
+  }
+  return true;
+}
+
+bool Text_AddFont(uint32_t handle, uint32_t address)
+{
+  uint8_t *Header;
+  uint32_t Size = LEGACY_FONT_SIZE;
+  bool Result;
+
+  // xfont headers carry their size, legacy metric blocks have a fixed one
+  if (rd32(address) == XFONT_SIGNATURE)
+    Size = rd32(address + 4);
+  Header = (uint8_t *)malloc(Size);
+  if (!Header)
+    return false;
+  rdN(address, Header, Size);
+  Result = SetFont(handle, Header, Size);
+  free(Header);
+  return Result;
+}
+
+bool Text_AddFontData(uint32_t handle, const uint8_t *font, uint32_t size)
+{
+  return SetFont(handle, font, size);
+}
+
+static const Text_Font *FindFont(uint16_t font)
+{
+  if ((font < TEXT_MAX_FONTS) && Text.Fonts[font].Widths)
+    return &Text.Fonts[font];
+  return NULL;
+}
+
+// Next character of a string, decoding UTF-8 for extended fonts
+static uint32_t NextChar(const Text_Font *font, const char **str)
+{
+  const uint8_t *Get = (const uint8_t *)*str;
+  uint32_t Code = *Get++, Follow = 0;
+
+  if (font->Extended)
+  {
+    if ((Code & 0xE0) == 0xC0)
+    {
+      Code &= 0x1F;
+      Follow = 1;
+    }
+    else if ((Code & 0xF0) == 0xE0)
+    {
+      Code &= 0x0F;
+      Follow = 2;
+    }
+    else if ((Code & 0xF8) == 0xF0)
+    {
+      Code &= 0x07;
+      Follow = 3;
+    }
+    while (Follow-- && ((*Get & 0xC0) == 0x80))
+      Code = (Code << 6) | (*Get++ & 0x3F);
+  }
+  *str = (const char *)Get;
+  return Code;
+}
+
+static uint32_t CharWidth(const Text_Font *font, uint32_t code)
+{
+  return (code < font->Count) ? font->Widths[code] : 0;
+}
+
+static uint32_t Measure(const Text_Font *font, const char *str, uint32_t length)
+{
+  const char *End = str + length;
+  uint32_t Width = 0;
+
+  while ((str < End) && *str)
+    Width += CharWidth(font, NextChar(font, &str));
+  return Width;
+}
+
+// Find the end of the line starting at str.  Returns the start of the next line and the length
+// of this one, without the space or newline it was broken at.
+static const char *NextLine(const Text_Font *font,
+                            const char *str,
+                            uint32_t width,
+                            bool wrap,
+                            uint32_t *length)
+{
+  const char *Get = str, *Break = NULL, *Char;
+  uint32_t Width = 0, Code;
+
+  while (*Get && (*Get != '\n'))
+  {
+    Char = Get;
+    Code = NextChar(font, &Get);
+    if (Code == ' ')
+      Break = Char;
+    Width += CharWidth(font, Code);
+    if (wrap && (Width > width) && (Char != str))
+    {
+      // Break at the last space, or inside a word that does not fit on its own
+      if (Break)
+        Char = Break;
+      *length = (uint32_t)(Char - str);
+      while (*Char == ' ')
+        Char++;
+      return Char;
+    }
+  }
+  *length = (uint32_t)(Get - str);
+  return *Get ? Get + 1 : Get;
+}
+
+// Copy a line into buff, cut short with "..." so it fits width
+static void Ellipsize(const Text_Font *font,
+                      const char *str,
+                      uint32_t length,
+                      uint32_t width,
+                      char *buff)
+{
+  uint32_t Dots = CharWidth(font, '.') * 3, Width = 0, Used = 0, Code;
+  const char *Get = str;
+
+  while ((uint32_t)(Get - str) < length)
+  {
+    Code = NextChar(font, &Get);
+    if (Width + CharWidth(font, Code) + Dots > width)
+      break;
+    Width += CharWidth(font, Code);
+    Used = (uint32_t)(Get - str);
+  }
+  memcpy(buff, str, Used);
+  strcpy(buff + Used, "...");
+}
+
+uint16_t Text_Height(uint16_t font)
+{
+  const Text_Font *Font = FindFont(font);
+
+  return Font ? Font->Height : 0;
+}
+
+uint32_t Text_Width(uint16_t font, const char *str)
+{
+  const Text_Font *Font = FindFont(font);
+
+  return Font ? Measure(Font, str, (uint32_t)strlen(str)) : 0;
+}
+
+uint32_t Text_Lines(uint16_t font, uint16_t width, uint32_t options, const char *str)
+{
+  const Text_Font *Font = FindFont(font);
+  uint32_t Lines = 0, Length;
+
+  if (!Font)
+    return 0;
+  while (*str)
+  {
+    str = NextLine(Font, str, width, (options & TEXT_WRAP) != 0, &Length);
+    Lines++;
+  }
+  return Lines;
+}
+
+uint32_t Text_Box(int16_t x,
+                  int16_t y,
+                  uint16_t width,
+                  uint16_t height,
+                  uint16_t font,
+                  uint32_t options,
+                  const char *str)
+{
+  const Text_Font *Font = FindFont(font);
+  uint32_t Lines, Visible, Line, Length, Width;
+  bool Wrap = (options & TEXT_WRAP) != 0;
+  const char *Next;
+  int16_t X;
+  char *Buff;
+
+  if (!Font || !Font->Height)
+  {
+    Log("Text: no metrics for font %u\n", font);
+    return 0;
+  }
+  Lines = Text_Lines(font, width, options, str);
+  Visible = height / Font->Height;
+  if (Visible > Lines)
+    Visible = Lines;
+  if (options & OPT_CENTERY)
+    y += (int16_t)((height - Visible * Font->Height) / 2);
+
+  Buff = (char *)malloc(strlen(str) + 4);
+  if (!Buff)
+    return 0;
+  for (Line = 0; Line < Visible; Line++)
+  {
+    Next = NextLine(Font, str, width, Wrap, &Length);
+    Width = Measure(Font, str, Length);
+    if ((options & TEXT_ELLIPSIS) && ((Width > width) || ((Line + 1 == Visible) && *Next)))
+    {
+      Ellipsize(Font, str, Length, width, Buff);
+      Width = Measure(Font, Buff, (uint32_t)strlen(Buff));
+    }
+    else
+    {
+      memcpy(Buff, str, Length);
+      Buff[Length] = 0;
+    }
+
+    X = x;
+    if (options & OPT_RIGHTX)
+      X += (int16_t)((int32_t)width - (int32_t)Width);
+    else if (options & OPT_CENTERX)
+      X += (int16_t)(((int32_t)width - (int32_t)Width) / 2);
+    if (*Buff)
+      XFont_Text((uint16_t)X, (uint16_t)(y + Line * Font->Height), font, 0, Buff);
+    str = Next;
+  }
+  free(Buff);
+  return Visible;
+}
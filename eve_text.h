@@ -0,0 +1,64 @@
+#ifndef __EVE_TEXT_H
+#define __EVE_TEXT_H
+
+// Host side text metrics and layout
+//
+// CMD_TEXT places a string but cannot wrap, clip or shorten it, and asking the coprocessor how
+// wide a string is takes a round trip per string.  This module keeps the character widths of
+// every font on the host instead - the ROM fonts are read from the ROM font table in one burst
+// by Text_Init(), custom fonts are added from their metric block or xfont header, either read
+// from RAM_G or taken from the font data on the host.  Strings can then be measured, wrapped,
+// aligned and ellipsized before any command is sent, and a text block ends up as one CMD_TEXT
+// per line at precomputed positions.
+//
+// Legacy fonts take single byte strings, extended fonts (xfont) UTF-8.  Text goes out through
+// XFont_Text(), so paged fonts from eve_xfont.h work as well.
+
+#include "eve.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define TEXT_MAX_FONTS 32 // Bitmap handles 0 - 31
+
+// Options for Text_Box in addition to OPT_CENTERX, OPT_RIGHTX and OPT_CENTERY
+#define TEXT_WRAP 0x10000UL     // Wrap lines at spaces (or anywhere for words too long)
+#define TEXT_ELLIPSIS 0x20000UL // End cut off text with "..."
+
+  // Read the metrics of the ROM fonts 16 - 31 from the device
+  bool EVE_EXPORT Text_Init(void);
+
+  // Add the metrics of a custom font in RAM_G, as set up with CMD_SETFONT2 for handle
+  bool EVE_EXPORT Text_AddFont(uint32_t handle, uint32_t address);
+
+  // Add the metrics of a custom font from the font data on the host - a legacy metric block or
+  // an xfont header - without reading the device
+  bool EVE_EXPORT Text_AddFontData(uint32_t handle, const uint8_t *font, uint32_t size);
+
+  // Height of a line in pixels, 0 for fonts without metrics
+  uint16_t EVE_EXPORT Text_Height(uint16_t font);
+
+  // Width of a string in pixels
+  uint32_t EVE_EXPORT Text_Width(uint16_t font, const char *str);
+
+  // Number of lines str takes in a box width pixels wide
+  uint32_t EVE_EXPORT Text_Lines(uint16_t font, uint16_t width, uint32_t options, const char *str);
+
+  // Lay out str in a box and send one CMD_TEXT per visible line.  Lines which do not fit the
+  // height are left out; with TEXT_ELLIPSIS the last visible line (or, without TEXT_WRAP, any
+  // line too wide) ends in "...".  Returns the number of lines drawn.
+  uint32_t EVE_EXPORT Text_Box(int16_t x,
+                               int16_t y,
+                               uint16_t width,
+                               uint16_t height,
+                               uint16_t font,
+                               uint32_t options,
+                               const char *str);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,125 @@
+// Tracked controls read from REG_TRACKER - see eve_tracker.h
+
+#include "eve_tracker.h"
+#include "eve.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define Log printf
+
+#define TRACKER_SLOTS 5 // REG_TRACKER and REG_TRACKER_1 .. REG_TRACKER_4, back to back
+
+typedef struct
+{
+  uint16_t X, Y, W, H;
+  Tracker_Handler Handler;
+  void *Control;
+  uint16_t Value; // Last value handed to the handler
+  uint8_t Tag;    // 0 for a free entry
+  bool Reported;  // Value is valid
+} Tracker_Control;
+
+typedef struct
+{
+  Tracker_Control Controls[TRACKER_MAX];
+} Tracker_State;
+
+static Tracker_State Tracker;
+
+static uint32_t Get32(const uint8_t *buff)
+{
+  return buff[0] | ((uint32_t)buff[1] << 8) | ((uint32_t)buff[2] << 16) |
+         ((uint32_t)buff[3] << 24);
+}
+
+static Tracker_Control *Find(uint8_t tag)
+{
+  uint32_t Index;
+
+  for (Index = 0; Index < TRACKER_MAX; Index++)
+  {
+    if (Tracker.Controls[Index].Tag == tag)
+      return &Tracker.Controls[Index];
+  }
+  return NULL;
+}
+
+bool Tracker_Add(uint8_t tag,
+                 uint16_t x,
+                 uint16_t y,
+                 uint16_t w,
+                 uint16_t h,
+                 Tracker_Handler handler,
+                 void *control)
+{
+  Tracker_Control *Control;
+
+  if (!tag) // Tag 0 is what the registers hold without a touch
+    return false;
+  Control = Find(tag);
+  if (!Control)
+    Control = Find(0);
+  if (!Control)
+  {
+    Log("Tracker: no room for tag %d\n", tag);
+    return false;
+  }
+  Control->X = x;
+  Control->Y = y;
+  Control->W = w;
+  Control->H = h;
+  Control->Handler = handler;
+  Control->Control = control;
+  Control->Tag = tag;
+  Control->Reported = false;
+  Cmd_Track(x, y, w, h, tag);
+  return true;
+}
+
+void Tracker_Remove(uint8_t tag)
+{
+  Tracker_Control *Control = tag ? Find(tag) : NULL;
+
+  if (!Control)
+    return;
+  Cmd_Track(0, 0, 0, 0, tag); // An empty area ends the tracking
+  memset(Control, 0, sizeof(*Control));
+}
+
+void Tracker_Resend(void)
+{
+  uint32_t Index;
+  const Tracker_Control *Control;
+
+  for (Index = 0; Index < TRACKER_MAX; Index++)
+  {
+    Control = &Tracker.Controls[Index];
+    if (Control->Tag)
+      Cmd_Track(Control->X, Control->Y, Control->W, Control->H, Control->Tag);
+  }
+}
+
+uint32_t Tracker_Poll(void)
+{
+  uint8_t Regs[TRACKER_SLOTS * 4];
+  uint32_t Slot, Value, Called = 0;
+  Tracker_Control *Control;
+  uint8_t Tag;
+
+  rdN(REG_TRACKER + RAM_REG, Regs, sizeof(Regs));
+  for (Slot = 0; Slot < TRACKER_SLOTS; Slot++)
+  {
+    Value = Get32(Regs + Slot * 4);
+    Tag = (uint8_t)Value;
+    Control = Tag ? Find(Tag) : NULL;
+    if (!Control || (Control->Reported && (Control->Value == (uint16_t)(Value >> 16))))
+      continue;
+    Control->Value = (uint16_t)(Value >> 16);
+    Control->Reported = true;
+    if (Control->Handler)
+      Control->Handler(Tag, Control->Value, Control->Control);
+    Called++;
+  }
+  return Called;
+}
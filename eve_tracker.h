@@ -0,0 +1,61 @@
+#ifndef __EVE_TRACKER_H
+#define __EVE_TRACKER_H
+
+// Tracked controls read from REG_TRACKER
+//
+// CMD_TRACK makes the coprocessor follow touches on a tagged area and report them in
+// REG_TRACKER as (value << 16) | tag: the angle around the center for a rotary control, the
+// position along the long side for a linear one, 0 .. 65535 either way.  With the capacitive
+// engine in extended mode REG_TRACKER_1 .. REG_TRACKER_4 do the same for the other contacts.
+//
+// Controls are registered with Tracker_Add(), which issues the CMD_TRACK, together with the
+// function to call when their value changes.  Tracker_Poll() reads all five tracker registers in
+// one burst and hands the new values to the controls - no hit testing or angle math on the host.
+// The display list still has to draw the controls with TAG(tag).
+//
+//   Tracker_Add(TAG_VOLUME, 240, 136, 1, 1, VolumeChanged, &Volume); // Rotary, around 240,136
+//   Tracker_Add(TAG_SLIDER, 20, 240, 440, 20, SliderChanged, &Slider);
+//   UpdateFIFO();
+//   while (1)
+//   {
+//     Tracker_Poll();
+//     ... draw ...
+//   }
+
+#include "eve.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define TRACKER_MAX 16 // Controls tracked at the same time
+
+  typedef void (*Tracker_Handler)(uint8_t tag, uint16_t value, void *control);
+
+  // Track the area x, y, w, h drawn with tag, a rotary control around x, y when w and h are 1.
+  // handler gets control back with every change.  Sends CMD_TRACK, without UpdateFIFO.  False
+  // when TRACKER_MAX controls are tracked already.
+  bool EVE_EXPORT Tracker_Add(uint8_t tag,
+                              uint16_t x,
+                              uint16_t y,
+                              uint16_t w,
+                              uint16_t h,
+                              Tracker_Handler handler,
+                              void *control);
+
+  // Stop tracking tag
+  void EVE_EXPORT Tracker_Remove(uint8_t tag);
+
+  // Send CMD_TRACK for every control again, e.g. after the coprocessor was reset
+  void EVE_EXPORT Tracker_Resend(void);
+
+  // Read the tracker registers and call the handlers of the controls that changed.  Returns the
+  // number of handlers called.
+  uint32_t EVE_EXPORT Tracker_Poll(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
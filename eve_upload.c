@@ -0,0 +1,126 @@
+// Compressed uploads into RAM_G - see eve_upload.h
+//
+// The host side compression uses zlib when the library is built with it (EVE_HAVE_ZLIB).  Without
+// zlib every upload simply becomes a plain burst write, so nothing changes for platforms that do
+// not have it.
+
+#include "eve_upload.h"
+#include "eve.h"
+#include "eve_mediafifo.h"
+#include "hw_api.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(EVE_HAVE_ZLIB)
+#include <zlib.h>
+#endif
+
+static Upload_Stats Stats;
+
+// Hand the zlib stream to the coprocessor - through the media FIFO when one is set up (CMD_INFLATE2,
+// BT81x only), otherwise through the command FIFO.  CoProWrCmdBuf() rounds the last piece up to 4 bytes, so for the
+// command FIFO the stream is copied into a padded buffer first.  Returns 0 if nothing was sent.
+static uint32_t SendInflate(uint32_t Add, const uint8_t *zbuff, uint32_t zcount)
+{
+  uint32_t Padded = (zcount + 3) & ~3;
+  uint8_t *Data;
+
+  // A pending MediaFifo_LoadImageStart owns the ring, and the command FIFO is no way around it -
+  // CMD_INFLATE would queue behind the load, which nobody pumps while we wait for FIFO space.
+  if (MediaFifo_Busy())
+    return 0;
+
+  if (MediaFifo_Active() && EVE_IsBT81x())
+  {
+    Cmd_Inflate2(Add, OPT_MEDIAFIFO);
+    UpdateFIFO();
+    if (!MediaFifo_WriteAll(zbuff, zcount))
+      return 0; // The coprocessor faulted, the next wait recovers it
+
+    Stats.SentBytes += Padded + 12;
+    Stats.Inflated++;
+    return Padded;
+  }
+
+  Data = (uint8_t *)calloc(Padded, 1);
+  if (!Data)
+    return 0;
+  memcpy(Data, zbuff, zcount);
+
+  Cmd_Inflate(Add);
+  CoProWrCmdBuf(Data, Padded); // This also publishes the command itself
+  free(Data);
+
+  Stats.SentBytes += Padded + 8;
+  Stats.Inflated++;
+  return Padded;
+}
+
+// Send CMD_GETPTR and read back the first address after the inflated data, 0 on a fault
+static uint32_t GetInflatePtr(void)
+{
+  uint16_t ResultLocation;
+
+  Cmd_GetPtr();
+  ResultLocation = (FifoWriteLocation - FT_CMD_SIZE) % FT_CMD_FIFO_SIZE;
+  UpdateFIFO();
+  if (CoProFIFO_WaitEmpty() != COPRO_OK)
+    return 0; // The inflate faulted, the result never got written
+  return rd32(RAM_CMD + ResultLocation);
+}
+
+uint32_t UploadBlockRAM(uint32_t Add, const uint8_t *buff, uint32_t count)
+{
+  Stats.RawBytes += count;
+
+#if defined(EVE_HAVE_ZLIB)
+  if (count >= UPLOAD_MIN_SIZE)
+  {
+    uLongf ZSize = compressBound(count);
+    uint8_t *ZData = (uint8_t *)malloc(ZSize);
+
+    if (ZData)
+    {
+      if ((compress2(ZData, &ZSize, buff, count, Z_BEST_COMPRESSION) == Z_OK) &&
+          ((uint64_t)ZSize * 100 <= (uint64_t)count * UPLOAD_MAX_RATIO) &&
+          SendInflate(Add, ZData, ZSize))
+      {
+        free(ZData);
+        // The data is in place once the coprocessor has caught up without a fault, otherwise it
+        // was recovered and the block has to go as a burst after all
+        if (CoProFIFO_WaitEmpty() == COPRO_OK)
+          return (Add + count);
+        Stats.Inflated--;
+      }
+      else
+        free(ZData);
+    }
+  }
+#endif
+
+  // Not compressible enough (or no zlib) - a plain burst is the fastest way
+  Stats.SentBytes += count;
+  Stats.Bursts++;
+  return WriteBlockRAM(Add, buff, count);
+}
+
+uint32_t InflateBlockRAM(uint32_t Add, const uint8_t *zbuff, uint32_t zcount)
+{
+  uint32_t End;
+
+  if (!SendInflate(Add, zbuff, zcount))
+    return Add;
+  End = GetInflatePtr();
+  return End ? End : Add;
+}
+
+void Upload_GetStats(Upload_Stats *stats)
+{
+  *stats = Stats;
+}
+
+void Upload_ResetStats(void)
+{
+  memset(&Stats, 0, sizeof(Stats));
+}
@@ -0,0 +1,53 @@
+#ifndef __EVE_UPLOAD_H
+#define __EVE_UPLOAD_H
+
+// Compressed uploads into RAM_G
+//
+// Bulk data (bitmaps, font glyphs, ...) normally goes over SPI byte for byte.  EVE can inflate a
+// zlib stream by itself (CMD_INFLATE), so when the host is able to deflate the data first only the
+// compressed stream needs to cross the wire.  On a slow USB bridge that multiplies the effective
+// bandwidth for anything that compresses well.  Data which does not compress well enough is
+// written as a plain burst instead.
+
+#include "eve.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// Blocks smaller than this are never worth the extra coprocessor round trips
+#define UPLOAD_MIN_SIZE 256
+// Only inflate on EVE if the compressed stream is at most this percentage of the raw data
+#define UPLOAD_MAX_RATIO 90
+
+  typedef struct
+  {
+    uint32_t RawBytes;  // Bytes handed to the upload functions
+    uint32_t SentBytes; // Bytes that actually went over the wire
+    uint32_t Inflated;  // Number of blocks sent compressed
+    uint32_t Bursts;    // Number of blocks sent as plain bursts
+  } Upload_Stats;
+
+  // Upload a block of data into RAM_G, deflating it on the host when that pays off.
+  // Return the last written address + 1 (The next available RAM address), like WriteBlockRAM.
+  uint32_t EVE_EXPORT UploadBlockRAM(uint32_t Add, const uint8_t *buff, uint32_t count);
+
+  // When a media FIFO is set up (MediaFifo_Init) on a BT81x the compressed data streams through
+  // it, otherwise it goes through the command FIFO.  Should the coprocessor fault on the stream
+  // it is recovered and the block written as a plain burst.  While a MediaFifo_LoadImageStart load holds the
+  // media FIFO the block goes out as a plain burst instead.
+
+  // Send an already deflated (zlib) stream to the coprocessor and let EVE inflate it to Add.
+  // Return the last written address + 1 as reported by the coprocessor, Add if the stream could
+  // not be sent - the media FIFO is busy with a load or the coprocessor faulted on it.
+  uint32_t EVE_EXPORT InflateBlockRAM(uint32_t Add, const uint8_t *zbuff, uint32_t zcount);
+
+  void EVE_EXPORT Upload_GetStats(Upload_Stats *stats);
+  void EVE_EXPORT Upload_ResetStats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,505 @@
+// Video playback from host files - see eve_video.h
+
+#include "eve_video.h"
+#include "eve.h"
+#include "eve_mediafifo.h"
+#include "eve_os.h"
+#include "hw_api.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define Log printf
+
+#define VIDEO_QUEUE_SIZE 8 // Frames in the media FIFO waiting for their CMD_VIDEOFRAME
+// Stream at most this many frames ahead of time.  Data in the media FIFO has to be decoded, so
+// a deeper read ahead would only turn a hiccup into a run of late frames instead of drops.
+#define VIDEO_FEED_AHEAD 3
+
+typedef struct
+{
+  uint8_t *Data;     // Chunk header and data exactly as in the file
+  uint32_t Size;
+  uint32_t Capacity;
+  uint32_t Frame;    // Number of the frame in the stream
+  bool Full;         // Owned by the consumer while set
+} Video_Chunk;
+
+typedef struct
+{
+  FILE *File;
+  uint32_t MoviStart;        // File offset of the first chunk in the 'movi' list
+  uint32_t MoviEnd;          // File offset just past the 'movi' list
+  uint8_t *Header;           // Everything up to the first chunk - the decoder wants it first
+  uint32_t HeaderSize;
+  uint32_t FrameAddress[2];  // Bitmaps in RAM_G
+  uint8_t Buffers;           // 2 when decoding into a back buffer, 1 when RAM_G is too small
+  uint8_t Front;             // Bitmap holding the last complete frame
+  uint32_t DoneFlag;         // Word in RAM_G which CMD_VIDEOFRAME clears after the last frame
+  uint64_t RefreshNs;        // Duration of one display frame
+  uint32_t StartFrames;      // REG_FRAMES when playback started
+  uint64_t StartUs;
+
+  // Producer thread
+  OS_Thread Producer;
+  OS_Mutex Lock;
+  OS_Cond Changed;
+  Video_Chunk Chunk[2];
+  bool EndOfFile;
+  bool Stop;
+
+  // Consumer - the thread calling Video_Update
+  uint8_t ConsumeIndex;
+  Video_Chunk *Feeding;      // Chunk being written into the media FIFO
+  uint32_t FeedOffset;
+  uint8_t Carry[4];          // Bytes left over from the last chunk to make up a whole word
+  uint8_t CarryCount;
+  uint32_t Queue[VIDEO_QUEUE_SIZE];
+  uint8_t QueueHead;
+  uint8_t QueueCount;
+  bool Decoding;
+  uint16_t DecodeCmdDone;    // REG_CMD_READ once the running CMD_VIDEOFRAME is done
+  bool Finished;
+  bool Open;
+
+  Video_Stats Stats;
+} Video_State;
+
+static Video_State Video;
+
+static uint32_t Get32(const uint8_t *buff)
+{
+  return buff[0] | ((uint32_t)buff[1] << 8) | ((uint32_t)buff[2] << 16) |
+         ((uint32_t)buff[3] << 24);
+}
+
+// Find the 'avih' main header and the 'movi' list in the file.  The AVI header carries frame
+// rate and size, everything before the 'movi' data is handed to the decoder as it is.
+static bool ParseAVI(void)
+{
+  uint8_t Buff[12];
+  uint8_t *List;
+  uint32_t Position = 12, Size, Index;
+  bool HaveHeader = false;
+
+  if ((fread(Buff, 1, 12, Video.File) != 12) || memcmp(Buff, "RIFF", 4) ||
+      memcmp(Buff + 8, "AVI ", 4))
+    return false;
+
+  while (fread(Buff, 1, 8, Video.File) == 8)
+  {
+    Size = Get32(Buff + 4);
+    Position += 8;
+    if (!memcmp(Buff, "LIST", 4) && (Size >= 4))
+    {
+      if (fread(Buff + 8, 1, 4, Video.File) != 4)
+        return false;
+      if (!memcmp(Buff + 8, "movi", 4))
+      {
+        Video.MoviStart = Position + 4;
+        Video.MoviEnd = Position + Size;
+        return HaveHeader;
+      }
+      if (!memcmp(Buff + 8, "hdrl", 4))
+      {
+        List = (uint8_t *)malloc(Size - 4);
+        if (!List || (fread(List, 1, Size - 4, Video.File) != Size - 4))
+        {
+          free(List);
+          return false;
+        }
+        // The main AVI header is the first chunk in 'hdrl', search for it to be lenient
+        for (Index = 0; Index + 8 + 40 <= Size - 4; Index++)
+        {
+          if (!memcmp(List + Index, "avih", 4))
+          {
+            Video.Stats.FrameUs = Get32(List + Index + 8);
+            Video.Stats.Width = (uint16_t)Get32(List + Index + 8 + 32);
+            Video.Stats.Height = (uint16_t)Get32(List + Index + 8 + 36);
+            HaveHeader = true;
+            break;
+          }
+        }
+        free(List);
+        Position += Size + (Size & 1);
+        fseek(Video.File, Position, SEEK_SET);
+        continue;
+      }
+    }
+    Position += Size + (Size & 1); // Chunks are padded to an even size
+    fseek(Video.File, Position, SEEK_SET);
+  }
+  return false;
+}
+
+// Producer thread - reads the video chunks of the 'movi' list into the two chunk buffers
+static void Producer(void *arg)
+{
+  uint8_t ChunkHeader[8];
+  uint32_t Position = Video.MoviStart, Size, Frame = 0;
+  uint8_t Index = 0;
+  Video_Chunk *Chunk;
+  bool Stop;
+
+  (void)arg;
+  fseek(Video.File, Position, SEEK_SET);
+  while ((Position + 8 <= Video.MoviEnd) && (fread(ChunkHeader, 1, 8, Video.File) == 8))
+  {
+    Size = Get32(ChunkHeader + 4);
+    if (!memcmp(ChunkHeader, "LIST", 4))
+    {
+      // 'rec ' lists group chunks - step into them
+      fseek(Video.File, 4, SEEK_CUR);
+      Position += 12;
+      continue;
+    }
+    if (memcmp(ChunkHeader + 2, "dc", 2) && memcmp(ChunkHeader + 2, "db", 2))
+    {
+      // Audio, index or padding chunks are not for the decoder
+      Position += 8 + Size + (Size & 1);
+      fseek(Video.File, Position, SEEK_SET);
+      continue;
+    }
+
+    Chunk = &Video.Chunk[Index];
+    OS_MutexLock(&Video.Lock);
+    while (Chunk->Full && !Video.Stop)
+      OS_CondWait(&Video.Changed, &Video.Lock);
+    Stop = Video.Stop;
+    OS_MutexUnlock(&Video.Lock);
+    if (Stop)
+      break;
+
+    Chunk->Size = 8 + Size + (Size & 1);
+    if (Chunk->Capacity < Chunk->Size)
+    {
+      free(Chunk->Data);
+      Chunk->Data = (uint8_t *)malloc(Chunk->Size);
+      Chunk->Capacity = Chunk->Data ? Chunk->Size : 0;
+      if (!Chunk->Data)
+        break;
+    }
+    memcpy(Chunk->Data, ChunkHeader, 8);
+    if (fread(Chunk->Data + 8, 1, Chunk->Size - 8, Video.File) != Chunk->Size - 8)
+      break;
+    Chunk->Frame = Frame++;
+    Position += Chunk->Size;
+
+    OS_MutexLock(&Video.Lock);
+    Chunk->Full = true;
+    OS_CondBroadcast(&Video.Changed);
+    OS_MutexUnlock(&Video.Lock);
+    Index ^= 1;
+  }
+
+  OS_MutexLock(&Video.Lock);
+  Video.EndOfFile = true;
+  OS_CondBroadcast(&Video.Changed);
+  OS_MutexUnlock(&Video.Lock);
+}
+
+// Write stream data into the media FIFO in whole words, carrying odd bytes over to the next
+// chunk.  Return the number of bytes taken from buff.
+static uint32_t FeedBytes(const uint8_t *buff, uint32_t count)
+{
+  uint32_t Taken = 0, Whole, Written;
+
+  if (Video.CarryCount)
+  {
+    while ((Video.CarryCount < 4) && (Taken < count))
+      Video.Carry[Video.CarryCount++] = buff[Taken++];
+    if (Video.CarryCount < 4)
+      return Taken;
+    if (!MediaFifo_Write(Video.Carry, 4))
+      return Taken; // Full - the word goes out on the next attempt
+    Video.Stats.BytesStreamed += 4;
+    Video.CarryCount = 0;
+  }
+
+  Whole = (count - Taken) & ~3;
+  if (Whole)
+  {
+    Written = MediaFifo_Write(buff + Taken, Whole);
+    Video.Stats.BytesStreamed += Written;
+    Taken += Written;
+    if (Written < Whole)
+      return Taken;
+  }
+
+  while (Taken < count)
+    Video.Carry[Video.CarryCount++] = buff[Taken++];
+  return Taken;
+}
+
+// Display frames from the start of playback until the given video frame is due
+static uint32_t FrameDue(uint32_t frame)
+{
+  return (uint32_t)((uint64_t)frame * Video.Stats.FrameUs * 1000 / Video.RefreshNs);
+}
+
+// Hand a chunk buffer back to the producer
+static void ReleaseChunk(Video_Chunk *chunk)
+{
+  OS_MutexLock(&Video.Lock);
+  chunk->Full = false;
+  OS_CondBroadcast(&Video.Changed);
+  OS_MutexUnlock(&Video.Lock);
+  Video.ConsumeIndex ^= 1;
+}
+
+// Move chunks from the producer into the media FIFO as far as it has room
+static void Feed(uint32_t elapsed)
+{
+  Video_Chunk *Chunk;
+  bool Full, EndOfFile;
+
+  for (;;)
+  {
+    if (!Video.Feeding)
+    {
+      Chunk = &Video.Chunk[Video.ConsumeIndex];
+      OS_MutexLock(&Video.Lock);
+      Full = Chunk->Full;
+      EndOfFile = Video.EndOfFile;
+      OS_MutexUnlock(&Video.Lock);
+      if (!Full)
+      {
+        if (Video.CarryCount == 4)
+          FeedBytes(NULL, 0); // A whole word still waiting for room
+        else if (EndOfFile && Video.CarryCount &&
+                 MediaFifo_Write(Video.Carry, Video.CarryCount)) // The last bytes go out padded
+        {
+          Video.Stats.BytesStreamed += Video.CarryCount;
+          Video.CarryCount = 0;
+        }
+        return;
+      }
+      if ((Video.QueueCount == VIDEO_QUEUE_SIZE) ||
+          (FrameDue(Chunk->Frame) > elapsed + FrameDue(VIDEO_FEED_AHEAD)))
+        return; // Far enough ahead
+
+      if (elapsed >= FrameDue(Chunk->Frame + 1))
+      {
+        // Already late for its own display slot, skip it and never send it
+        Video.Stats.FramesDropped++;
+        ReleaseChunk(Chunk);
+        continue;
+      }
+      Video.Feeding = Chunk;
+      Video.FeedOffset = 0;
+      Video.Queue[(Video.QueueHead + Video.QueueCount++) % VIDEO_QUEUE_SIZE] = Chunk->Frame;
+    }
+
+    Chunk = Video.Feeding;
+    Video.FeedOffset +=
+        FeedBytes(Chunk->Data + Video.FeedOffset, Chunk->Size - Video.FeedOffset);
+    if (Video.FeedOffset < Chunk->Size)
+      return; // The media FIFO is full
+
+    Video.Feeding = NULL;
+    ReleaseChunk(Chunk);
+  }
+}
+
+bool Video_Open(const char *fileName, uint32_t ramAddress, uint32_t fifoAddress, uint32_t fifoSize)
+{
+  uint8_t Regs[REG_PCLK + 4 - REG_FREQUENCY];
+  uint32_t FrameSize, Limit, Frequency, Offset, Taken;
+
+  if (Video.Open)
+    Video_Close();
+  memset(&Video, 0, sizeof(Video));
+
+  Video.File = fopen(fileName, "rb");
+  if (!Video.File)
+    return false;
+  if (!ParseAVI() || !Video.Stats.Width || !Video.Stats.Height)
+  {
+    Log("Video: %s is not a usable AVI file\n", fileName);
+    fclose(Video.File);
+    return false;
+  }
+
+  // Place the bitmaps, using a back buffer when there is room for it
+  FrameSize = (((uint32_t)Video.Stats.Width * Video.Stats.Height * 2) + 3) & ~3;
+  Limit = (fifoAddress > ramAddress) ? fifoAddress : RAM_G + 0x100000UL;
+  Video.Buffers = (ramAddress + 2 * FrameSize + 4 <= Limit) ? 2 : 1;
+  if (ramAddress + FrameSize + 4 > Limit)
+  {
+    Log("Video: no room in RAM_G for %ux%u frames\n", Video.Stats.Width, Video.Stats.Height);
+    fclose(Video.File);
+    return false;
+  }
+  Video.FrameAddress[0] = ramAddress;
+  Video.FrameAddress[1] = ramAddress + (Video.Buffers - 1) * FrameSize;
+  Video.DoneFlag = ramAddress + Video.Buffers * FrameSize;
+
+  Video.Header = (uint8_t *)malloc(Video.MoviStart);
+  fseek(Video.File, 0, SEEK_SET);
+  if (!Video.Header || (fread(Video.Header, 1, Video.MoviStart, Video.File) != Video.MoviStart) ||
+      !MediaFifo_Init(fifoAddress, fifoSize))
+  {
+    free(Video.Header);
+    fclose(Video.File);
+    return false;
+  }
+  Video.HeaderSize = Video.MoviStart;
+
+  // Frame pacing follows the display refresh - derive its period from the timing registers
+  rdN(REG_FREQUENCY + RAM_REG, Regs, sizeof(Regs));
+  Frequency = Get32(Regs);
+  Video.RefreshNs = (uint64_t)Get32(Regs + REG_HCYCLE - REG_FREQUENCY) *
+                    Get32(Regs + REG_VCYCLE - REG_FREQUENCY) *
+                    Get32(Regs + REG_PCLK - REG_FREQUENCY) * 1000000000ULL;
+  Video.RefreshNs = Frequency ? Video.RefreshNs / Frequency : 0;
+  if (!Video.RefreshNs)
+    Video.RefreshNs = 16666667; // Display not running yet, assume 60Hz
+  if (!Video.Stats.FrameUs)
+    Video.Stats.FrameUs = 33333;
+
+  OS_MutexInit(&Video.Lock);
+  OS_CondInit(&Video.Changed);
+  if (!OS_ThreadStart(&Video.Producer, Producer, NULL))
+  {
+    OS_CondDestroy(&Video.Changed);
+    OS_MutexDestroy(&Video.Lock);
+    free(Video.Header);
+    fclose(Video.File);
+    return false;
+  }
+  Video.Open = true;
+
+  // The decoder parses the AVI headers first
+  Cmd_VideoStart();
+  UpdateFIFO();
+  for (Offset = 0; Offset < Video.HeaderSize; Offset += Taken)
+  {
+    Taken = FeedBytes(Video.Header + Offset, Video.HeaderSize - Offset);
+    if (!Taken && ((rd16(REG_CMD_READ + RAM_REG) == 0xFFF) || EVE_Lost()))
+    {
+      // The decoder will never make room again
+      Log("Video: coprocessor fault or bridge lost, giving up\n");
+      if (!EVE_Lost())
+        CoPro_Recover();
+      Video_Close();
+      return false;
+    }
+  }
+
+  Video.StartFrames = rd32(REG_FRAMES + RAM_REG);
+  Video.StartUs = OS_TimeUs();
+  return true;
+}
+
+bool Video_Update(void)
+{
+  uint32_t Elapsed;
+  bool NewFrame = false;
+
+  if (!Video.Open || Video.Finished)
+    return false;
+
+  Elapsed = rd32(REG_FRAMES + RAM_REG) - Video.StartFrames;
+
+  if (Video.Decoding && CoProFIFO_Passed(Video.DecodeCmdDone))
+  {
+    if (rd16(REG_CMD_READ + RAM_REG) == 0xFFF)
+    {
+      Log("Video: coprocessor fault, stopping playback\n");
+      CoPro_Recover();
+      Video.Finished = true;
+      return false;
+    }
+    Video.Decoding = false;
+    Video.Front = (Video.Buffers == 2) ? (Video.Front ^ 1) : 0;
+    Video.Stats.FramesDecoded++;
+    NewFrame = true;
+    if (!rd32(Video.DoneFlag))
+      Video.Finished = true; // That was the last frame of the stream
+  }
+
+  Feed(Elapsed);
+
+  if (!Video.Decoding && Video.QueueCount &&
+      (Elapsed >= FrameDue(Video.Queue[Video.QueueHead])))
+  {
+    // Decode into the bitmap which is not on screen
+    Cmd_VideoFrame(Video.FrameAddress[(Video.Buffers == 2) ? (Video.Front ^ 1) : 0],
+                   Video.DoneFlag);
+    UpdateFIFO();
+    Video.DecodeCmdDone = FifoWriteLocation;
+    Video.Decoding = true;
+    Video.QueueHead = (Video.QueueHead + 1) % VIDEO_QUEUE_SIZE;
+    Video.QueueCount--;
+  }
+  else if (!Video.Decoding && !Video.QueueCount && !Video.Feeding)
+  {
+    // Nothing queued - done when the producer has nothing more either
+    OS_MutexLock(&Video.Lock);
+    if (Video.EndOfFile && !Video.Chunk[0].Full && !Video.Chunk[1].Full)
+      Video.Finished = true;
+    OS_MutexUnlock(&Video.Lock);
+  }
+
+  return NewFrame;
+}
+
+bool Video_Finished(void)
+{
+  return !Video.Open || Video.Finished;
+}
+
+void Video_Draw(uint8_t handle, int16_t x, int16_t y)
+{
+  if (!Video.Open || !Video.Stats.FramesDecoded)
+    return;
+
+  Send_CMD(BITMAP_HANDLE(handle));
+  if (EVE_IsBT81x())
+    Cmd_SetBitmap(Video.FrameAddress[Video.Front], RGB565, Video.Stats.Width, Video.Stats.Height);
+  else
+  {
+    // No CMD_SETBITMAP on FT81x
+    Send_CMD(BITMAP_SOURCE(Video.FrameAddress[Video.Front]));
+    Send_CMD(BITMAP_LAYOUT(RGB565, Video.Stats.Width * 2, Video.Stats.Height));
+    Send_CMD(BITMAP_LAYOUT2(Video.Stats.Width * 2, Video.Stats.Height));
+    Send_CMD(BITMAP_SIZE(NEAREST, BORDER, BORDER, Video.Stats.Width, Video.Stats.Height));
+    Send_CMD(BITMAP_SIZE2(Video.Stats.Width, Video.Stats.Height));
+  }
+  Send_CMD(BEGIN(BITMAPS));
+  Send_CMD(VERTEX2F(x, y));
+  Send_CMD(END());
+}
+
+void Video_Close(void)
+{
+  uint8_t Index;
+
+  if (!Video.Open)
+    return;
+
+  OS_MutexLock(&Video.Lock);
+  Video.Stop = true;
+  OS_CondBroadcast(&Video.Changed);
+  OS_MutexUnlock(&Video.Lock);
+  OS_ThreadJoin(&Video.Producer);
+
+  OS_CondDestroy(&Video.Changed);
+  OS_MutexDestroy(&Video.Lock);
+  for (Index = 0; Index < 2; Index++)
+    free(Video.Chunk[Index].Data);
+  free(Video.Header);
+  fclose(Video.File);
+  MediaFifo_Close();
+  Video.Open = false;
+}
+
+void Video_GetStats(Video_Stats *stats)
+{
+  uint64_t Elapsed = OS_TimeUs() - Video.StartUs;
+
+  *stats = Video.Stats;
+  stats->BytesPerSecond =
+      Elapsed ? (uint32_t)((uint64_t)Video.Stats.BytesStreamed * 1000000 / Elapsed) : 0;
+}
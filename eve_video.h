@@ -0,0 +1,73 @@
+#ifndef __EVE_VIDEO_H
+#define __EVE_VIDEO_H
+
+// Video playback from host files
+//
+// Plays an AVI file with MJPEG video frame by frame.  A producer thread reads the video chunks
+// from disk into two host buffers while the main loop calls Video_Update(), which streams them
+// into the media FIFO and lets the coprocessor decode each frame (CMD_VIDEOFRAME) into an RGB565
+// bitmap in RAM_G when it is due according to REG_FRAMES.  When RAM_G has room for two frames
+// the decoder writes into a back buffer, so the bitmap on screen never shows a half decoded
+// frame.  Frames which would be shown too late are skipped before they are sent over the wire.
+//
+// Decoding runs in the coprocessor, the display list is up to the application:
+//
+//   while (!Video_Finished())
+//   {
+//     if (Video_Update())
+//     {
+//       Send_CMD(CMD_DLSTART);
+//       ... Video_Draw(0, 0, 0); overlays ...
+//       Send_CMD(DISPLAY());
+//       Send_CMD(CMD_SWAP);
+//       UpdateFIFO();
+//     }
+//   }
+
+#include "eve.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  typedef struct
+  {
+    uint16_t Width;          // Frame size from the AVI header
+    uint16_t Height;
+    uint32_t FrameUs;        // Microseconds per frame from the AVI header
+    uint32_t FramesDecoded;  // Frames decoded into the bitmap
+    uint32_t FramesDropped;  // Frames skipped because they were late
+    uint32_t BytesStreamed;  // Bytes written into the media FIFO
+    uint32_t BytesPerSecond; // Sustained data rate since the start of playback
+  } Video_Stats;
+
+  // Open an AVI file and start streaming it.  The decoded frames go to RAM_G at ramAddress,
+  // which needs room for one or (preferably) two frames of Width * Height * 2 bytes plus one
+  // word.  The media FIFO is set up at fifoAddress / fifoSize and must not overlap that area.
+  bool EVE_EXPORT Video_Open(const char *fileName,
+                             uint32_t ramAddress,
+                             uint32_t fifoAddress,
+                             uint32_t fifoSize);
+
+  // Stream data and decode the next frame when it is due.  Returns true when a new frame has
+  // been decoded and the display list should be rebuilt.  Call it from the main loop.
+  bool EVE_EXPORT Video_Update(void);
+
+  // True once the last frame has been decoded (or the stream broke)
+  bool EVE_EXPORT Video_Finished(void);
+
+  // Add the current frame to the display list as a bitmap at x, y (VERTEX2F units) using the
+  // given bitmap handle
+  void EVE_EXPORT Video_Draw(uint8_t handle, int16_t x, int16_t y);
+
+  // Stop playback, end the producer thread and close the file
+  void EVE_EXPORT Video_Close(void);
+
+  void EVE_EXPORT Video_GetStats(Video_Stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
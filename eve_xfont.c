@@ -0,0 +1,415 @@
+// Glyph paging for extended fonts - see eve_xfont.h
+
+#include "eve_xfont.h"
+#include "eve.h"
+#include "hw_api.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define Log printf
+
+#define XFONT_FREE 0xFFFFFFFFUL
+#define XFONT_HEADER 40 // Fixed part of the xfont header, gptr[] follows
+#define XFONT_PAGE 128  // Code points per gptr / wptr entry
+
+typedef struct
+{
+  uint32_t Code;    // Code point in the source font, XFONT_FREE if the slot is empty
+  uint32_t LastUse; // Frame it was last used in
+} XFont_Slot;
+
+typedef struct
+{
+  bool Used;
+  uint32_t Handle;
+  const uint8_t *Source; // xfont on the host
+  uint32_t SourceSize;
+  const uint8_t *Glyphs; // Glyph data on the host
+  uint32_t GlyphSize;
+  uint32_t Characters;   // number_of_characters of the source font
+  uint32_t Stride;       // Bytes per glyph
+  uint32_t Address;      // Slot font header in RAM_G
+  uint32_t GlyphAddress; // start_of_graphic_data of the slot font
+  uint32_t WidthAddress; // Width table of page 0, the others follow it
+  uint32_t SlotCount;
+  XFont_Slot *Slots;
+} XFont_Font;
+
+typedef struct
+{
+  XFont_Font Fonts[XFONT_MAX_FONTS];
+  uint32_t Frame;
+  XFont_Stats Stats;
+} XFont_State;
+
+static XFont_State XFont;
+
+static uint32_t Get32(const uint8_t *buff)
+{
+  return buff[0] | ((uint32_t)buff[1] << 8) | ((uint32_t)buff[2] << 16) |
+         ((uint32_t)buff[3] << 24);
+}
+
+static void Put32(uint8_t *buff, uint32_t value)
+{
+  buff[0] = (uint8_t)value;
+  buff[1] = (uint8_t)(value >> 8);
+  buff[2] = (uint8_t)(value >> 16);
+  buff[3] = (uint8_t)(value >> 24);
+}
+
+// Code point the coprocessor sees for a slot.  0 ends the string, '\n' breaks lines and '%'
+// starts a format with OPT_FORMAT, so those are never handed out.
+static uint32_t SlotCode(uint32_t slot)
+{
+  uint32_t Code = slot + 1;
+
+  if (Code >= '\n')
+    Code++;
+  if (Code >= '%')
+    Code++;
+  return Code;
+}
+
+static uint32_t HeaderSize(uint32_t pages)
+{
+  // gptr and wptr, then the width tables - glyphs start ASTC block aligned
+  return (XFONT_HEADER + pages * (8 + XFONT_PAGE) + 63) & ~63;
+}
+
+static XFont_Font *FindFont(uint32_t handle)
+{
+  uint32_t Index;
+
+  for (Index = 0; Index < XFONT_MAX_FONTS; Index++)
+  {
+    if (XFont.Fonts[Index].Used && (XFont.Fonts[Index].Handle == handle))
+      return &XFont.Fonts[Index];
+  }
+  return NULL;
+}
+
+bool XFont_Load(uint32_t handle,
+                uint32_t address,
+                uint32_t budget,
+                const uint8_t *xfont,
+                uint32_t xfontSize,
+                const uint8_t *glyphs,
+                uint32_t glyphSize)
+{
+  XFont_Font *Font;
+  uint32_t Index, Pages, Slots, Size, Stride;
+  uint8_t *Header;
+
+  XFont_Unload(handle);
+  if ((xfontSize < XFONT_HEADER) || (Get32(xfont) != XFONT_SIGNATURE) || (address & 3))
+  {
+    Log("XFont: not an extended font\n");
+    return false;
+  }
+  Pages = (Get32(xfont + 36) + XFONT_PAGE - 1) / XFONT_PAGE;
+  Stride = Get32(xfont + 16) * Get32(xfont + 20); // layout_width * layout_height
+  if (!Stride || (xfontSize < XFONT_HEADER + Pages * 8))
+  {
+    Log("XFont: not an extended font\n");
+    return false;
+  }
+
+  // As many slots as fit, every code point up to the last slot takes a glyph's room
+  Slots = budget / Stride;
+  if (Slots > XFONT_MAX_SLOTS)
+    Slots = XFONT_MAX_SLOTS;
+  while (Slots)
+  {
+    Size = HeaderSize(SlotCode(Slots - 1) / XFONT_PAGE + 1);
+    if (Size + (SlotCode(Slots - 1) + 1) * Stride <= budget)
+      break;
+    Slots--;
+  }
+
+  Font = NULL;
+  for (Index = 0; !Font && (Index < XFONT_MAX_FONTS); Index++)
+  {
+    if (!XFont.Fonts[Index].Used)
+      Font = &XFont.Fonts[Index];
+  }
+  if (!Slots || !Font)
+  {
+    Log("XFont: no room for the font\n");
+    return false;
+  }
+
+  memset(Font, 0, sizeof(*Font));
+  Font->Slots = (XFont_Slot *)malloc(Slots * sizeof(XFont_Slot));
+  Pages = SlotCode(Slots - 1) / XFONT_PAGE + 1;
+  Size = HeaderSize(Pages);
+  Header = (uint8_t *)calloc(Size, 1);
+  if (!Font->Slots || !Header)
+  {
+    free(Font->Slots);
+    free(Header);
+    Font->Slots = NULL;
+    return false;
+  }
+  for (Index = 0; Index < Slots; Index++)
+    Font->Slots[Index].Code = XFONT_FREE;
+
+  Font->Used = true;
+  Font->Handle = handle;
+  Font->Source = xfont;
+  Font->SourceSize = xfontSize;
+  Font->Glyphs = glyphs;
+  Font->GlyphSize = glyphSize;
+  Font->Characters = Get32(xfont + 36);
+  Font->Stride = Stride;
+  Font->Address = address;
+  Font->GlyphAddress = address + Size;
+  Font->WidthAddress = address + XFONT_HEADER + Pages * 8;
+  Font->SlotCount = Slots;
+
+  // Same bitmap layout as the source, with the slot pages one after the other.  Widths start at 0
+  // and are filled in as glyphs come in.
+  memcpy(Header, xfont, 32);
+  Put32(Header + 4, Size);
+  Put32(Header + 32, Font->GlyphAddress);
+  Put32(Header + 36, Pages * XFONT_PAGE);
+  for (Index = 0; Index < Pages; Index++)
+  {
+    Put32(Header + XFONT_HEADER + Index * 4, Index * XFONT_PAGE * Stride);
+    Put32(Header + XFONT_HEADER + (Pages + Index) * 4,
+          XFONT_HEADER + Pages * 8 + Index * XFONT_PAGE);
+  }
+  wrN(address, Header, Size);
+  XFont.Stats.BytesSent += Size;
+  free(Header);
+  return true;
+}
+
+void XFont_Unload(uint32_t handle)
+{
+  XFont_Font *Font = FindFont(handle);
+  uint32_t Index;
+
+  if (!Font)
+    return;
+  for (Index = 0; Index < Font->SlotCount; Index++)
+  {
+    if (Font->Slots[Index].Code != XFONT_FREE)
+      XFont.Stats.Resident--;
+  }
+  free(Font->Slots);
+  memset(Font, 0, sizeof(*Font));
+}
+
+uint32_t XFont_Slots(uint32_t handle)
+{
+  XFont_Font *Font = FindFont(handle);
+
+  return Font ? Font->SlotCount : 0;
+}
+
+void XFont_SetFont(uint32_t handle)
+{
+  XFont_Font *Font = FindFont(handle);
+
+  if (Font)
+    Cmd_SetFont2(handle, Font->Address, 0);
+}
+
+// Make sure the glyph of code is in a slot and return the slot, or -1
+static int PageIn(XFont_Font *font, uint32_t code)
+{
+  uint32_t Index, Offset, WidthTable, Oldest;
+  int Victim = -1;
+
+  for (Index = 0; Index < font->SlotCount; Index++)
+  {
+    if (font->Slots[Index].Code == code)
+    {
+      font->Slots[Index].LastUse = XFont.Frame;
+      return (int)Index;
+    }
+  }
+
+  if (code >= font->Characters)
+    return -1;
+  Offset = Get32(font->Source + XFONT_HEADER + (code / XFONT_PAGE) * 4) +
+           (code % XFONT_PAGE) * font->Stride;
+  WidthTable = Get32(font->Source + XFONT_HEADER +
+                     ((font->Characters + XFONT_PAGE - 1) / XFONT_PAGE + code / XFONT_PAGE) * 4);
+  if ((Offset + font->Stride > font->GlyphSize) ||
+      (WidthTable + code % XFONT_PAGE >= font->SourceSize))
+    return -1;
+
+  // A free slot, or the one used least recently that cannot be on screen any more
+  Oldest = XFont.Frame;
+  for (Index = 0; Index < font->SlotCount; Index++)
+  {
+    if (font->Slots[Index].Code == XFONT_FREE)
+    {
+      Victim = (int)Index;
+      break;
+    }
+    if ((font->Slots[Index].LastUse + 1 < XFont.Frame) && (font->Slots[Index].LastUse < Oldest))
+    {
+      Oldest = font->Slots[Index].LastUse;
+      Victim = (int)Index;
+    }
+  }
+  if (Victim < 0)
+    return -1;
+
+  if (font->Slots[Victim].Code == XFONT_FREE)
+    XFont.Stats.Resident++;
+  else
+    XFont.Stats.Evicted++;
+  font->Slots[Victim].Code = code;
+  font->Slots[Victim].LastUse = XFont.Frame;
+
+  wrN(font->GlyphAddress + SlotCode(Victim) * font->Stride, font->Glyphs + Offset, font->Stride);
+  wr8(font->WidthAddress + SlotCode(Victim), font->Source[WidthTable + code % XFONT_PAGE]);
+  XFont.Stats.Loaded++;
+  XFont.Stats.BytesSent += font->Stride + 1;
+  return Victim;
+}
+
+static uint32_t DecodeUTF8(const uint8_t **str)
+{
+  const uint8_t *Get = *str;
+  uint32_t Code = *Get++, Follow = 0;
+
+  if ((Code & 0xE0) == 0xC0)
+  {
+    Code &= 0x1F;
+    Follow = 1;
+  }
+  else if ((Code & 0xF0) == 0xE0)
+  {
+    Code &= 0x0F;
+    Follow = 2;
+  }
+  else if ((Code & 0xF8) == 0xF0)
+  {
+    Code &= 0x07;
+    Follow = 3;
+  }
+  while (Follow-- && ((*Get & 0xC0) == 0x80))
+    Code = (Code << 6) | (*Get++ & 0x3F);
+  *str = Get;
+  return Code;
+}
+
+static uint32_t EncodeUTF8(char *buff, uint32_t code)
+{
+  if (code < 0x80)
+  {
+    buff[0] = (char)code;
+    return 1;
+  }
+  if (code < 0x800)
+  {
+    buff[0] = (char)(0xC0 | (code >> 6));
+    buff[1] = (char)(0x80 | (code & 0x3F));
+    return 2;
+  }
+  buff[0] = (char)(0xE0 | (code >> 12));
+  buff[1] = (char)(0x80 | ((code >> 6) & 0x3F));
+  buff[2] = (char)(0x80 | (code & 0x3F));
+  return 3;
+}
+
+// Page in the glyphs of str and rewrite it to slot code points.  The result has to be freed.
+static char *Translate(XFont_Font *font, const char *str, bool *complete)
+{
+  const uint8_t *Get = (const uint8_t *)str;
+  char *Result = (char *)malloc(strlen(str) * 3 + 1), *Put = Result;
+  uint32_t Code;
+  int Slot;
+
+  *complete = true;
+  if (!Result)
+    return NULL;
+  while (*Get)
+  {
+    Code = DecodeUTF8(&Get);
+    if (Code == '\n')
+    {
+      *Put++ = '\n';
+      continue;
+    }
+    Slot = PageIn(font, Code);
+    if (Slot < 0)
+    {
+      XFont.Stats.Missing++;
+      *complete = false;
+      continue;
+    }
+    Put += EncodeUTF8(Put, SlotCode(Slot));
+  }
+  *Put = 0;
+  return Result;
+}
+
+bool XFont_Text(uint16_t x, uint16_t y, uint16_t font, uint16_t options, const char *str)
+{
+  XFont_Font *Font = FindFont(font);
+  bool Complete;
+  char *Text;
+
+  if (!Font)
+  {
+    Cmd_Text(x, y, font, options, str);
+    return true;
+  }
+  Text = Translate(Font, str, &Complete);
+  if (!Text)
+    return false;
+  Cmd_Text(x, y, font, options, Text);
+  free(Text);
+  return Complete;
+}
+
+bool XFont_Button(uint16_t x,
+                  uint16_t y,
+                  uint16_t w,
+                  uint16_t h,
+                  uint16_t font,
+                  uint16_t options,
+                  const char *str)
+{
+  XFont_Font *Font = FindFont(font);
+  bool Complete;
+  char *Text;
+
+  if (!Font)
+  {
+    Cmd_Button(x, y, w, h, font, options, str);
+    return true;
+  }
+  Text = Translate(Font, str, &Complete);
+  if (!Text)
+    return false;
+  Cmd_Button(x, y, w, h, font, options, Text);
+  free(Text);
+  return Complete;
+}
+
+void XFont_NextFrame(void)
+{
+  XFont.Frame++;
+}
+
+void XFont_GetStats(XFont_Stats *stats)
+{
+  *stats = XFont.Stats;
+}
+
+void XFont_ResetStats(void)
+{
+  uint32_t Resident = XFont.Stats.Resident;
+
+  memset(&XFont.Stats, 0, sizeof(XFont.Stats));
+  XFont.Stats.Resident = Resident;
+}
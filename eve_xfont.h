@@ -0,0 +1,102 @@
+#ifndef __EVE_XFONT_H
+#define __EVE_XFONT_H
+
+// Glyph paging for extended fonts (xfont)
+//
+// Large fonts - CJK, icon sets, big ASTC fonts - take far more RAM_G than the handful of glyphs
+// a screen shows.  Instead of uploading the whole glyph file, XFont_Load() sets up a font in RAM_G
+// with a fixed number of glyph slots and keeps the xfont and glyph data on the host.  Strings
+// drawn with XFont_Text() / XFont_Button() are scanned first: every character not resident yet
+// is copied into a free slot, and the string is rewritten to the slot numbers before it goes to
+// the coprocessor.  When all slots are taken the glyphs used least recently are paged out again.
+//
+// Slot fonts are plain xfonts, so everything the coprocessor does with a font works on them.
+// The code points the coprocessor sees are slot numbers though, so only text drawn through this
+// module comes out right.
+//
+//   XFont_Load(1, RAM_G, 64 * 1024, font_xfont, sizeof(font_xfont), font_glyph,
+//              sizeof(font_glyph));
+//   ...
+//   Send_CMD(CMD_DLSTART);
+//   XFont_SetFont(1);
+//   XFont_Text(10, 10, 1, 0, "Hello");
+//   Send_CMD(DISPLAY());
+//   Send_CMD(CMD_SWAP);
+//   UpdateFIFO();
+//   XFont_NextFrame();
+//
+// Extended font header, all values little endian 32 bit (see CMD_SETFONT2 in the BT81x Series
+// Programming Guide):
+//   0  signature (XFONT_SIGNATURE)   20 layout_height          40 gptr[pages]
+//   4  size                          24 pixel_width               wptr[pages]
+//   8  format                        28 pixel_height              width tables, 128 bytes each
+//   12 swizzle                       32 start_of_graphic_data
+//   16 layout_width                  36 number_of_characters
+// Each page of 128 code points has its glyphs layout_width * layout_height bytes apart starting at
+// start_of_graphic_data + gptr[page], and its widths at wptr[page] in the header.
+
+#include "eve.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define XFONT_SIGNATURE 0x0100AAFFUL
+#define XFONT_MAX_FONTS 4    // Paged fonts loaded at the same time
+#define XFONT_MAX_SLOTS 2048 // Glyph slots of one font
+
+  typedef struct
+  {
+    uint32_t Resident;   // Glyphs in RAM_G now
+    uint32_t Loaded;     // Glyphs uploaded since XFont_ResetStats
+    uint32_t Evicted;    // Glyphs paged out to make room for others
+    uint32_t Missing;    // Characters dropped because no slot was free or the font lacks them
+    uint32_t BytesSent;  // Font header, glyph and width bytes written to RAM_G
+  } XFont_Stats;
+
+  // Set up a paged font for bitmap handle handle in RAM_G at address, using at most budget bytes
+  // for the font header and the glyph slots.  xfont and glyphs are the font files from the EVE
+  // Asset Builder and have to stay valid until XFont_Unload.  Returns false when the xfont is
+  // not valid or the budget does not hold a single glyph.
+  bool EVE_EXPORT XFont_Load(uint32_t handle,
+                             uint32_t address,
+                             uint32_t budget,
+                             const uint8_t *xfont,
+                             uint32_t xfontSize,
+                             const uint8_t *glyphs,
+                             uint32_t glyphSize);
+
+  // Forget a paged font, its RAM_G area may be reused after the next frame
+  void EVE_EXPORT XFont_Unload(uint32_t handle);
+
+  // Number of glyph slots of a paged font, 0 if handle is not one
+  uint32_t EVE_EXPORT XFont_Slots(uint32_t handle);
+
+  // Register the font with the current display list (CMD_SETFONT2)
+  void EVE_EXPORT XFont_SetFont(uint32_t handle);
+
+  // Cmd_Text / Cmd_Button for UTF-8 strings.  Glyphs of a paged font are paged in as needed,
+  // other fonts are passed through unchanged.  Returns false if characters had to be dropped.
+  bool EVE_EXPORT
+  XFont_Text(uint16_t x, uint16_t y, uint16_t font, uint16_t options, const char *str);
+  bool EVE_EXPORT XFont_Button(uint16_t x,
+                               uint16_t y,
+                               uint16_t w,
+                               uint16_t h,
+                               uint16_t font,
+                               uint16_t options,
+                               const char *str);
+
+  // Call once per displayed frame (after CMD_SWAP).  Glyphs used in the current or the previous
+  // frame may still be on screen and are never paged out.
+  void EVE_EXPORT XFont_NextFrame(void);
+
+  void EVE_EXPORT XFont_GetStats(XFont_Stats *stats);
+  void EVE_EXPORT XFont_ResetStats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -8,6 +8,9 @@ extern "C"
 #include <stdbool.h>
 #include <stdint.h>
 
+  /* Every platform HAL provides these.  HAL_DelayUs, HAL_TimeUs, HAL_Eve_Open and HAL_Eve_Lost
+   * came later; eve.c has weak stand-ins for them where the compiler supports it (GCC, Clang). */
+
   /* HAL_SPI_Enable() is to drive the CS Pin to the eve HIGH */
   void HAL_SPI_Enable(void);
 
@@ -26,12 +29,66 @@ extern "C"
   /* Stall the cpu for X milliseconds */
   void HAL_Delay(uint32_t milliSeconds);
 
+  /* Stall the cpu for X microseconds, at least */
+  void HAL_DelayUs(uint32_t microSeconds);
+
+  /* Free running microsecond counter, used for timeouts - only differences matter */
+  uint32_t HAL_TimeUs(void);
+
+  /* Opens the connection to the EVE without resetting it, leaving it running */
+  int HAL_Eve_Open(void);
+
   /* Gives an opertunity to reset the EVE hardware */
   int HAL_Eve_Reset_HW(void);
 
   /* Cleans up and resources allocated */
   void HAL_Close(void);
 
+  /* Non-zero once the bridge stopped answering - transfers failed or timed out a few times in a
+   * row, or the device went away.  Transfers are dropped from then on instead of each failing
+   * slowly, until HAL_Eve_Open succeeds again. */
+  int HAL_Eve_Lost(void);
+
+  /* Host bridges that can drive several EVEs at once.  The functions above work on the default
+   * bridge; these take the device handle from HAL_Bridge_Get and match the members of EVE_Hal
+   * in eve.h, so a context can talk through any of the bridges. */
+  typedef struct
+  {
+    char Serial[16];
+    char Description[64];
+    uint32_t Location; /* Where the bridge is plugged in, stable while the cabling stays */
+  } HAL_BridgeInfo;
+
+  typedef struct
+  {
+    uint32_t Transfers; /* USB writes and reads */
+    uint32_t Errors;
+    uint64_t BytesWritten;
+    uint64_t BytesRead;
+    uint64_t BusyUs; /* Time spent in the transfers, BytesWritten / BusyUs is the throughput */
+  } HAL_BridgeStats;
+
+  /* Fills in up to max bridges and returns how many there are */
+  int HAL_Bridge_List(HAL_BridgeInfo *list, int max);
+
+  /* A handle for the bridge with that serial number, or else that location, or else the first
+   * one found when serial is NULL and location 0.  Nothing is opened yet.  A bridge that has
+   * to be looked up by channel is looked for among those of the last HAL_Bridge_List, if there
+   * was one, so several handles take a single search of the USB bus before their threads start. */
+  void *HAL_Bridge_Get(const char *serial, uint32_t location);
+  void HAL_Bridge_Free(void *device);
+
+  int HAL_Bridge_Open(void *device);  /* As HAL_Eve_Open */
+  int HAL_Bridge_Reset(void *device); /* As HAL_Eve_Reset_HW */
+  void HAL_Bridge_Close(void *device);
+  void HAL_Bridge_SPI_Enable(void *device);
+  void HAL_Bridge_SPI_Disable(void *device);
+  uint8_t HAL_Bridge_SPI_Write(void *device, uint8_t data);
+  void HAL_Bridge_SPI_WriteBuffer(void *device, uint8_t *Buffer, uint32_t Length);
+  void HAL_Bridge_SPI_ReadBuffer(void *device, uint8_t *Buffer, uint32_t Length);
+  void HAL_Bridge_GetStats(void *device, HAL_BridgeStats *stats);
+  int HAL_Bridge_Lost(void *device); /* As HAL_Eve_Lost */
+
 #ifdef __cplusplus
 }
 #endif
@@ -2,8 +2,12 @@
 #include <conio.h>
 #endif
 #include "eve.h"
+#include "eve_calibrate.h"
+#include "eve_events.h"
 #include "hw_api.h"
 
+#define CALIBRATION_FILE "touch.cal"
+
 // MakeScreen_MatrixOrbital draws a blue dot in the center screen, along
 // with the text "MATRIX ORBITAL"
 void MakeScreen_MatrixOrbital(uint8_t DotSize)
@@ -46,10 +50,15 @@ void MakeScreen_MatrixOrbital(uint8_t DotSize)
   UpdateFIFO();
 }
 
-// A calibration screen for the touch digitizer
+// A calibration screen for the touch digitizer, only shown when there is no saved calibration
 void Calibrate(void)
 {
-  Calibrate_Manual(Display_Width(), Display_Height(), Display_VOffset(), Display_HOffset());
+  if (Calibrate_Load(CALIBRATION_FILE))
+    return;
+  Calibrate_Start(CALIBRATE_POINTS);
+  while (Calibrate_Poll() == CALIBRATE_BUSY)
+    HAL_Delay(1);
+  Calibrate_Save(CALIBRATION_FILE);
 }
 
 // A Clear screen function
@@ -83,6 +92,9 @@ int main()
 
   MakeScreen_MatrixOrbital(30); // Draw the Matrix Orbital Screen
   uint8_t pressed = 0;
+  Touch_Event Event;
+
+  Events_Init(EVENTS_DEFAULT_MASK);
 
   while (1)
   {
@@ -90,7 +102,10 @@ int main()
     if (_kbhit())
       break;
 #endif
-    uint8_t Tag = rd8(REG_TOUCH_TAG + RAM_REG); // Check for touches
+    // Wait for touches - the bus stays quiet until EVE flags one
+    if (!Events_Wait(&Event, 100000))
+      continue;
+    uint8_t Tag = (Event.Type == EVENT_UP) ? 0 : Event.Tag;
     switch (Tag)
     {
     case 1:
@@ -109,5 +124,6 @@ int main()
       break;
     }
   }
+  Events_Stop();
   HAL_Close();
 }
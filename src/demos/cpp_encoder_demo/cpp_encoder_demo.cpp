@@ -0,0 +1,37 @@
+// A screen encoded at compile time with eve.hpp.  Splash is a constexpr array of bytes: the
+// compiler encodes every instruction and command, an argument out of range for its field does not
+// build, and at runtime the whole screen goes to the command FIFO in one burst.
+
+#include "eve.h"
+#include "eve.hpp"
+#include "hw_api.h"
+#include <stdio.h>
+
+// The encoders agree with the macros of eve.h
+static_assert(eve::dl::Vertex2F(-5, 7) == VERTEX2F(-5, 7), "VERTEX2F encoding");
+static_assert(eve::dl::ColorRGB(255, 128, 0) == COLOR_RGB(255, 128, 0), "COLOR_RGB encoding");
+
+static constexpr auto Splash =
+    eve::Blob(eve::Sequence(eve::cmd::DlStart(),
+                            eve::dl::ClearColorRGB(0, 0, 64),
+                            eve::dl::Clear(true, true, true),
+                            eve::dl::ColorRGB(255, 255, 255),
+                            eve::cmd::Text(10, 10, 28, 0, "Encoded at compile time"),
+                            eve::dl::Display(),
+                            eve::cmd::Swap()));
+// Six single words, then CMD_TEXT with its 2 argument words and the string in 6
+static_assert(Splash.size() == 4 * (6 + 3 + 6), "Splash encoding");
+
+int main()
+{
+  // Initialize the EVE graphics controller
+  if (EVE_Init(DEMO_DISPLAY, DEMO_BOARD, DEMO_TOUCH) <= 1)
+  {
+    printf("ERROR: Eve not detected.\n");
+    return -1;
+  }
+  eve::Send(Splash);
+  Wait4CoProFIFOEmpty();
+  HAL_Close();
+  return 0;
+}
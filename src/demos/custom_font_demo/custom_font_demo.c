@@ -4,6 +4,7 @@
 #include "MONOSPACE821BT_64_ASTC.glyph.h"
 #include "MONOSPACE821BT_64_ASTC.xfont.h"
 #include "eve.h"
+#include "eve_xfont.h"
 #include "hw_api.h"
 
 void MakeScreen_HelloWorld()
@@ -17,13 +18,14 @@ void MakeScreen_HelloWorld()
   // Clear the screen
   Send_CMD(CLEAR(1, 1, 1));
   Send_CMD(COLOR_RGB(255, 255, 255));
-  // Select the custom font for font 1, the xfont data is written at RAM_G
-  Cmd_SetFont2(1, RAM_G, 0);
-  Cmd_Text(Display_Width() / 2,
-           Display_VOffset() + (Display_Height() / 2),
-           1,
-           OPT_CENTER,
-           "MONOSPACE\n821BT_64");
+  // Select the custom font for font 1, the slot font is set up at RAM_G
+  XFont_SetFont(1);
+  // Only the glyphs of this string are uploaded
+  XFont_Text(Display_Width() / 2,
+             Display_VOffset() + (Display_Height() / 2),
+             1,
+             OPT_CENTER,
+             "MONOSPACE\n821BT_64");
   // End the display list
   Send_CMD(DISPLAY());
   // Swap commands into RAM
@@ -40,16 +42,22 @@ int main()
     return -1;
   }
 
-  StartCoProTransfer(RAM_G, 0);
-  HAL_SPI_WriteBuffer((uint8_t *)&MONOSPACE821BT_64_ASTC_xfont,
-                      sizeof(MONOSPACE821BT_64_ASTC_xfont));
-  HAL_SPI_Disable();
-
-  StartCoProTransfer(RAM_G + 4096, 0);
-  HAL_SPI_WriteBuffer((uint8_t *)&MONOSPACE821BT_64_ASTC_glyph,
-                      sizeof(MONOSPACE821BT_64_ASTC_glyph));
-  HAL_SPI_Disable();
+  // A screen uses a few characters of the font, so give it 32K of RAM_G rather than the 64K of the
+  // whole glyph file and page glyphs in as the text needs them
+  if (!XFont_Load(1,
+                  RAM_G,
+                  32 * 1024,
+                  MONOSPACE821BT_64_ASTC_xfont,
+                  sizeof(MONOSPACE821BT_64_ASTC_xfont),
+                  MONOSPACE821BT_64_ASTC_glyph,
+                  sizeof(MONOSPACE821BT_64_ASTC_glyph)))
+  {
+    printf("ERROR: cannot set up the font.\n");
+    HAL_Close();
+    return -1;
+  }
 
   MakeScreen_HelloWorld();
+  XFont_NextFrame();
   HAL_Close();
 }
@@ -2,6 +2,7 @@
 #include <conio.h>
 #endif
 #include "eve.h"
+#include "eve_mediafifo.h"
 #include "hw_api.h"
 #include <stdio.h>
 
@@ -537,14 +538,18 @@ void DrawLogoPNG()
 {
   uint32_t Reference = 0; // Reference ID for the bitmap we will be using
 
-  // Loading the Image
-  Send_CMD(CMD_LOADIMAGE); // Tell the CoProcessor to prepare for compressed data
-  Send_CMD(RAM_G);         // This is the address where decompressed data will go
-  Send_CMD(0);             // Send options 0 = RGB565 for a jpeg image
-  CoProWrCmdBuf(matrix_orbital_png,
-                sizeof(matrix_orbital_png)); // write image to the coprocessor
-  Wait4CoProFIFOEmpty(); // wait here until the coprocessor has read and executed every pending
-                         // command.
+  // Loading the Image - the image data streams through the media FIFO near the top of RAM_G, so
+  // the command FIFO stays free for other work while it is decoded.
+  if (!MediaFifo_Init(MEDIAFIFO_DEFAULT_ADDRESS, MEDIAFIFO_DEFAULT_SIZE) ||
+      !MediaFifo_LoadImage(RAM_G,
+                           0, // Options 0 = RGB565 for a jpeg image
+                           matrix_orbital_png,
+                           sizeof(matrix_orbital_png)))
+  {
+    printf("ERROR: Loading the logo failed.\n");
+    CoProFIFO_WaitEmpty(); // Recover from the fault, if that was it
+    return;
+  }
 
   int props_start_address = FifoWriteLocation; // the CMD_GETPROPS command will write the results
                                                // into the fifo buffer, so we have to keep track
@@ -0,0 +1,524 @@
+// Flash image builder - packs assets into an EVE flash image with a manifest (see eve_assets.h)
+//
+// flash_image_builder [-b blob] [-o image.bin] [-H assets.h] spec.txt
+//   -b <blob>   flash blob for the first sector, without it the image starts at the manifest
+//               (flash address 4096) and the blob already in the flash is kept
+//   -o <file>   image to write (default flash_image.bin)
+//   -H <file>   header to generate with the asset names and locations
+//
+// The spec lists one asset per line, file names are relative to the spec (the blob of -b is
+// taken as given):
+//
+//   # name   type    file(s)             options
+//   logo     bitmap  logo_astc.raw       format=ASTC_4x4 width=64 height=64
+//   icons    bitmap  icons_argb4.raw     format=ARGB4 width=32 height=320 deflate
+//   photo    image   photo.jpg           format=RGB565 width=320 height=240
+//   mono     font    mono.xfont mono.glyph
+//   menu     dl      menu.dl
+//   strings  blob    strings.bin         deflate
+//
+// Types are bitmap (raw bitmap data), image (JPEG/PNG for CMD_LOADIMAGE), font (xfont and glyph
+// files from the EVE Asset Builder), dl (display list commands for CMD_APPEND) and blob.  Every
+// asset starts on an ASSET_ALIGN boundary, so it can be read with CMD_FLASHREAD or rendered in
+// place.  "deflate" stores the data zlib compressed (needs zlib, otherwise it is ignored).
+
+#include "eve_assets.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(EVE_HAVE_ZLIB)
+#include <zlib.h>
+#endif
+
+#define MAX_ASSETS 1024
+#define MAX_LINE 1024
+
+typedef struct
+{
+  Asset_Entry Entry;
+  uint8_t *Data;
+  uint32_t Size;
+} Builder_Asset;
+
+typedef struct
+{
+  const char *Name;
+  uint16_t Format;
+} Builder_Format;
+
+static const Builder_Format Formats[] = {
+    {"ARGB1555", ARGB1555},
+    {"L1", L1},
+    {"L2", L2},
+    {"L4", L4},
+    {"L8", L8},
+    {"RGB332", RGB332},
+    {"ARGB2", ARGB2},
+    {"ARGB4", ARGB4},
+    {"RGB565", RGB565},
+    {"PALETTED565", PALETTED565},
+    {"PALETTED4444", PALETTED4444},
+    {"PALETTED8", PALETTED8},
+    {"ASTC_4x4", COMPRESSED_RGBA_ASTC_4x4_KHR},
+    {"ASTC_5x4", COMPRESSED_RGBA_ASTC_5x4_KHR},
+    {"ASTC_5x5", COMPRESSED_RGBA_ASTC_5x5_KHR},
+    {"ASTC_6x5", COMPRESSED_RGBA_ASTC_6x5_KHR},
+    {"ASTC_6x6", COMPRESSED_RGBA_ASTC_6x6_KHR},
+    {"ASTC_8x5", COMPRESSED_RGBA_ASTC_8x5_KHR},
+    {"ASTC_8x6", COMPRESSED_RGBA_ASTC_8x6_KHR},
+    {"ASTC_8x8", COMPRESSED_RGBA_ASTC_8x8_KHR},
+    {"ASTC_10x5", COMPRESSED_RGBA_ASTC_10x5_KHR},
+    {"ASTC_10x6", COMPRESSED_RGBA_ASTC_10x6_KHR},
+    {"ASTC_10x8", COMPRESSED_RGBA_ASTC_10x8_KHR},
+    {"ASTC_10x10", COMPRESSED_RGBA_ASTC_10x10_KHR},
+    {"ASTC_12x10", COMPRESSED_RGBA_ASTC_12x10_KHR},
+    {"ASTC_12x12", COMPRESSED_RGBA_ASTC_12x12_KHR},
+};
+
+static Builder_Asset Assets[MAX_ASSETS];
+static uint32_t AssetCount;
+static char SpecDir[MAX_LINE];
+
+static void Put32(uint8_t *buff, uint32_t value)
+{
+  buff[0] = (uint8_t)value;
+  buff[1] = (uint8_t)(value >> 8);
+  buff[2] = (uint8_t)(value >> 16);
+  buff[3] = (uint8_t)(value >> 24);
+}
+
+static void Put16(uint8_t *buff, uint16_t value)
+{
+  buff[0] = (uint8_t)value;
+  buff[1] = (uint8_t)(value >> 8);
+}
+
+static uint32_t Get32(const uint8_t *buff)
+{
+  return buff[0] | ((uint32_t)buff[1] << 8) | ((uint32_t)buff[2] << 16) |
+         ((uint32_t)buff[3] << 24);
+}
+
+// Same CRC-32 as CMD_MEMCRC and Flash_Crc32
+static uint32_t Crc32(const uint8_t *buff, uint32_t count)
+{
+  uint32_t Crc = 0xFFFFFFFFUL, Bit;
+
+  while (count--)
+  {
+    Crc ^= *buff++;
+    for (Bit = 0; Bit < 8; Bit++)
+      Crc = (Crc & 1) ? (Crc >> 1) ^ 0xEDB88320UL : Crc >> 1;
+  }
+  return ~Crc;
+}
+
+// Load dir followed by fileName, dir is SpecDir for the files of the spec and "" for the rest
+static uint8_t *LoadFile(const char *dir, const char *fileName, uint32_t *size)
+{
+  char Path[2 * MAX_LINE];
+  uint8_t *Data;
+  long Length;
+  FILE *File;
+
+  snprintf(Path, sizeof(Path), "%s%s", dir, fileName);
+  File = fopen(Path, "rb");
+  if (!File)
+  {
+    printf("ERROR: cannot open %s\n", Path);
+    return NULL;
+  }
+  fseek(File, 0, SEEK_END);
+  Length = ftell(File);
+  fseek(File, 0, SEEK_SET);
+  Data = (uint8_t *)malloc(Length > 0 ? Length : 1);
+  if (Data && (fread(Data, 1, Length, File) != (size_t)Length))
+  {
+    free(Data);
+    Data = NULL;
+  }
+  fclose(File);
+  *size = (uint32_t)Length;
+  return Data;
+}
+
+static bool ParseFormat(const char *name, uint16_t *format)
+{
+  uint32_t Index;
+
+  for (Index = 0; Index < sizeof(Formats) / sizeof(Formats[0]); Index++)
+  {
+    if (!strcmp(Formats[Index].Name, name))
+    {
+      *format = Formats[Index].Format;
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool IsASTC(uint16_t format)
+{
+  return (format >= COMPRESSED_RGBA_ASTC_4x4_KHR) && (format <= COMPRESSED_RGBA_ASTC_12x12_KHR);
+}
+
+// Bytes of a decoded bitmap in RAM_G
+static uint32_t BitmapSize(uint16_t format, uint16_t width, uint16_t height)
+{
+  uint32_t Pixels = (uint32_t)width * height;
+
+  switch (format)
+  {
+  case L1:
+    return (width + 7) / 8 * (uint32_t)height;
+  case L2:
+    return (width + 3) / 4 * (uint32_t)height;
+  case L4:
+    return (width + 1) / 2 * (uint32_t)height;
+  case L8:
+  case RGB332:
+  case ARGB2:
+    return Pixels;
+  case PALETTED8:
+    return Pixels + 1024; // Followed by the palette
+  default:
+    return Pixels * 2;
+  }
+}
+
+// Join an xfont with its glyphs.  start_of_graphic_data becomes the offset of the glyphs from
+// the start of the asset, the asset manager turns it back into an address when loading.
+static uint8_t *BuildFont(Asset_Entry *entry,
+                          const char *xfontName,
+                          const char *glyphName,
+                          uint32_t *size)
+{
+  uint8_t *XFont, *Glyphs, *Data;
+  uint32_t XFontSize, GlyphSize, Header;
+
+  XFont = LoadFile(SpecDir, xfontName, &XFontSize);
+  Glyphs = LoadFile(SpecDir, glyphName, &GlyphSize);
+  if (!XFont || !Glyphs || (XFontSize < 48))
+  {
+    free(XFont);
+    free(Glyphs);
+    return NULL;
+  }
+
+  Header = (XFontSize + ASSET_ALIGN - 1) & ~(ASSET_ALIGN - 1);
+  *size = Header + GlyphSize;
+  Data = (uint8_t *)calloc(*size, 1);
+  if (Data)
+  {
+    memcpy(Data, XFont, XFontSize);
+    memcpy(Data + Header, Glyphs, GlyphSize);
+    Put32(Data + 32, Header);
+    entry->Format = (uint16_t)Get32(XFont + 8);
+    entry->Width = (uint16_t)Get32(XFont + 24);  // pixel_width
+    entry->Height = (uint16_t)Get32(XFont + 28); // pixel_height
+    entry->DataOffset = Header;
+    // Glyphs of ASTC fonts are rendered from flash, only the header goes into RAM_G
+    entry->RawSize = IsASTC(entry->Format) ? XFontSize : *size;
+  }
+  free(XFont);
+  free(Glyphs);
+  return Data;
+}
+
+static bool ParseLine(char *line, int lineNumber)
+{
+  char *Token[16], *Part;
+  int Tokens = 0, Index, Files = 0;
+  const char *File[2] = {NULL, NULL};
+  Builder_Asset *Asset;
+  bool Deflate = false;
+  uint8_t *Data;
+
+  for (Part = strtok(line, " \t\r\n"); Part && (Tokens < 16); Part = strtok(NULL, " \t\r\n"))
+    Token[Tokens++] = Part;
+  if (!Tokens || (Token[0][0] == '#'))
+    return true;
+  if ((Tokens < 3) || (AssetCount == MAX_ASSETS) || (strlen(Token[0]) >= ASSET_NAME_SIZE))
+  {
+    printf("ERROR: line %d: expected <name> <type> <file> [options]\n", lineNumber);
+    return false;
+  }
+
+  Asset = &Assets[AssetCount];
+  memset(Asset, 0, sizeof(*Asset));
+  strcpy(Asset->Entry.Name, Token[0]);
+  if (!strcmp(Token[1], "bitmap"))
+    Asset->Entry.Type = ASSET_TYPE_BITMAP;
+  else if (!strcmp(Token[1], "image"))
+    Asset->Entry.Type = ASSET_TYPE_IMAGE;
+  else if (!strcmp(Token[1], "font"))
+    Asset->Entry.Type = ASSET_TYPE_FONT;
+  else if (!strcmp(Token[1], "dl"))
+    Asset->Entry.Type = ASSET_TYPE_DL;
+  else if (!strcmp(Token[1], "blob"))
+    Asset->Entry.Type = ASSET_TYPE_BLOB;
+  else
+  {
+    printf("ERROR: line %d: unknown type %s\n", lineNumber, Token[1]);
+    return false;
+  }
+
+  for (Index = 2; Index < Tokens; Index++)
+  {
+    if (!strcmp(Token[Index], "deflate"))
+      Deflate = true;
+    else if (!strncmp(Token[Index], "format=", 7))
+    {
+      if (!ParseFormat(Token[Index] + 7, &Asset->Entry.Format))
+      {
+        printf("ERROR: line %d: unknown format %s\n", lineNumber, Token[Index] + 7);
+        return false;
+      }
+    }
+    else if (!strncmp(Token[Index], "width=", 6))
+      Asset->Entry.Width = (uint16_t)atoi(Token[Index] + 6);
+    else if (!strncmp(Token[Index], "height=", 7))
+      Asset->Entry.Height = (uint16_t)atoi(Token[Index] + 7);
+    else if (Files < 2)
+      File[Files++] = Token[Index];
+  }
+
+  if (Asset->Entry.Type == ASSET_TYPE_FONT)
+  {
+    if (Files != 2)
+    {
+      printf("ERROR: line %d: a font needs an xfont and a glyph file\n", lineNumber);
+      return false;
+    }
+    Data = BuildFont(&Asset->Entry, File[0], File[1], &Asset->Size);
+    if (IsASTC(Asset->Entry.Format))
+      Deflate = false; // The glyphs are used in place
+  }
+  else
+  {
+    Data = File[0] ? LoadFile(SpecDir, File[0], &Asset->Size) : NULL;
+    Asset->Entry.RawSize = Asset->Size;
+    if (Asset->Entry.Type == ASSET_TYPE_IMAGE)
+    {
+      // What CMD_LOADIMAGE decodes it to, format= has to match the image
+      Asset->Entry.RawSize = BitmapSize(Asset->Entry.Format, Asset->Entry.Width,
+                                        Asset->Entry.Height);
+      Deflate = false;
+    }
+    else if ((Asset->Entry.Type == ASSET_TYPE_BITMAP) && IsASTC(Asset->Entry.Format))
+      Deflate = false; // ASTC is rendered in place
+  }
+  if (!Data)
+    return false;
+
+#if defined(EVE_HAVE_ZLIB)
+  if (Deflate)
+  {
+    uLongf Packed = compressBound(Asset->Size);
+    uint8_t *Compressed = (uint8_t *)malloc(Packed);
+
+    if (Compressed &&
+        (compress2(Compressed, &Packed, Data, Asset->Size, Z_BEST_COMPRESSION) == Z_OK))
+    {
+      free(Data);
+      Data = Compressed;
+      Asset->Size = (uint32_t)Packed;
+      Asset->Entry.Flags |= ASSET_FLAG_DEFLATED;
+    }
+    else
+      free(Compressed);
+  }
+#else
+  if (Deflate)
+    printf("WARNING: line %d: built without zlib, %s is stored uncompressed\n", lineNumber,
+           Asset->Entry.Name);
+#endif
+
+  Asset->Data = Data;
+  Asset->Entry.Size = Asset->Size;
+  Asset->Entry.Crc = Crc32(Data, Asset->Size);
+  AssetCount++;
+  return true;
+}
+
+static void WriteEntry(uint8_t *buff, const Asset_Entry *entry)
+{
+  memset(buff, 0, ASSET_ENTRY_SIZE);
+  memcpy(buff, entry->Name, strlen(entry->Name));
+  Put32(buff + 32, entry->Offset);
+  Put32(buff + 36, entry->Size);
+  Put32(buff + 40, entry->RawSize);
+  Put32(buff + 44, entry->Crc);
+  Put16(buff + 48, entry->Type);
+  Put16(buff + 50, entry->Format);
+  Put16(buff + 52, entry->Flags);
+  Put16(buff + 54, entry->Width);
+  Put16(buff + 56, entry->Height);
+  Put32(buff + 58, entry->DataOffset);
+}
+
+// name as part of a macro name: upper case, anything but letters and digits turned into '_'
+static void MacroName(char *macro, const char *name, size_t size)
+{
+  size_t Char;
+
+  for (Char = 0; name[Char] && (Char < size - 1); Char++)
+  {
+    macro[Char] = name[Char];
+    if ((macro[Char] >= 'a') && (macro[Char] <= 'z'))
+      macro[Char] -= 'a' - 'A';
+    else if (!(((macro[Char] >= 'A') && (macro[Char] <= 'Z')) ||
+               ((macro[Char] >= '0') && (macro[Char] <= '9'))))
+      macro[Char] = '_';
+  }
+  macro[Char] = 0;
+}
+
+static bool WriteHeader(const char *fileName, const char *specName, uint32_t base)
+{
+  FILE *File = fopen(fileName, "w");
+  const char *BaseName = fileName;
+  char Name[ASSET_NAME_SIZE], Guard[256];
+  const Asset_Entry *Entry;
+  uint32_t Index;
+
+  if (!File)
+    return false;
+
+  // The include guard goes by the file name of the header
+  if (strrchr(BaseName, '/'))
+    BaseName = strrchr(BaseName, '/') + 1;
+  if (strrchr(BaseName, '\\'))
+    BaseName = strrchr(BaseName, '\\') + 1;
+  MacroName(Guard, BaseName, sizeof(Guard));
+
+  fprintf(File, "// Generated by flash_image_builder from %s - do not edit\n\n", specName);
+  fprintf(File, "#ifndef __%s\n#define __%s\n\n", Guard, Guard);
+  fprintf(File, "#define FLASH_IMAGE_BASE 0x%06XUL // Flash address to program the image at\n",
+          (unsigned)base);
+  fprintf(File, "#define FLASH_IMAGE_ASSETS %u\n", (unsigned)AssetCount);
+  for (Index = 0; Index < AssetCount; Index++)
+  {
+    MacroName(Name, Assets[Index].Entry.Name, sizeof(Name));
+    Entry = &Assets[Index].Entry;
+    fprintf(File, "\n#define ASSET_%s \"%s\"\n", Name, Entry->Name);
+    fprintf(File, "#define ASSET_%s_OFFSET 0x%06XUL\n", Name, (unsigned)Entry->Offset);
+    fprintf(File, "#define ASSET_%s_SIZE %uUL\n", Name, (unsigned)Entry->Size);
+    fprintf(File, "#define ASSET_%s_RAWSIZE %uUL\n", Name, (unsigned)Entry->RawSize);
+    if (Entry->Width)
+    {
+      fprintf(File, "#define ASSET_%s_WIDTH %u\n", Name, Entry->Width);
+      fprintf(File, "#define ASSET_%s_HEIGHT %u\n", Name, Entry->Height);
+    }
+  }
+  fprintf(File, "\n#endif\n");
+  return fclose(File) == 0;
+}
+
+int main(int argc, char **argv)
+{
+  const char *BlobName = NULL, *ImageName = "flash_image.bin", *HeaderName = NULL;
+  const char *SpecName = NULL;
+  char Line[MAX_LINE];
+  uint8_t *Image, *Blob = NULL;
+  uint32_t Base, Offset, ManifestSize, BlobSize = 0, Index;
+  const char *Slash;
+  int Arg, LineNumber = 0;
+  bool Ok = true;
+  FILE *File;
+
+  for (Arg = 1; Arg < argc; Arg++)
+  {
+    if ((argv[Arg][0] == '-') && (Arg + 1 < argc) && !strcmp(argv[Arg], "-b"))
+      BlobName = argv[++Arg];
+    else if ((argv[Arg][0] == '-') && (Arg + 1 < argc) && !strcmp(argv[Arg], "-o"))
+      ImageName = argv[++Arg];
+    else if ((argv[Arg][0] == '-') && (Arg + 1 < argc) && !strcmp(argv[Arg], "-H"))
+      HeaderName = argv[++Arg];
+    else
+      SpecName = argv[Arg];
+  }
+  if (!SpecName)
+  {
+    printf("usage: flash_image_builder [-b blob] [-o image.bin] [-H assets.h] spec.txt\n");
+    return -1;
+  }
+
+  // Asset files are relative to the spec
+  Slash = strrchr(SpecName, '/');
+  if (!Slash)
+    Slash = strrchr(SpecName, '\\');
+  if (Slash && (Slash - SpecName + 1 < MAX_LINE))
+  {
+    memcpy(SpecDir, SpecName, Slash - SpecName + 1);
+    SpecDir[Slash - SpecName + 1] = 0;
+  }
+
+  File = fopen(SpecName, "r");
+  if (!File)
+  {
+    printf("ERROR: cannot open %s\n", SpecName);
+    return -1;
+  }
+  while (Ok && fgets(Line, sizeof(Line), File))
+    Ok = ParseLine(Line, ++LineNumber);
+  fclose(File);
+  if (!Ok)
+    return -1;
+
+  if (BlobName)
+  {
+    Blob = LoadFile("", BlobName, &BlobSize); // As given, not relative to the spec
+    if (!Blob || (BlobSize > ASSET_MANIFEST_OFFSET))
+    {
+      printf("ERROR: %s is not a flash blob\n", BlobName);
+      return -1;
+    }
+  }
+  Base = Blob ? 0 : ASSET_MANIFEST_OFFSET;
+
+  // Lay out the assets behind the manifest
+  ManifestSize = ASSET_HEADER_SIZE + AssetCount * ASSET_ENTRY_SIZE;
+  Offset = (ASSET_MANIFEST_OFFSET + ManifestSize + ASSET_ALIGN - 1) & ~(ASSET_ALIGN - 1);
+  for (Index = 0; Index < AssetCount; Index++)
+  {
+    Assets[Index].Entry.Offset = Offset;
+    Offset = (Offset + Assets[Index].Size + ASSET_ALIGN - 1) & ~(ASSET_ALIGN - 1);
+  }
+
+  Image = (uint8_t *)malloc(Offset - Base);
+  if (!Image)
+    return -1;
+  memset(Image, 0xFF, Offset - Base); // Like erased flash
+  if (Blob)
+    memcpy(Image, Blob, BlobSize);
+  Put32(Image + ASSET_MANIFEST_OFFSET - Base, ASSET_MANIFEST_MAGIC);
+  Put16(Image + ASSET_MANIFEST_OFFSET - Base + 4, ASSET_MANIFEST_VERSION);
+  Put16(Image + ASSET_MANIFEST_OFFSET - Base + 6, (uint16_t)AssetCount);
+  Put32(Image + ASSET_MANIFEST_OFFSET - Base + 8, ManifestSize);
+  Put32(Image + ASSET_MANIFEST_OFFSET - Base + 12, 0);
+  for (Index = 0; Index < AssetCount; Index++)
+  {
+    WriteEntry(Image + ASSET_MANIFEST_OFFSET - Base + ASSET_HEADER_SIZE + Index * ASSET_ENTRY_SIZE,
+               &Assets[Index].Entry);
+    memcpy(Image + Assets[Index].Entry.Offset - Base, Assets[Index].Data, Assets[Index].Size);
+  }
+
+  File = fopen(ImageName, "wb");
+  if (!File || (fwrite(Image, 1, Offset - Base, File) != Offset - Base) || fclose(File))
+  {
+    printf("ERROR: cannot write %s\n", ImageName);
+    return -1;
+  }
+  if (HeaderName && !WriteHeader(HeaderName, SpecName, Base))
+  {
+    printf("ERROR: cannot write %s\n", HeaderName);
+    return -1;
+  }
+  printf("%s: %u assets, %u bytes, program at 0x%06X\n",
+         ImageName,
+         (unsigned)AssetCount,
+         (unsigned)(Offset - Base),
+         (unsigned)Base);
+  return 0;
+}
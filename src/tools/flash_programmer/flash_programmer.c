@@ -0,0 +1,162 @@
+// Flash programmer - writes an image to the EVE flash, sending only the sectors that changed
+//
+// flash_programmer [options] image.bin
+//   -d <display>   display from displays.h, by name or id (default 43_480x272)
+//   -b <board>     board, EVE2, EVE3, EVE4 or the id (default EVE3)
+//   -t <touch>     touch, TPN, TPR, TPC or the id (default TPN)
+//   -a <address>   flash address to program at, a multiple of 4096 (default 4096, FLASH_IMAGE_BASE
+//                  of an image built without the blob - one with it goes to 0)
+//   -m <manifest>  sector CRCs of the last programming run - saves reading them from the device
+//                  and is updated after a successful run
+//   -r             ignore the manifest and compare against the device
+
+#include "eve.h"
+#include "eve_assets.h"
+#include "eve_flash.h"
+#include "eve_os.h"
+#include "hw_api.h"
+
+static void Usage(void)
+{
+  printf("usage: flash_programmer [-d display] [-b board] [-t touch] [-a address] "
+         "[-m manifest] [-r] image.bin\n");
+}
+
+static uint8_t *LoadFile(const char *fileName, uint32_t *size)
+{
+  uint8_t *Data;
+  long Length;
+  FILE *File = fopen(fileName, "rb");
+
+  if (!File)
+    return NULL;
+  fseek(File, 0, SEEK_END);
+  Length = ftell(File);
+  fseek(File, 0, SEEK_SET);
+  Data = (uint8_t *)malloc(Length > 0 ? Length : 1);
+  if (Data && (fread(Data, 1, Length, File) != (size_t)Length))
+  {
+    free(Data);
+    Data = NULL;
+  }
+  fclose(File);
+  *size = (uint32_t)Length;
+  return Data;
+}
+
+int main(int argc, char **argv)
+{
+  int Display = DISPLAY_43_480x272, Board = BOARD_EVE3, Touch = TOUCH_TPN;
+  uint32_t Address = ASSET_MANIFEST_OFFSET, Size, Sectors;
+  const char *ManifestName = NULL, *ImageName = NULL;
+  bool ReadDevice = false, Valid;
+  uint32_t *Crcs, *ManifestCrcs = NULL;
+  uint8_t *Image;
+  Flash_Stats Stats;
+  uint64_t Start;
+  int Arg;
+
+  for (Arg = 1; Arg < argc; Arg++)
+  {
+    if (!strcmp(argv[Arg], "-r"))
+      ReadDevice = true;
+    else if ((argv[Arg][0] == '-') && (Arg + 1 < argc))
+    {
+      Valid = true;
+      switch (argv[Arg][1])
+      {
+      case 'd':
+        Display = Display_Parse(argv[++Arg]);
+        Valid = Display_Find(Display) != NULL;
+        break;
+      case 'b':
+        Board = Display_Parse(argv[++Arg]);
+        Valid = (Board >= BOARD_EVE2) && (Board <= BOARD_EVE4);
+        break;
+      case 't':
+        Touch = Display_Parse(argv[++Arg]);
+        Valid = (Touch >= TOUCH_TPN) && (Touch <= TOUCH_TPC);
+        break;
+      case 'a':
+        Address = (uint32_t)strtoul(argv[++Arg], NULL, 0);
+        break;
+      case 'm':
+        ManifestName = argv[++Arg];
+        break;
+      default:
+        Usage();
+        return -1;
+      }
+      if (!Valid)
+      {
+        printf("ERROR: unknown %s %s\n", argv[Arg - 1], argv[Arg]);
+        return -1;
+      }
+    }
+    else
+      ImageName = argv[Arg];
+  }
+  if (!ImageName)
+  {
+    Usage();
+    return -1;
+  }
+
+  Image = LoadFile(ImageName, &Size);
+  if (!Image)
+  {
+    printf("ERROR: cannot read %s\n", ImageName);
+    return -1;
+  }
+  Sectors = (Size + FLASH_SECTOR_SIZE - 1) / FLASH_SECTOR_SIZE;
+  Crcs = (uint32_t *)malloc((Sectors ? Sectors : 1) * sizeof(uint32_t));
+
+  if (EVE_Init(Display, Board, Touch) <= 1)
+  {
+    printf("ERROR: Eve not detected.\n");
+    return -1;
+  }
+  if (!FlashAttach() || !FlashFast())
+  {
+    printf("ERROR: flash not attached or not in full speed mode (is the blob programmed?)\n");
+    HAL_Close();
+    return -1;
+  }
+
+  if (ManifestName && !ReadDevice)
+  {
+    ManifestCrcs = (uint32_t *)malloc((Sectors ? Sectors : 1) * sizeof(uint32_t));
+    if (Flash_LoadManifest(ManifestName, ManifestCrcs, Sectors) < Sectors)
+    {
+      printf("Manifest does not cover the image, comparing against the device\n");
+      free(ManifestCrcs);
+      ManifestCrcs = NULL;
+    }
+  }
+
+  Start = OS_TimeUs();
+  if (!Flash_Program(Address, Image, Size, ManifestCrcs, FLASH_STAGING_DEFAULT_ADDRESS, &Stats))
+  {
+    printf("ERROR: programming failed, %u sectors did not verify\n", (unsigned)Stats.VerifyErrors);
+    HAL_Close();
+    return -1;
+  }
+  printf("%u of %u sectors programmed, %u bytes sent in %.1f s\n",
+         (unsigned)Stats.Changed,
+         (unsigned)Stats.Sectors,
+         (unsigned)Stats.BytesSent,
+         (double)(OS_TimeUs() - Start) / 1000000);
+
+  if (ManifestName)
+  {
+    Flash_ImageCrcs(Image, Size, Crcs);
+    if (!Flash_SaveManifest(ManifestName, Crcs, Sectors))
+      printf("WARNING: cannot write %s\n", ManifestName);
+  }
+
+  free(Image);
+  free(Crcs);
+  free(ManifestCrcs);
+  HAL_Close();
+  return 0;
+}
@@ -1,105 +1,274 @@
+#include "hw_api.h"
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#ifndef _MSC_VER
+#include <time.h>
+#endif
 #define FT800_PD_N 7
+#define BRIDGE_TIMEOUT_MS 100 // USB transfers taking longer than this have failed
+#define BRIDGE_ERROR_LIMIT 3  // Failures in a row before the bridge counts as lost
+#define Log printf
 
 #include "ftd2xx.h"
 #include "libmpsse_spi.h"
 
-static FT_HANDLE handle;
+// One bridge, a channel of libMPSSE.  Location is the LocId of the channel, as reported by
+// HAL_Bridge_List.
+typedef struct
+{
+  FT_HANDLE Handle;
+  char Serial[16];
+  uint32_t Location;
+  int Channel; // Of libMPSSE, -1 if the bridge is not there
+  bool Found;  // Channel is set, by HAL_Bridge_Get or the first HAL_Bridge_Open
+  HAL_BridgeStats Stats;
+  uint32_t ErrorRun; // Failed transfers since the last good one
+  bool Lost;         // Transfers are dropped until the next HAL_Bridge_Open
+} Bridge;
+
+static Bridge Default; // The bridge of the HAL_ functions without a device
+
+// libMPSSE keeps one list of channels for the process, which is not to be built again by several
+// threads at once.  It is built by HAL_Bridge_List and by whatever needs it first, and the
+// bridges of HAL_Bridge_Get take their channel from it, so threads opening them leave it alone.
+static bool Enumerated;
+static uint32_t Channels;
 
 FT_HANDLE GetFTDIHandle()
 {
-  return handle;
+  return Default.Handle;
 }
 
-void HAL_Close(void)
+static uint64_t NowUs(void)
+{
+#ifdef _MSC_VER
+  LARGE_INTEGER Count, Freq;
+
+  QueryPerformanceCounter(&Count);
+  QueryPerformanceFrequency(&Freq);
+  return (uint64_t)(Count.QuadPart / Freq.QuadPart) * 1000000 +
+         (uint64_t)(Count.QuadPart % Freq.QuadPart) * 1000000 / Freq.QuadPart;
+#else
+  struct timespec Now;
+
+  clock_gettime(CLOCK_MONOTONIC, &Now);
+  return (uint64_t)Now.tv_sec * 1000000 + (uint64_t)(Now.tv_nsec / 1000);
+#endif
+}
+
+// A bridge that stopped answering fails every transfer after a timeout.  Once it is lost
+// transfers are dropped right away instead, until it is opened again.
+static void Done(Bridge *bridge, FT_STATUS status)
 {
-  if (handle)
+  if (status == FT_OK)
   {
-    SPI_CloseChannel(handle);
-    handle = NULL;
+    bridge->ErrorRun = 0;
+    return;
   }
+  bridge->Stats.Errors++;
+  if ((++bridge->ErrorRun < BRIDGE_ERROR_LIMIT) && (status != FT_DEVICE_NOT_FOUND) &&
+      (status != FT_IO_ERROR))
+    return;
+  if (!bridge->Lost)
+    Log("USB->SPI Bridge lost\n");
+  bridge->Lost = true;
 }
 
-void HAL_SPI_Enable(void)
+// Every SPI transfer goes through these two, for the statistics
+static void Write(Bridge *bridge, uint8_t *buffer, uint32_t length)
 {
-  SPI_ToggleCS(handle, 1);
+  uint32_t SizeTransfered = 0;
+  uint64_t Start = NowUs();
+  FT_STATUS Status;
+
+  if (bridge->Lost)
+    return;
+  Status =
+      SPI_Write(bridge->Handle, buffer, length, &SizeTransfered, SPI_TRANSFER_OPTIONS_SIZE_IN_BYTES);
+  bridge->Stats.BusyUs += NowUs() - Start;
+  bridge->Stats.Transfers++;
+  bridge->Stats.BytesWritten += SizeTransfered;
+  Done(bridge, Status);
 }
 
-void HAL_SPI_Disable(void)
+static void Read(Bridge *bridge, uint8_t *buffer, uint32_t length)
 {
-  SPI_ToggleCS(handle, 0);
+  uint32_t SizeTransfered = 0;
+  uint64_t Start = NowUs();
+  FT_STATUS Status;
+
+  if (bridge->Lost)
+  {
+    memset(buffer, 0, length);
+    return;
+  }
+  Status =
+      SPI_Read(bridge->Handle, buffer, length, &SizeTransfered, SPI_TRANSFER_OPTIONS_SIZE_IN_BYTES);
+  bridge->Stats.BusyUs += NowUs() - Start;
+  bridge->Stats.Transfers++;
+  bridge->Stats.BytesRead += SizeTransfered;
+  Done(bridge, Status);
 }
 
-uint8_t HAL_SPI_Write(uint8_t data)
+// Build the list of channels again, returns how many there are
+static uint32_t Enumerate(void)
 {
-  uint32_t SizeTransfered = 0;
-  SPI_Write(handle, &data, 1, &SizeTransfered, SPI_TRANSFER_OPTIONS_SIZE_IN_BYTES);
-  return 0;
+  static bool Started;
+
+  if (!Started)
+  {
+#ifndef _MSC_VER
+    FT_SetVIDPID(0x1b3d, 0x0200);
+#endif
+    Init_libMPSSE();
+    Started = true;
+  }
+  Channels = 0;
+  if (SPI_GetNumChannels(&Channels) != FT_OK)
+    Channels = 0;
+  Log("channels found : %u\n", (unsigned)Channels);
+  Enumerated = true;
+  return Channels;
 }
 
-uint8_t HAL_SPI_WriteByte(uint8_t data)
+int HAL_Bridge_List(HAL_BridgeInfo *list, int max)
+{
+  uint32_t total_channels = Enumerate(), ichan;
+  FT_DEVICE_LIST_INFO_NODE devList;
+
+  for (ichan = 0; (ichan < total_channels) && (ichan < (uint32_t)max); ichan++)
+  {
+    memset(&list[ichan], 0, sizeof(list[ichan]));
+    if (SPI_GetChannelInfo(ichan, &devList) != FT_OK)
+      continue;
+    strncpy(list[ichan].Serial, devList.SerialNumber, sizeof(list[ichan].Serial) - 1);
+    strncpy(list[ichan].Description, devList.Description, sizeof(list[ichan].Description) - 1);
+    list[ichan].Location = devList.LocId;
+  }
+  return (int)total_channels;
+}
+
+// The channel of the bridge: by serial number, by location, or SPICHANNEL / the first one
+static int FindChannel(const Bridge *bridge, uint32_t total_channels)
+{
+  FT_DEVICE_LIST_INFO_NODE devList;
+  const char *channel;
+  uint32_t ichan;
+
+  if (!bridge->Serial[0] && !bridge->Location)
+  {
+    channel = getenv("SPICHANNEL");
+    ichan = channel ? (uint32_t)atoi(channel) : 0;
+    return (ichan < total_channels) ? (int)ichan : -1;
+  }
+  for (ichan = 0; ichan < total_channels; ichan++)
+  {
+    if (SPI_GetChannelInfo(ichan, &devList) != FT_OK)
+      continue;
+    if (bridge->Serial[0] ? !strcmp(devList.SerialNumber, bridge->Serial)
+                          : (devList.LocId == bridge->Location))
+      return (int)ichan;
+  }
+  return -1;
+}
+
+void *HAL_Bridge_Get(const char *serial, uint32_t location)
+{
+  Bridge *New = (Bridge *)calloc(1, sizeof(Bridge));
+
+  if (!New)
+    return NULL;
+  if (serial)
+    strncpy(New->Serial, serial, sizeof(New->Serial) - 1);
+  New->Location = location;
+  New->Channel = FindChannel(New, Enumerated ? Channels : Enumerate());
+  New->Found = true;
+  return New;
+}
+
+void HAL_Bridge_Free(void *device)
 {
-  uint32_t SizeTransfered;
-  SPI_Write(handle, &data, 1, &SizeTransfered, SPI_TRANSFER_OPTIONS_SIZE_IN_BYTES);
+  HAL_Bridge_Close(device);
+  if (device != &Default)
+    free(device);
+}
+
+void HAL_Bridge_Close(void *device)
+{
+  Bridge *Dev = (Bridge *)device;
+
+  if (Dev->Handle)
+  {
+    SPI_CloseChannel(Dev->Handle);
+    Dev->Handle = NULL;
+  }
+}
+
+void HAL_Bridge_SPI_Enable(void *device)
+{
+  Bridge *Dev = (Bridge *)device;
+
+  if (!Dev->Lost)
+    Done(Dev, SPI_ToggleCS(Dev->Handle, 1));
+}
+
+void HAL_Bridge_SPI_Disable(void *device)
+{
+  Bridge *Dev = (Bridge *)device;
+
+  if (!Dev->Lost)
+    Done(Dev, SPI_ToggleCS(Dev->Handle, 0));
+}
+
+uint8_t HAL_Bridge_SPI_Write(void *device, uint8_t data)
+{
+  Write((Bridge *)device, &data, 1);
   return 0;
 }
 
-uint8_t HAL_SPI_ReadByte(uint8_t data)
+void HAL_Bridge_SPI_WriteBuffer(void *device, uint8_t *Buffer, uint32_t Length)
 {
-  uint8_t res;
-  uint32_t SizeTransfered;
-  SPI_Read(handle, &res, 1, &SizeTransfered, SPI_TRANSFER_OPTIONS_SIZE_IN_BYTES);
-  return res;
+  Write((Bridge *)device, Buffer, Length);
 }
 
-void HAL_SPI_WriteBuffer(uint8_t *Buffer, uint32_t Length)
+void HAL_Bridge_SPI_ReadBuffer(void *device, uint8_t *Buffer, uint32_t Length)
 {
-  uint32_t SizeTransfered;
-  SPI_Write(handle, Buffer, Length, &SizeTransfered, SPI_TRANSFER_OPTIONS_SIZE_IN_BYTES);
+  uint8_t Dummy = 0;
+
+  Write((Bridge *)device, &Dummy, 1);
+  Read((Bridge *)device, Buffer, Length);
 }
 
-void HAL_SPI_ReadBuffer(uint8_t *Buffer, uint32_t Length)
+void HAL_Bridge_GetStats(void *device, HAL_BridgeStats *stats)
 {
-  HAL_SPI_WriteByte(0);
-  uint32_t SizeTransfered;
-  FT_STATUS res =
-      SPI_Read(handle, Buffer, Length, &SizeTransfered, SPI_TRANSFER_OPTIONS_SIZE_IN_BYTES);
+  *stats = ((Bridge *)device)->Stats;
 }
 
-void HAL_Delay(uint32_t milliSeconds)
+int HAL_Bridge_Lost(void *device)
 {
-#ifdef _MSC_VER
-  Sleep(milliSeconds);
-#else
-  usleep(milliSeconds * 1000);
-#endif
+  return ((Bridge *)device)->Lost;
 }
 
-int HAL_Eve_Reset_HW(void)
+// A bridge that went away comes back as a new device, maybe on another channel, so it is looked
+// up again - the one case where a thread of its own builds the list of channels.
+int HAL_Bridge_Open(void *device)
 {
-  uint32_t total_channels;
-#ifndef _MSC_VER
-  FT_SetVIDPID(0x1b3d, 0x0200);
-#endif
-  Init_libMPSSE();
-  HAL_Close();
-  FT_STATUS result = SPI_GetNumChannels(&total_channels);
-  printf("channels found : %d\n", total_channels);
-  const char *channel = getenv("SPICHANNEL");
-  int ichan = 0;
-  if (channel)
+  Bridge *Dev = (Bridge *)device;
+  int ichan;
+
+  HAL_Bridge_Close(Dev);
+  if (!Dev->Found || Dev->Lost)
   {
-    ichan = atoi(channel);
+    Dev->Channel = FindChannel(Dev, Enumerate());
+    Dev->Found = true;
   }
 
-  if (total_channels > ichan)
+  ichan = Dev->Channel;
+  if (ichan >= 0)
   {
-    FT_DEVICE_LIST_INFO_NODE devList;
-    SPI_GetChannelInfo(ichan, &devList);
-
     ChannelConfig channelConf; // channel configuration
     FT_STATUS status;
     /* configure the spi settings */
@@ -109,30 +278,129 @@ int HAL_Eve_Reset_HW(void)
         SPI_CONFIG_OPTION_MODE0 | SPI_CONFIG_OPTION_CS_DBUS3 | SPI_CONFIG_OPTION_CS_ACTIVELOW;
     channelConf.Pin = 0x00000000;
 
-    /* Open the first available channel */
-    SPI_OpenChannel(ichan, (FT_HANDLE *)&handle);
-    status = SPI_InitChannel(handle, &channelConf);
+    status = SPI_OpenChannel(ichan, (FT_HANDLE *)&Dev->Handle);
+    if (status != FT_OK)
+      Dev->Handle = NULL; // Nothing to close
+    else
+      status = SPI_InitChannel(Dev->Handle, &channelConf);
     if (status == FT_OK)
     {
-      printf("USB->SPI Bridge opened\n");
+      Log("USB->SPI Bridge opened\n");
+      FT_SetTimeouts(Dev->Handle, BRIDGE_TIMEOUT_MS, BRIDGE_TIMEOUT_MS);
+      Dev->Lost = false;
+      Dev->ErrorRun = 0;
     }
     else
     {
-      printf("Unable to open USB->SPI Bridge\n");
+      Log("Unable to open USB->SPI Bridge, status %u\n", (unsigned)status);
+      HAL_Bridge_Close(Dev);
       return 0;
     }
   }
   else
   {
-    printf("USB->SPI Bridge not found.");
+    Log("USB->SPI Bridge not found.\n");
     return 0;
   }
 
+  // keep the EVE running (PD pin, GPIO 7 of the FT232H, high)
+  FT_WriteGPIO(Dev->Handle, (1 << FT800_PD_N) | 0x3B, (1 << FT800_PD_N) | 0x08);
+  return 1;
+}
+
+int HAL_Bridge_Reset(void *device)
+{
+  Bridge *Dev = (Bridge *)device;
+
+  if (!HAL_Bridge_Open(Dev))
+    return 0;
+
   // reset the EVE by toggling PD pin (GPIO 7 of the FT232H) 0 to 1
-  FT_WriteGPIO(handle, (1 << FT800_PD_N) | 0x3B, (0 << FT800_PD_N) | 0x08); // PDN set to 0
-  HAL_Delay(20);
+  FT_WriteGPIO(Dev->Handle, (1 << FT800_PD_N) | 0x3B, (0 << FT800_PD_N) | 0x08); // PDN set to 0
+  HAL_Delay(5);
 
-  FT_WriteGPIO(handle, (1 << FT800_PD_N) | 0x3B, (1 << FT800_PD_N) | 0x08); // PDN set to 1
+  FT_WriteGPIO(Dev->Handle, (1 << FT800_PD_N) | 0x3B, (1 << FT800_PD_N) | 0x08); // PDN set to 1
   HAL_Delay(20);
   return 1;
 }
+
+void HAL_Close(void)
+{
+  HAL_Bridge_Close(&Default);
+}
+
+void HAL_SPI_Enable(void)
+{
+  HAL_Bridge_SPI_Enable(&Default);
+}
+
+void HAL_SPI_Disable(void)
+{
+  HAL_Bridge_SPI_Disable(&Default);
+}
+
+uint8_t HAL_SPI_Write(uint8_t data)
+{
+  return HAL_Bridge_SPI_Write(&Default, data);
+}
+
+uint8_t HAL_SPI_WriteByte(uint8_t data)
+{
+  return HAL_Bridge_SPI_Write(&Default, data);
+}
+
+uint8_t HAL_SPI_ReadByte(uint8_t data)
+{
+  uint8_t res;
+
+  Read(&Default, &res, 1);
+  return res;
+}
+
+void HAL_SPI_WriteBuffer(uint8_t *Buffer, uint32_t Length)
+{
+  HAL_Bridge_SPI_WriteBuffer(&Default, Buffer, Length);
+}
+
+void HAL_SPI_ReadBuffer(uint8_t *Buffer, uint32_t Length)
+{
+  HAL_Bridge_SPI_ReadBuffer(&Default, Buffer, Length);
+}
+
+void HAL_Delay(uint32_t milliSeconds)
+{
+#ifdef _MSC_VER
+  Sleep(milliSeconds);
+#else
+  usleep(milliSeconds * 1000);
+#endif
+}
+
+void HAL_DelayUs(uint32_t microSeconds)
+{
+#ifdef _MSC_VER
+  Sleep((microSeconds + 999) / 1000);
+#else
+  usleep(microSeconds);
+#endif
+}
+
+uint32_t HAL_TimeUs(void)
+{
+  return (uint32_t)NowUs();
+}
+
+int HAL_Eve_Open(void)
+{
+  return HAL_Bridge_Open(&Default);
+}
+
+int HAL_Eve_Reset_HW(void)
+{
+  return HAL_Bridge_Reset(&Default);
+}
+
+int HAL_Eve_Lost(void)
+{
+  return HAL_Bridge_Lost(&Default);
+}
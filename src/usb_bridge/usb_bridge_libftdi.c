@@ -1,12 +1,14 @@
 /* Based on example by bjorn vaktaren at
  * https://gist.github.com/bjornvaktaren/d2461738ec44e3ad8b3bae4ce69445b4 */
 #define WITH_FLUSH
+#include "hw_api.h"
 #include <ftdi.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 
 #define BUS_SK 0x01 // ADBUS0, SPI data clock
@@ -23,75 +25,226 @@
 #define pinInitialState (BUS_CS | BUS_L0 | BUS_L1 | FT800_RST)
 #define pinDirection (BUS_SK | BUS_DO | BUS_CS | BUS_L0 | BUS_L1 | FT800_RST)
 
-struct ftdi_context *ftdi;
+#define BRIDGE_VID 0x1b3d
+#define BRIDGE_PID 0x200
 
-void HAL_Close(void)
+#define BRIDGE_TIMEOUT_MS 100   // USB transfers taking longer than this have failed
+#define BRIDGE_ERROR_LIMIT 3    // Failures in a row before the bridge counts as lost
+#define BRIDGE_UNAVAILABLE -666 // libftdi: the device is gone, e.g. unplugged
+#define BRIDGE_READY_MS 500     // How long the MPSSE may take to answer, see Synchronize
+#define BRIDGE_SYNC_RETRY_US 10000
+#define MPSSE_BAD_COMMAND 0xFA // The MPSSE answers an unknown opcode with this and the opcode
+
+// One bridge.  Location is (USB bus << 8) | device address, as reported by HAL_Bridge_List.
+typedef struct
 {
-  printf("Closing bridge\n");
-  HAL_Delay(200);
-#ifdef WITH_FLUSH
-  ftdi_tcioflush(ftdi);
-#endif
-  if (ftdi)
-  {
-    ftdi_usb_close(ftdi);
-  }
+  struct ftdi_context *Ftdi;
+  char Serial[16];
+  uint32_t Location;
+  HAL_BridgeStats Stats;
+  uint32_t ErrorRun; // Failed transfers since the last good one
+  bool Lost;         // Transfers are dropped until the next HAL_Bridge_Open
+} Bridge;
+
+static Bridge Default; // The bridge of the HAL_ functions without a device
+
+static uint64_t NowUs(void)
+{
+  struct timespec Now;
+
+  clock_gettime(CLOCK_MONOTONIC, &Now);
+  return (uint64_t)Now.tv_sec * 1000000 + (uint64_t)(Now.tv_nsec / 1000);
 }
 
-void HAL_RST_Enable(void)
+// A bridge that stopped answering fails every transfer after a timeout.  Once it is lost
+// transfers are dropped right away instead, until it is opened again.
+static void Failed(Bridge *bridge, int result)
 {
-  int icmd = 0;
-  uint8_t buf[8];
-  buf[icmd++] = SET_BITS_LOW;
-  buf[icmd++] = pinInitialState & ~FT800_RST;
-  buf[icmd++] = pinDirection;
-  if (ftdi_write_data(ftdi, buf, icmd) != icmd)
+  bridge->Stats.Errors++;
+  if ((++bridge->ErrorRun < BRIDGE_ERROR_LIMIT) && (result != BRIDGE_UNAVAILABLE))
+    return;
+  if (!bridge->Lost)
+    printf("USB bridge lost\n");
+  bridge->Lost = true;
+}
+
+// Every USB transfer goes through these two, for the statistics
+static bool Write(Bridge *bridge, uint8_t *buf, int length, const char *what)
+{
+  uint64_t Start = NowUs();
+  int Result;
+
+  if (bridge->Lost)
+    return false;
+  Result = ftdi_write_data(bridge->Ftdi, buf, length);
+  bridge->Stats.BusyUs += NowUs() - Start;
+  bridge->Stats.Transfers++;
+  if (Result != length)
   {
-    printf("HAL_SPI_Enable write failed\n");
+    printf("%s failed\n", what);
+    Failed(bridge, Result);
+    return false;
   }
+  bridge->ErrorRun = 0;
+  bridge->Stats.BytesWritten += length;
+  return true;
 }
 
-void HAL_RST_Disable(void)
+// ftdi_read_data returns what has arrived so far, so keep reading until all of it is there
+static void Read(Bridge *bridge, uint8_t *buf, int length)
 {
-  int icmd = 0;
-  uint8_t buf[8];
-  buf[icmd++] = SET_BITS_LOW;
-  buf[icmd++] = pinInitialState | FT800_RST;
-  buf[icmd++] = pinDirection;
-  if (ftdi_write_data(ftdi, buf, icmd) != icmd)
+  uint64_t Start = NowUs();
+  int Got = 0, Result = 0;
+
+  if (bridge->Lost)
+  {
+    memset(buf, 0, length);
+    return;
+  }
+  while (Got < length)
+  {
+    Result = ftdi_read_data(bridge->Ftdi, buf + Got, length - Got);
+    if (Result < 0)
+      break;
+    Got += Result;
+    if ((Got < length) && (NowUs() - Start > BRIDGE_TIMEOUT_MS * 1000))
+      break;
+  }
+  bridge->Stats.BusyUs += NowUs() - Start;
+  bridge->Stats.Transfers++;
+  bridge->Stats.BytesRead += Got;
+  if (Got == length)
   {
-    printf("HAL_SPI_Enable write failed\n");
+    bridge->ErrorRun = 0;
+    return;
   }
+  memset(buf + Got, 0, length - Got);
+  Failed(bridge, Result);
 }
 
-void HAL_SPI_Enable(void)
+// Send an unknown opcode until the MPSSE rejects it.  Once its answer is back the MPSSE runs
+// and has carried out everything queued before it.
+static bool Synchronize(Bridge *bridge)
 {
-  int icmd = 0;
-  uint8_t buf[8];
-  buf[icmd++] = SET_BITS_LOW;
-  buf[icmd++] = pinInitialState & ~BUS_CS;
-  buf[icmd++] = pinDirection;
-  if (ftdi_write_data(ftdi, buf, icmd) != icmd)
+  uint8_t Bogus = 0xAA, Last = 0, Byte;
+  uint64_t Start = NowUs(), Sent = 0;
+  int Result;
+
+  while (NowUs() - Start < BRIDGE_READY_MS * 1000)
   {
-    printf("HAL_SPI_Enable write failed\n");
+    if (NowUs() - Sent > BRIDGE_SYNC_RETRY_US)
+    {
+      if (!Write(bridge, &Bogus, 1, "Bridge sync"))
+        return false;
+      Sent = NowUs();
+    }
+    Result = ftdi_read_data(bridge->Ftdi, &Byte, 1);
+    if (Result < 0)
+      return false;
+    if (Result == 1)
+    {
+      if ((Last == MPSSE_BAD_COMMAND) && (Byte == Bogus))
+        return true;
+      Last = Byte;
+    }
   }
+  return false;
 }
 
-void HAL_SPI_Disable(void)
+static void SetPins(Bridge *bridge, uint8_t pins, const char *what)
 {
   int icmd = 0;
   uint8_t buf[8];
   buf[icmd++] = SET_BITS_LOW;
-  buf[icmd++] = pinInitialState | BUS_CS;
+  buf[icmd++] = pins;
   buf[icmd++] = pinDirection;
-  if (ftdi_write_data(ftdi, buf, icmd) != icmd)
+  Write(bridge, buf, icmd, what);
+}
+
+int HAL_Bridge_List(HAL_BridgeInfo *list, int max)
+{
+  struct ftdi_context *Ftdi = ftdi_new();
+  struct ftdi_device_list *Devices, *Device;
+  int Count, Index = 0;
+
+  if (!Ftdi)
+    return 0;
+  Count = ftdi_usb_find_all(Ftdi, &Devices, BRIDGE_VID, BRIDGE_PID);
+  for (Device = (Count > 0) ? Devices : NULL; Device && (Index < max); Device = Device->next)
   {
-    printf("HAL_SPI_Enable write failed\n");
+    memset(&list[Index], 0, sizeof(list[Index]));
+    ftdi_usb_get_strings(Ftdi,
+                         Device->dev,
+                         NULL,
+                         0,
+                         list[Index].Description,
+                         sizeof(list[Index].Description),
+                         list[Index].Serial,
+                         sizeof(list[Index].Serial));
+    list[Index].Location = ((uint32_t)libusb_get_bus_number(Device->dev) << 8) |
+                           libusb_get_device_address(Device->dev);
+    Index++;
   }
+  if (Count > 0)
+    ftdi_list_free(&Devices);
+  ftdi_free(Ftdi);
+  return (Count > 0) ? Count : 0;
 }
 
-uint8_t HAL_SPI_Write(uint8_t data)
+void *HAL_Bridge_Get(const char *serial, uint32_t location)
+{
+  Bridge *New = (Bridge *)calloc(1, sizeof(Bridge));
+
+  if (!New)
+    return NULL;
+  if (serial)
+    strncpy(New->Serial, serial, sizeof(New->Serial) - 1);
+  New->Location = location;
+  return New;
+}
+
+void HAL_Bridge_Free(void *device)
+{
+  HAL_Bridge_Close(device);
+  if (device != &Default)
+    free(device);
+}
+
+static void Disconnect(Bridge *bridge)
+{
+#ifdef WITH_FLUSH
+  ftdi_tcioflush(bridge->Ftdi);
+#endif
+  ftdi_usb_close(bridge->Ftdi);
+  ftdi_free(bridge->Ftdi);
+  bridge->Ftdi = NULL;
+}
+
+void HAL_Bridge_Close(void *device)
+{
+  Bridge *Dev = (Bridge *)device;
+
+  if (!Dev->Ftdi)
+    return;
+  printf("Closing bridge\n");
+  if (!Dev->Lost)
+    Synchronize(Dev); // Let the last transfers reach EVE
+  Disconnect(Dev);
+}
+
+void HAL_Bridge_SPI_Enable(void *device)
+{
+  SetPins((Bridge *)device, pinInitialState & ~BUS_CS, "HAL_SPI_Enable write");
+}
+
+void HAL_Bridge_SPI_Disable(void *device)
 {
+  SetPins((Bridge *)device, pinInitialState | BUS_CS, "HAL_SPI_Disable write");
+}
+
+uint8_t HAL_Bridge_SPI_Write(void *device, uint8_t data)
+{
+  Bridge *Dev = (Bridge *)device;
   int icmd = 0;
   uint8_t buf[8];
   buf[icmd++] = MPSSE_DO_WRITE | MPSSE_WRITE_NEG;
@@ -99,16 +252,13 @@ uint8_t HAL_SPI_Write(uint8_t data)
   buf[icmd++] = 0x00; // length high byte
   buf[icmd++] = data; // byte to send
 #ifdef WITH_FLUSH
-  ftdi_tcioflush(ftdi);
+  ftdi_tcioflush(Dev->Ftdi);
 #endif
-  if (ftdi_write_data(ftdi, buf, icmd) != icmd)
-  {
-    printf("HAL_SPI_Write failed\n");
-  }
+  Write(Dev, buf, icmd, "HAL_SPI_Write");
   return 0;
 }
 
-void HAL_SPI_WriteBuffer(uint8_t *Buffer, uint32_t Length)
+void HAL_Bridge_SPI_WriteBuffer(void *device, uint8_t *Buffer, uint32_t Length)
 {
   int icmd = 0;
   uint8_t *buf = malloc(Length + 16);
@@ -117,57 +267,76 @@ void HAL_SPI_WriteBuffer(uint8_t *Buffer, uint32_t Length)
   buf[icmd++] = ((Length - 1) >> 8) & 0xff; // length high byte
   memcpy(&buf[icmd], Buffer, Length);
   icmd += Length;
-  if (ftdi_write_data(ftdi, buf, icmd) != icmd)
-  {
-    printf("HAL_SPI_Write failed\n");
-  }
+  Write((Bridge *)device, buf, icmd, "HAL_SPI_Write");
   free(buf);
 }
 
-void HAL_SPI_ReadBuffer(uint8_t *Buffer, uint32_t Length)
+void HAL_Bridge_SPI_ReadBuffer(void *device, uint8_t *Buffer, uint32_t Length)
 {
-  HAL_SPI_Write(0);
+  HAL_Bridge_SPI_Write(device, 0);
   int icmd = 0;
   uint8_t buf[8];
   buf[icmd++] = MPSSE_WRITE_NEG | MPSSE_DO_READ;
   buf[icmd++] = (Length - 1) & 0xff;
   buf[icmd++] = ((Length - 1) >> 8) & 0xff; // length high byte
   buf[icmd++] = SEND_IMMEDIATE;
-  if (ftdi_write_data(ftdi, buf, icmd) != icmd)
-  {
-    printf("HAL_SPI_Write failed\n");
-  }
-  uint8_t res;
-  ftdi_read_data(ftdi, Buffer, Length);
+  Write((Bridge *)device, buf, icmd, "HAL_SPI_Write");
+  Read((Bridge *)device, Buffer, Length);
 }
 
-void HAL_Delay(uint32_t milliSeconds)
+void HAL_Bridge_GetStats(void *device, HAL_BridgeStats *stats)
 {
-  usleep(milliSeconds * 1000);
+  *stats = ((Bridge *)device)->Stats;
 }
 
-int HAL_Eve_Reset_HW(void)
+int HAL_Bridge_Lost(void *device)
 {
-  ftdi = ftdi_new();
-  if (!ftdi)
+  return ((Bridge *)device)->Lost;
+}
+
+int HAL_Bridge_Open(void *device)
+{
+  Bridge *Dev = (Bridge *)device;
+  int ftdi_status;
+
+  if (Dev->Ftdi) // Opened before, e.g. by a reset
+    Disconnect(Dev);
+  Dev->Ftdi = ftdi_new();
+  if (!Dev->Ftdi)
   {
     printf("Failed to initialize USB bridge\n");
     return 0;
   }
 
-  int ftdi_status = ftdi_usb_open(ftdi, 0x1b3d, 0x200);
+  if (Dev->Serial[0])
+    ftdi_status = ftdi_usb_open_desc(Dev->Ftdi, BRIDGE_VID, BRIDGE_PID, NULL, Dev->Serial);
+  else if (Dev->Location)
+    ftdi_status = ftdi_usb_open_bus_addr(Dev->Ftdi, Dev->Location >> 8, Dev->Location & 0xff);
+  else
+    ftdi_status = ftdi_usb_open(Dev->Ftdi, BRIDGE_VID, BRIDGE_PID);
   if (ftdi_status != 0)
   {
-    printf("Can't open USB bridge, error %s\n", ftdi_get_error_string(ftdi));
+    printf("Can't open USB bridge, error %s\n", ftdi_get_error_string(Dev->Ftdi));
+    ftdi_free(Dev->Ftdi);
+    Dev->Ftdi = NULL;
     return 0;
   }
   printf("Bridge opened successfully!\n");
-  ftdi_usb_reset(ftdi);
-  ftdi_set_interface(ftdi, INTERFACE_ANY);
-  ftdi_set_bitmode(ftdi, 0, 0);
-  ftdi_set_bitmode(ftdi, 0, BITMODE_MPSSE);
-  ftdi_tcioflush(ftdi);
-  usleep(100000);
+  Dev->Ftdi->usb_read_timeout = BRIDGE_TIMEOUT_MS;
+  Dev->Ftdi->usb_write_timeout = BRIDGE_TIMEOUT_MS;
+  Dev->Lost = false;
+  Dev->ErrorRun = 0;
+  ftdi_usb_reset(Dev->Ftdi);
+  ftdi_set_interface(Dev->Ftdi, INTERFACE_ANY);
+  ftdi_set_bitmode(Dev->Ftdi, 0, 0);
+  ftdi_set_bitmode(Dev->Ftdi, 0, BITMODE_MPSSE);
+  ftdi_tcioflush(Dev->Ftdi);
+  if (!Synchronize(Dev))
+  {
+    printf("USB bridge not answering\n");
+    Disconnect(Dev);
+    return 0;
+  }
 
   unsigned int icmd = 0;
   unsigned char buf[256] = {0};
@@ -179,16 +348,94 @@ int HAL_Eve_Reset_HW(void)
   buf[icmd++] = SET_BITS_LOW;    // opcode: set low bits (ADBUS[0-7])
   buf[icmd++] = pinInitialState; // argument: inital pin states
   buf[icmd++] = pinDirection;    // argument: pin direction
-  if (ftdi_write_data(ftdi, buf, icmd) != icmd)
+  if (!Write(Dev, buf, icmd, "Bridge setup"))
   {
-    printf("Bridge setup failed\n");
-    ftdi_usb_close(ftdi);
+    Disconnect(Dev);
     return 0;
   }
   printf("Setup complete!\n");
-  HAL_RST_Enable();
-  HAL_Delay(20);
-  HAL_RST_Disable();
+  return 1;
+}
+
+int HAL_Bridge_Reset(void *device)
+{
+  Bridge *Dev = (Bridge *)device;
+
+  if (!HAL_Bridge_Open(Dev))
+    return 0;
+  SetPins(Dev, pinInitialState & ~FT800_RST, "HAL_RST_Enable write");
+  HAL_Delay(5);
+  SetPins(Dev, pinInitialState | FT800_RST, "HAL_RST_Disable write");
   HAL_Delay(20);
   return 1;
 }
+
+void HAL_Close(void)
+{
+  HAL_Bridge_Close(&Default);
+}
+
+void HAL_RST_Enable(void)
+{
+  SetPins(&Default, pinInitialState & ~FT800_RST, "HAL_RST_Enable write");
+}
+
+void HAL_RST_Disable(void)
+{
+  SetPins(&Default, pinInitialState | FT800_RST, "HAL_RST_Disable write");
+}
+
+void HAL_SPI_Enable(void)
+{
+  HAL_Bridge_SPI_Enable(&Default);
+}
+
+void HAL_SPI_Disable(void)
+{
+  HAL_Bridge_SPI_Disable(&Default);
+}
+
+uint8_t HAL_SPI_Write(uint8_t data)
+{
+  return HAL_Bridge_SPI_Write(&Default, data);
+}
+
+void HAL_SPI_WriteBuffer(uint8_t *Buffer, uint32_t Length)
+{
+  HAL_Bridge_SPI_WriteBuffer(&Default, Buffer, Length);
+}
+
+void HAL_SPI_ReadBuffer(uint8_t *Buffer, uint32_t Length)
+{
+  HAL_Bridge_SPI_ReadBuffer(&Default, Buffer, Length);
+}
+
+void HAL_Delay(uint32_t milliSeconds)
+{
+  usleep(milliSeconds * 1000);
+}
+
+void HAL_DelayUs(uint32_t microSeconds)
+{
+  usleep(microSeconds);
+}
+
+uint32_t HAL_TimeUs(void)
+{
+  return (uint32_t)NowUs();
+}
+
+int HAL_Eve_Open(void)
+{
+  return HAL_Bridge_Open(&Default);
+}
+
+int HAL_Eve_Reset_HW(void)
+{
+  return HAL_Bridge_Reset(&Default);
+}
+
+int HAL_Eve_Lost(void)
+{
+  return HAL_Bridge_Lost(&Default);
+}